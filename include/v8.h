@@ -3381,6 +3381,8 @@ class V8_EXPORT ArrayBuffer : public Object {
     /**
      * Free the memory block of size |length|, pointed to by |data|.
      * That memory is guaranteed to be previously allocated by |Allocate|.
+     * With --concurrent-array-buffer-freeing, the garbage collector may call
+     * this from a background thread.
      */
     virtual void Free(void* data, size_t length) = 0;
   };
@@ -5007,6 +5009,16 @@ typedef void (*GCCallback)(GCType type, GCCallbackFlags flags);
 
 typedef void (*InterruptCallback)(Isolate* isolate, void* data);
 
+/**
+ * Memory pressure level for the MemoryPressureNotification.
+ * kNone hints V8 that there is no memory pressure.
+ * kModerate hints V8 to speed up incremental garbage collection at the cost
+ * of higher latency due to garbage collection pauses.
+ * kCritical hints V8 to free memory as soon as possible. Garbage collection
+ * pauses at this level will be large.
+ */
+enum class MemoryPressureLevel { kNone, kModerate, kCritical };
+
 
 /**
  * Collection of V8 heap information.
@@ -5075,6 +5087,39 @@ class V8_EXPORT HeapObjectStatistics {
 };
 
 
+/**
+ * Pretenuring state of an allocation site, i.e. of an object or array literal
+ * or an Array constructor call that tracks the lifetime of its objects.
+ */
+class V8_EXPORT AllocationSiteStatistics {
+ public:
+  static const size_t kSurvivalHistogramBuckets = 8;
+
+  AllocationSiteStatistics();
+  const char* site_type() { return site_type_; }
+  const char* pretenure_decision() { return pretenure_decision_; }
+  bool is_tenured() { return is_tenured_; }
+
+  /**
+   * Returns how many of the recent garbage collections saw a survival rate
+   * of the site's objects in the given bucket. Bucket i covers survival rates
+   * in [i / kSurvivalHistogramBuckets, (i + 1) / kSurvivalHistogramBuckets).
+   */
+  size_t survival_histogram(size_t bucket) {
+    return bucket < kSurvivalHistogramBuckets ? survival_histogram_[bucket]
+                                              : 0;
+  }
+
+ private:
+  const char* site_type_;
+  const char* pretenure_decision_;
+  bool is_tenured_;
+  size_t survival_histogram_[kSurvivalHistogramBuckets];
+
+  friend class Isolate;
+};
+
+
 class RetainedObjectInfo;
 
 
@@ -5491,6 +5536,39 @@ class V8_EXPORT Isolate {
   bool GetHeapObjectStatisticsAtLastGC(HeapObjectStatistics* object_statistics,
                                        size_t type_index);
 
+  typedef void (*HeapObjectStatisticsCallback)(Isolate* isolate);
+
+  /**
+   * Enables or disables sampling of heap object statistics. While enabled,
+   * the statistics returned by GetHeapObjectStatisticsAtLastGC are gathered
+   * by the sweeper after each full garbage collection instead of requiring
+   * the --track-gc-object-stats flag, so the overhead stays off the main
+   * thread. Objects in the young generation are not included. Once a new
+   * sample is available, the optional callback is posted as a task to the
+   * thread of the isolate.
+   */
+  void SetHeapObjectStatisticsSampling(
+      bool enabled, HeapObjectStatisticsCallback callback = nullptr);
+
+  /**
+   * Get the pretenuring state of the allocation sites that have collected
+   * survival feedback.
+   *
+   * \param site_statistics Caller allocated buffer to fill in.
+   * \param length Number of entries in the buffer.
+   * \returns the number of allocation sites with feedback, which may be larger
+   *   than length. Only the first length of them are filled in.
+   */
+  size_t GetAllocationSiteStatistics(AllocationSiteStatistics* site_statistics,
+                                     size_t length);
+
+  /**
+   * Sends all allocation sites that currently allocate in the old generation
+   * back to the young generation and discards their pretenuring decision.
+   * Code that depends on the decisions is deoptimized.
+   */
+  void ResetAllocationSitePretenuring();
+
   /**
    * Get a call stack sample from the isolate.
    * \param state Execution state.
@@ -5639,6 +5717,32 @@ class V8_EXPORT Isolate {
    */
   void RemoveGCEpilogueCallback(GCCallback callback);
 
+  typedef void (*GCPauseBudgetViolationCallback)(Isolate* isolate, GCType type,
+                                                 double pause_ms,
+                                                 double budget_ms);
+
+  /**
+   * Sets the maximum garbage collection pause in milliseconds that the heap
+   * should aim for. The heap then uses its recorded collection speeds to limit
+   * semi-space growth, incremental marking step sizes and the number of pages
+   * compacted at once. A budget of 0 turns the mode off.
+   *
+   * The budget is a target, not a guarantee. If a scavenge or mark-compact
+   * pause exceeds it, |callback| is invoked after the garbage collection with
+   * the length of the pause.
+   */
+  void SetGCPauseBudget(double budget_ms,
+                        GCPauseBudgetViolationCallback callback = nullptr);
+
+  /**
+   * Lets the heap size the young generation from the measured allocation
+   * throughput and survival rate of the application, such that the time
+   * spent in scavenges per unit of mutator time is small while predicted
+   * scavenge pauses stay below |target_ms|. A target of 0 restores the
+   * default sizing heuristics.
+   */
+  void SetScavengePauseTarget(double target_ms);
+
   /**
    * Forcefully terminate the current thread of JavaScript execution
    * in the given isolate.
@@ -5795,6 +5899,16 @@ class V8_EXPORT Isolate {
    */
   void LowMemoryNotification();
 
+  /**
+   * Optional notification that the system is running low on memory or that
+   * the pressure has gone away again. V8 uses these notifications to compact
+   * the heap and release unused pages back to the operating system. Unlike
+   * the other notifications this one may be sent from any thread; if the
+   * isolate is not locked by the calling thread the work is deferred to the
+   * next interrupt check or foreground task on the isolate's thread.
+   */
+  void MemoryPressureNotification(MemoryPressureLevel level);
+
   /**
    * Optional notification that a context has been disposed. V8 uses
    * these notifications to guide the GC heuristic. Returns the number
@@ -5345,6 +5345,14 @@ HeapObjectStatistics::HeapObjectStatistics()
       object_size_(0) {}
 
 
+AllocationSiteStatistics::AllocationSiteStatistics()
+    : site_type_(nullptr), pretenure_decision_(nullptr), is_tenured_(false) {
+  for (size_t i = 0; i < kSurvivalHistogramBuckets; i++) {
+    survival_histogram_[i] = 0;
+  }
+}
+
+
 bool v8::V8::InitializeICU(const char* icu_data_file) {
   return i::InitializeICU(icu_data_file);
 }
@@ -7222,10 +7230,12 @@ size_t Isolate::NumberOfTrackedHeapObjectTypes() {
 bool Isolate::GetHeapObjectStatisticsAtLastGC(
     HeapObjectStatistics* object_statistics, size_t type_index) {
   if (!object_statistics) return false;
-  if (!i::FLAG_track_gc_object_stats) return false;
 
   i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
   i::Heap* heap = isolate->heap();
+  if (!i::FLAG_track_gc_object_stats && !heap->object_stats_sampling()) {
+    return false;
+  }
   if (type_index >= heap->NumberOfTrackedHeapObjectTypes()) return false;
 
   const char* object_type;
@@ -7247,6 +7257,70 @@ bool Isolate::GetHeapObjectStatisticsAtLastGC(
 }
 
 
+void Isolate::SetHeapObjectStatisticsSampling(
+    bool enabled, HeapObjectStatisticsCallback callback) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->heap()->SetObjectStatsSampling(enabled, callback);
+}
+
+
+size_t Isolate::GetAllocationSiteStatistics(
+    AllocationSiteStatistics* site_statistics, size_t length) {
+  STATIC_ASSERT(AllocationSiteStatistics::kSurvivalHistogramBuckets ==
+                i::AllocationSite::kSurvivalBuckets);
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  i::DisallowHeapAllocation no_gc;
+  size_t count = 0;
+  i::Object* current = isolate->heap()->allocation_sites_list();
+  while (current->IsAllocationSite()) {
+    i::AllocationSite* site = i::AllocationSite::cast(current);
+    current = site->weak_next();
+    if (site->IsZombie()) continue;
+    i::AllocationSite::PretenureDecision decision = site->pretenure_decision();
+    if (site->survival_sample_count() == 0 &&
+        decision == i::AllocationSite::kUndecided) {
+      continue;
+    }
+    if (site_statistics != nullptr && count < length) {
+      AllocationSiteStatistics* statistics = &site_statistics[count];
+      if (!site->SitePointsToLiteral()) {
+        statistics->site_type_ = "Array";
+      } else if (site->transition_info()->IsJSArray()) {
+        statistics->site_type_ = "array literal";
+      } else {
+        statistics->site_type_ = "object literal";
+      }
+      statistics->pretenure_decision_ = site->PretenureDecisionName(decision);
+      statistics->is_tenured_ = site->GetPretenureMode() == i::TENURED;
+      for (int i = 0; i < i::AllocationSite::kSurvivalBuckets; i++) {
+        statistics->survival_histogram_[i] = site->SurvivalSamplesInBucket(i);
+      }
+    }
+    count++;
+  }
+  return count;
+}
+
+
+void Isolate::ResetAllocationSitePretenuring() {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->heap()->ResetAllAllocationSitesDependentCode(i::TENURED);
+}
+
+
+void Isolate::SetGCPauseBudget(double budget_ms,
+                               GCPauseBudgetViolationCallback callback) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->heap()->SetPauseBudget(budget_ms, callback);
+}
+
+
+void Isolate::SetScavengePauseTarget(double target_ms) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  isolate->heap()->SetScavengePauseTarget(target_ms);
+}
+
+
 void Isolate::GetStackSample(const RegisterState& state, void** frames,
                              size_t frames_limit, SampleInfo* sample_info) {
   i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
@@ -7373,6 +7447,15 @@ void Isolate::LowMemoryNotification() {
 }
 
 
+void Isolate::MemoryPressureNotification(MemoryPressureLevel level) {
+  i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
+  bool is_isolate_locked =
+      Locker::IsActive() ? isolate->thread_manager()->IsLockedByCurrentThread()
+                         : i::Isolate::UnsafeCurrent() == isolate;
+  isolate->heap()->MemoryPressureNotification(level, is_isolate_locked);
+}
+
+
 int Isolate::ContextDisposedNotification(bool dependant_context) {
   i::Isolate* isolate = reinterpret_cast<i::Isolate*>(this);
   return isolate->heap()->NotifyContextDisposed(dependant_context);
@@ -388,5 +388,32 @@ bool VirtualMemory::HasLazyCommits() {
   return true;
 }
 
+
+void VirtualMemory::Split(size_t offset, VirtualMemory* tail) {
+  DCHECK(IsReserved());
+  DCHECK(!tail->IsReserved());
+  DCHECK(offset > 0 && offset < size_);
+  DCHECK_EQ(0u, offset % OS::AllocateAlignment());
+  uint8_t* tail_address = static_cast<uint8_t*>(address_) + offset;
+  size_t tail_size = size_ - offset;
+#if defined(LEAK_SANITIZER)
+  __lsan_unregister_root_region(address_, size_);
+  __lsan_register_root_region(address_, offset);
+  __lsan_register_root_region(tail_address, tail_size);
+#endif
+  tail->address_ = tail_address;
+  tail->size_ = tail_size;
+  size_ = offset;
+}
+
+
+bool VirtualMemory::AdviseHugePages(void* base, size_t size) {
+#if defined(MADV_HUGEPAGE)
+  return madvise(base, size, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace base
 }  // namespace v8
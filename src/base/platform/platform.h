@@ -361,6 +361,16 @@ class VirtualMemory {
   // Otherwise returns false.
   static bool HasLazyCommits();
 
+#if V8_OS_LINUX
+  // Hands the part of the reserved memory starting at |offset| over to
+  // |tail|. Both parts can be released independently afterwards.
+  void Split(size_t offset, VirtualMemory* tail);
+
+  // Asks the kernel to back the committed region with transparent huge
+  // pages. Returns whether the advice was accepted.
+  static bool AdviseHugePages(void* base, size_t size);
+#endif
+
  private:
   bool InVM(void* address, size_t size) {
     return (reinterpret_cast<uintptr_t>(address_) <=
@@ -0,0 +1,323 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/bounds-check-elimination.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/compiler/access-builder.h"
+#include "src/compiler/js-graph.h"
+#include "src/compiler/node-matchers.h"
+#include "src/compiler/node-properties.h"
+#include "src/compiler/simplified-operator.h"
+#include "src/counters.h"
+#include "src/types-inl.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+namespace {
+
+// Skips a conversion that typed lowering removes for inputs of the right type
+// anyway, i.e. the ToNumber in front of the increment of {i++}.
+Node* SkipConversion(Node* node, IrOpcode::Value opcode) {
+  if (node->opcode() == opcode) return NodeProperties::GetValueInput(node, 0);
+  return node;
+}
+
+
+bool IsAdd(Node* node) {
+  return node->opcode() == IrOpcode::kJSAdd ||
+         node->opcode() == IrOpcode::kNumberAdd;
+}
+
+
+// Typed lowering turns the exit test into a machine comparison once the
+// induction variable has been narrowed to an int32 range. Both inputs are
+// then of the matching int32 type, so the comparison is a numeric one.
+bool IsLessThan(Node* node) {
+  switch (node->opcode()) {
+    case IrOpcode::kJSLessThan:
+    case IrOpcode::kNumberLessThan:
+    case IrOpcode::kInt32LessThan:
+    case IrOpcode::kUint32LessThan:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+bool IsLessThanOrEqual(Node* node) {
+  switch (node->opcode()) {
+    case IrOpcode::kJSLessThanOrEqual:
+    case IrOpcode::kNumberLessThanOrEqual:
+    case IrOpcode::kInt32LessThanOrEqual:
+    case IrOpcode::kUint32LessThanOrEqual:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+// Returns true if {use} of a control node may lead control flow elsewhere.
+bool MaySplit(Node* use) {
+  if (use->opcode() == IrOpcode::kTerminate) return false;
+  if (IrOpcode::IsControlOpcode(use->opcode())) return true;
+  for (Edge edge : use->use_edges()) {
+    if (NodeProperties::IsControlEdge(edge)) return true;
+  }
+  return false;
+}
+
+
+// Returns true if every iteration of the loop headed by {loop_node} runs
+// into {branch}, i.e. if control flows straight from the header to it.
+bool IsOnEveryIteration(Node* loop_node, Node* branch) {
+  Node* next = branch;
+  Node* control = NodeProperties::GetControlInput(branch);
+  while (true) {
+    for (Edge edge : control->use_edges()) {
+      Node* use = edge.from();
+      if (use == next || !NodeProperties::IsControlEdge(edge)) continue;
+      if (MaySplit(use)) return false;
+    }
+    if (control == loop_node) return true;
+    if (IrOpcode::IsControlOpcode(control->opcode()) &&
+        control->opcode() != IrOpcode::kIfSuccess) {
+      return false;
+    }
+    if (control->op()->ControlInputCount() != 1) return false;
+    next = control;
+    control = NodeProperties::GetControlInput(control);
+  }
+}
+
+
+// Returns true if {node} only executes in {loop} after control passed
+// {body}. Relies on {body} being on every iteration of {loop}, so that any
+// path from {node} back to {body} is as good as all of them.
+bool IsDominatedBy(LoopTree* loop_tree, LoopTree::Loop* loop, Node* node,
+                   Node* body) {
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  Node* control = NodeProperties::GetControlInput(node);
+  while (control != body) {
+    if (control == loop_node || !loop_tree->Contains(loop, control) ||
+        control->op()->ControlInputCount() == 0) {
+      return false;
+    }
+    control = NodeProperties::GetControlInput(control);
+  }
+  return true;
+}
+
+
+// Returns true if {offset} is the byte offset {index << shift}.
+bool IsOffsetOf(Node* offset, Node* index, int shift) {
+  if (shift == 0) return offset == index;
+  Int32BinopMatcher m(offset);
+  return offset->opcode() == IrOpcode::kWord32Shl &&
+         m.left().node() == index && m.right().Is(shift);
+}
+
+
+// Computes the largest value that {bound} can take on. NaN bounds fail all
+// tests, so they can be ignored.
+bool GetUpperBound(Node* bound, double* max, Zone* zone) {
+  if (!NodeProperties::IsTyped(bound)) return false;
+  Type* const type = NodeProperties::GetType(bound);
+  if (!type->Is(Type::Number())) return false;
+  Type* const ordered = Type::Intersect(type, Type::OrderedNumber(), zone);
+  if (!ordered->IsInhabited()) return false;
+  *max = ordered->Max();
+  return std::isfinite(*max);
+}
+
+}  // namespace
+
+
+BoundsCheckElimination::BoundsCheckElimination(JSGraph* jsgraph, Zone* zone)
+    : jsgraph_(jsgraph), zone_(zone) {}
+
+
+bool BoundsCheckElimination::MatchInductionVariable(LoopTree* loop_tree,
+                                                    LoopTree::Loop* loop,
+                                                    Node* phi,
+                                                    InductionVariable* result) {
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  if (phi->opcode() != IrOpcode::kPhi ||
+      phi->op()->ValueInputCount() != 2 ||
+      NodeProperties::GetControlInput(phi) != loop_node) {
+    return false;
+  }
+  Node* const init = phi->InputAt(0);
+  if (!NodeProperties::IsTyped(phi) || !NodeProperties::IsTyped(init) ||
+      !NodeProperties::GetType(phi)->Is(Type::Number()) ||
+      !NodeProperties::GetType(init)->Is(Type::Integral32())) {
+    return false;
+  }
+
+  // The back edge value must be {phi} plus a positive integer constant.
+  Node* const increment = phi->InputAt(1);
+  if (!IsAdd(increment)) return false;
+  Node* lhs = NodeProperties::GetValueInput(increment, 0);
+  Node* rhs = NodeProperties::GetValueInput(increment, 1);
+  if (SkipConversion(lhs, IrOpcode::kJSToNumber) != phi) std::swap(lhs, rhs);
+  NumberMatcher mstep(rhs);
+  if (SkipConversion(lhs, IrOpcode::kJSToNumber) != phi ||
+      !mstep.HasValue() || mstep.Value() <= 0 ||
+      mstep.Value() != std::floor(mstep.Value())) {
+    return false;
+  }
+
+  // Look for the loop exit test {phi < bound} or {phi <= bound}.
+  for (Node* branch : loop_tree->BodyNodes(loop)) {
+    if (branch->opcode() != IrOpcode::kBranch ||
+        loop_tree->ContainingLoop(branch) != loop) {
+      continue;
+    }
+    Node* test = SkipConversion(NodeProperties::GetValueInput(branch, 0),
+                                IrOpcode::kJSToBoolean);
+    if (!IsLessThan(test) && !IsLessThanOrEqual(test)) continue;
+    if (SkipConversion(NodeProperties::GetValueInput(test, 0),
+                       IrOpcode::kJSToNumber) != phi) {
+      continue;
+    }
+    Node* if_true = nullptr;
+    Node* if_false = nullptr;
+    for (Node* use : branch->uses()) {
+      if (use->opcode() == IrOpcode::kIfTrue) if_true = use;
+      if (use->opcode() == IrOpcode::kIfFalse) if_false = use;
+    }
+    if (if_true == nullptr || if_false == nullptr ||
+        !loop_tree->Contains(loop, if_true) ||
+        loop_tree->Contains(loop, if_false) ||
+        !IsOnEveryIteration(loop_node, branch)) {
+      continue;
+    }
+    double bound;
+    if (!GetUpperBound(NodeProperties::GetValueInput(test, 1), &bound,
+                       zone())) {
+      continue;
+    }
+    double const min = NodeProperties::GetType(init)->Min();
+    double const max =
+        IsLessThan(test) ? std::ceil(bound) - 1 : std::floor(bound);
+    if (max < min) continue;
+    result->loop = loop;
+    result->phi = phi;
+    result->body = if_true;
+    result->min = min;
+    result->max = max;
+    result->step = mstep.Value();
+    return true;
+  }
+  return false;
+}
+
+
+void BoundsCheckElimination::FindInductionVariables(
+    LoopTree* loop_tree, LoopTree::Loop* loop,
+    ZoneVector<InductionVariable>* result) {
+  for (LoopTree::Loop* child : loop->children()) {
+    FindInductionVariables(loop_tree, child, result);
+  }
+  for (Node* node : loop_tree->HeaderNodes(loop)) {
+    InductionVariable variable;
+    if (MatchInductionVariable(loop_tree, loop, node, &variable)) {
+      result->push_back(variable);
+    }
+  }
+}
+
+
+void BoundsCheckElimination::NarrowInductionVariables() {
+  LoopTree* loop_tree = LoopFinder::BuildLoopTree(graph(), zone());
+  ZoneVector<InductionVariable> variables(zone());
+  for (LoopTree::Loop* loop : loop_tree->outer_loops()) {
+    FindInductionVariables(loop_tree, loop, &variables);
+  }
+  for (InductionVariable const& variable : variables) {
+    // The phi takes on its initial value, or the value of the previous
+    // iteration, which passed the exit test, plus the step.
+    Node* const phi = variable.phi;
+    double const init_max = NodeProperties::GetType(phi->InputAt(0))->Max();
+    double const max = std::max(init_max, variable.max + variable.step);
+    Type* const range = Type::Range(variable.min, max, graph()->zone());
+    NodeProperties::SetType(
+        phi, Type::Intersect(NodeProperties::GetType(phi), range,
+                             graph()->zone()));
+  }
+}
+
+
+void BoundsCheckElimination::EliminateBoundsChecks() {
+  LoopTree* loop_tree = LoopFinder::BuildLoopTree(graph(), zone());
+  ZoneVector<InductionVariable> variables(zone());
+  for (LoopTree::Loop* loop : loop_tree->outer_loops()) {
+    FindInductionVariables(loop_tree, loop, &variables);
+  }
+  NodeVector accesses(zone());
+  for (InductionVariable const& variable : variables) {
+    if (variable.min < 0) continue;
+    // Typed lowering computes the byte offset as {phi << shift}.
+    for (Node* use : variable.phi->uses()) {
+      if (use->opcode() == IrOpcode::kWord32Shl) {
+        for (Node* access : use->uses()) accesses.push_back(access);
+      } else {
+        accesses.push_back(use);
+      }
+    }
+    for (Node* access : accesses) {
+      EliminateBoundsCheck(loop_tree, variable, access);
+    }
+    accesses.clear();
+  }
+}
+
+
+void BoundsCheckElimination::EliminateBoundsCheck(
+    LoopTree* loop_tree, InductionVariable const& variable, Node* node) {
+  if (node->opcode() != IrOpcode::kLoadBuffer &&
+      node->opcode() != IrOpcode::kStoreBuffer) {
+    return;
+  }
+  BufferAccess const access = BufferAccessOf(node->op());
+  int const shift = ElementSizeLog2Of(access.machine_type());
+  NumberMatcher mlength(node->InputAt(2));
+  if (!IsOffsetOf(node->InputAt(1), variable.phi, shift) ||
+      !mlength.HasValue()) {
+    return;
+  }
+  // The last element accessed in the body must end within the buffer.
+  if ((variable.max + 1) * (1 << shift) > mlength.Value()) return;
+  if (!IsDominatedBy(loop_tree, variable.loop, node, variable.body)) return;
+
+  ElementAccess const element_access =
+      AccessBuilder::ForTypedArrayElement(access.external_array_type(), true);
+  node->ReplaceInput(1, variable.phi);
+  node->RemoveInput(2);
+  if (node->opcode() == IrOpcode::kLoadBuffer) {
+    NodeProperties::ChangeOp(node, simplified()->LoadElement(element_access));
+  } else {
+    NodeProperties::ChangeOp(node, simplified()->StoreElement(element_access));
+  }
+  Counters* const counters = jsgraph()->isolate()->counters();
+  counters->turbo_bounds_checks_eliminated()->Increment();
+}
+
+
+Graph* BoundsCheckElimination::graph() const { return jsgraph()->graph(); }
+
+
+SimplifiedOperatorBuilder* BoundsCheckElimination::simplified() const {
+  return jsgraph()->simplified();
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
@@ -0,0 +1,80 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_COMPILER_BOUNDS_CHECK_ELIMINATION_H_
+#define V8_COMPILER_BOUNDS_CHECK_ELIMINATION_H_
+
+#include "src/compiler/loop-analysis.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+// Forward declarations.
+class JSGraph;
+class SimplifiedOperatorBuilder;
+
+
+// An induction variable is a loop phi that starts at an integer and is
+// incremented by a positive integer constant on the back edge, and that is
+// tested against an upper bound at the top of the loop, i.e.
+//
+//   for (var i = init; i < bound; i += step) { ... }
+//
+// Inside of the body, which is entered through {body}, its value lies in
+// [{min}, {max}].
+struct InductionVariable {
+  LoopTree::Loop* loop;
+  Node* phi;
+  Node* body;
+  double min;
+  double max;
+  double step;
+};
+
+
+// Bounds check elimination based on induction variables. The typer has to
+// weaken the types of loop phis to reach a fixpoint, so induction variables
+// usually end up with an unbounded range, and neither typed lowering nor
+// simplified lowering can prove an access indexed by them to be in bounds.
+// This pass recovers their ranges from the loop exit tests instead.
+class BoundsCheckElimination final {
+ public:
+  BoundsCheckElimination(JSGraph* jsgraph, Zone* zone);
+
+  // Narrows the types of all induction variables to the values that they can
+  // take on at the loop header, so that typed lowering turns typed array
+  // accesses indexed by them into LoadBuffer and StoreBuffer.
+  void NarrowInductionVariables();
+
+  // Turns LoadBuffer and StoreBuffer nodes whose index is an induction
+  // variable that is in bounds throughout the loop body into LoadElement and
+  // StoreElement, which are not bounds checked.
+  void EliminateBoundsChecks();
+
+  // Returns true and fills in {result} if {phi} is an induction variable of
+  // {loop}.
+  bool MatchInductionVariable(LoopTree* loop_tree, LoopTree::Loop* loop,
+                              Node* phi, InductionVariable* result);
+
+ private:
+  void FindInductionVariables(LoopTree* loop_tree, LoopTree::Loop* loop,
+                              ZoneVector<InductionVariable>* result);
+  void EliminateBoundsCheck(LoopTree* loop_tree,
+                            InductionVariable const& variable, Node* node);
+
+  Graph* graph() const;
+  SimplifiedOperatorBuilder* simplified() const;
+  JSGraph* jsgraph() const { return jsgraph_; }
+  Zone* zone() const { return zone_; }
+
+  JSGraph* const jsgraph_;
+  Zone* const zone_;
+};
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_COMPILER_BOUNDS_CHECK_ELIMINATION_H_
@@ -11,6 +11,49 @@ namespace v8 {
 namespace internal {
 namespace compiler {
 
+namespace {
+
+// Looks through the FinishRegion that wraps an inline allocation, which is
+// the same object as the allocation itself.
+Node* SkipFinishRegion(Node* node) {
+  if (node->opcode() == IrOpcode::kFinishRegion) {
+    node = NodeProperties::GetValueInput(node, 0);
+  }
+  return node;
+}
+
+
+// Returns true if {object1} and {object2} may be the same object. Two
+// different allocations never are.
+bool MayAlias(Node* object1, Node* object2) {
+  object1 = SkipFinishRegion(object1);
+  object2 = SkipFinishRegion(object2);
+  if (object1 == object2) return true;
+  return object1->opcode() != IrOpcode::kAllocate ||
+         object2->opcode() != IrOpcode::kAllocate;
+}
+
+
+// Returns true if {access1} and {access2} may refer to the same field, in
+// which case accessing one may affect the other even if the accesses are
+// not identical.
+bool MayOverlap(FieldAccess const& access1, FieldAccess const& access2) {
+  return access1.base_is_tagged != access2.base_is_tagged ||
+         access1.offset == access2.offset;
+}
+
+
+bool HasSingleEffectUse(Node* node) {
+  int count = 0;
+  for (Edge edge : node->use_edges()) {
+    if (NodeProperties::IsEffectEdge(edge)) ++count;
+  }
+  return count == 1;
+}
+
+}  // namespace
+
+
 LoadElimination::~LoadElimination() {}
 
 
@@ -18,6 +61,8 @@ Reduction LoadElimination::Reduce(Node* node) {
   switch (node->opcode()) {
     case IrOpcode::kLoadField:
       return ReduceLoadField(node);
+    case IrOpcode::kStoreField:
+      return ReduceStoreField(node);
     default:
       break;
   }
@@ -42,14 +87,15 @@ Reduction LoadElimination::ReduceLoadField(Node* node) {
         break;
       }
       case IrOpcode::kStoreField: {
-        if (access == FieldAccessOf(effect->op())) {
-          if (object == NodeProperties::GetValueInput(effect, 0)) {
+        FieldAccess const store_access = FieldAccessOf(effect->op());
+        if (MayOverlap(access, store_access)) {
+          Node* const store_object = NodeProperties::GetValueInput(effect, 0);
+          if (object == store_object && access == store_access) {
             Node* const value = NodeProperties::GetValueInput(effect, 1);
             ReplaceWithValue(node, value);
             return Replace(value);
           }
-          // TODO(turbofan): Alias analysis to the rescue?
-          return NoChange();
+          if (MayAlias(object, store_object)) return NoChange();
         }
         break;
       }
@@ -71,6 +117,55 @@ Reduction LoadElimination::ReduceLoadField(Node* node) {
   return NoChange();
 }
 
+
+Reduction LoadElimination::ReduceStoreField(Node* node) {
+  DCHECK_EQ(IrOpcode::kStoreField, node->opcode());
+  FieldAccess const access = FieldAccessOf(node->op());
+  Node* const object = NodeProperties::GetValueInput(node, 0);
+  for (Node* effect = NodeProperties::GetEffectInput(node);;
+       effect = NodeProperties::GetEffectInput(effect)) {
+    // Nothing but {node} may observe the effect chain in between, or else
+    // an earlier store could be seen.
+    if (!HasSingleEffectUse(effect)) return NoChange();
+    switch (effect->opcode()) {
+      case IrOpcode::kStoreField: {
+        FieldAccess const store_access = FieldAccessOf(effect->op());
+        if (object == NodeProperties::GetValueInput(effect, 0) &&
+            access.base_is_tagged == store_access.base_is_tagged &&
+            access.offset == store_access.offset &&
+            access.machine_type == store_access.machine_type) {
+          // The earlier store is overwritten before it is ever observed.
+          ReplaceWithValue(effect, effect,
+                           NodeProperties::GetEffectInput(effect));
+          effect->Kill();
+          return Changed(node);
+        }
+        break;
+      }
+      case IrOpcode::kLoadField: {
+        Node* const load_object = NodeProperties::GetValueInput(effect, 0);
+        if (MayOverlap(access, FieldAccessOf(effect->op())) &&
+            MayAlias(object, load_object)) {
+          return NoChange();
+        }
+        break;
+      }
+      case IrOpcode::kStoreBuffer:
+      case IrOpcode::kStoreElement: {
+        // Writes alone never observe the field.
+        break;
+      }
+      default: {
+        // Anything else might read the field, deoptimize or trigger a GC,
+        // which must not see a field that has not been initialized.
+        return NoChange();
+      }
+    }
+  }
+  UNREACHABLE();
+  return NoChange();
+}
+
 }  // namespace compiler
 }  // namespace internal
 }  // namespace v8
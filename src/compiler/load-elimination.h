@@ -20,6 +20,7 @@ class LoadElimination final : public AdvancedReducer {
 
  private:
   Reduction ReduceLoadField(Node* node);
+  Reduction ReduceStoreField(Node* node);
 };
 
 }  // namespace compiler
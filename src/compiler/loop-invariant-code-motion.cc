@@ -0,0 +1,283 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/loop-invariant-code-motion.h"
+
+#include <algorithm>
+
+#include "src/compiler/loop-peeling.h"
+#include "src/compiler/node-properties.h"
+#include "src/compiler/simplified-operator.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+namespace {
+
+bool IsLoad(Node* node) {
+  switch (node->opcode()) {
+    case IrOpcode::kLoadField:
+    case IrOpcode::kLoadElement:
+    case IrOpcode::kLoadBuffer:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+MachineType LoadedType(Node* load) {
+  switch (load->opcode()) {
+    case IrOpcode::kLoadField:
+      return FieldAccessOf(load->op()).machine_type;
+    case IrOpcode::kLoadElement:
+      return ElementAccessOf(load->op()).machine_type;
+    case IrOpcode::kLoadBuffer:
+      return BufferAccessOf(load->op()).machine_type();
+    default:
+      UNREACHABLE();
+      return kMachNone;
+  }
+}
+
+
+// Returns true if the value of {load} may be invalidated by a GC, i.e. if it
+// is neither a tagged value (which the GC updates) nor a floating point value.
+bool IsMovableByGC(Node* load) {
+  MachineType rep = RepresentationOf(LoadedType(load));
+  return rep != kRepTagged && rep != kRepFloat32 && rep != kRepFloat64;
+}
+
+
+// Returns true if the effectful {node} may change the value that {load}
+// reads. Field stores only clobber fields at the same offset, element stores
+// only clobber fields behind the header of their elements, and buffer stores
+// write to off-heap memory.
+bool MayClobber(Node* node, Node* load) {
+  switch (node->opcode()) {
+    case IrOpcode::kBeginRegion:
+    case IrOpcode::kFinishRegion:
+      return false;
+    case IrOpcode::kAllocate:
+    case IrOpcode::kJSStackCheck:
+      // Both may trigger a GC, which moves objects around.
+      return IsMovableByGC(load);
+    case IrOpcode::kStoreField: {
+      if (load->opcode() != IrOpcode::kLoadField) return true;
+      FieldAccess const& store = FieldAccessOf(node->op());
+      FieldAccess const& access = FieldAccessOf(load->op());
+      return store.base_is_tagged != kTaggedBase ||
+             access.base_is_tagged != kTaggedBase ||
+             store.offset == access.offset;
+    }
+    case IrOpcode::kStoreElement: {
+      if (load->opcode() != IrOpcode::kLoadField) return true;
+      ElementAccess const& store = ElementAccessOf(node->op());
+      FieldAccess const& access = FieldAccessOf(load->op());
+      return store.base_is_tagged != kTaggedBase ||
+             access.base_is_tagged != kTaggedBase ||
+             access.offset >= store.header_size;
+    }
+    case IrOpcode::kStoreBuffer:
+      return load->opcode() != IrOpcode::kLoadField ||
+             FieldAccessOf(load->op()).base_is_tagged != kTaggedBase;
+    default:
+      return !node->op()->HasProperty(Operator::kNoWrite);
+  }
+}
+
+
+// Only innermost loops up to this size are peeled to hoist loads out of them.
+const size_t kMaxPeeledLoopSize = 128;
+
+
+// Returns the branch that opens the diamond closed by {merge}, or nullptr if
+// {merge} does not close a diamond.
+Node* FindDiamondBranch(Node* merge) {
+  if (merge->InputCount() != 2) return nullptr;
+  Node* branch = nullptr;
+  for (Node* control : merge->inputs()) {
+    while (control->opcode() != IrOpcode::kIfTrue &&
+           control->opcode() != IrOpcode::kIfFalse) {
+      if (control->op()->ControlInputCount() != 1 ||
+          IrOpcode::IsMergeOpcode(control->opcode())) {
+        return nullptr;
+      }
+      control = NodeProperties::GetControlInput(control);
+    }
+    Node* projection_branch = NodeProperties::GetControlInput(control);
+    if (branch != nullptr && branch != projection_branch) return nullptr;
+    branch = projection_branch;
+  }
+  return branch;
+}
+
+
+// Returns true if nodes controlled by {control} run in every iteration of
+// {loop} that reaches the backedge.
+bool RunsInEveryIteration(LoopTree* loop_tree, LoopTree::Loop* loop,
+                          Node* control) {
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  if (loop_node->InputCount() != 2) return control == loop_node;
+  for (Node* node = loop_node->InputAt(1); node != control;) {
+    if (node == loop_node) return false;
+    if (node->opcode() == IrOpcode::kMerge) {
+      node = FindDiamondBranch(node);
+      if (node == nullptr) return false;
+    } else {
+      node = NodeProperties::GetControlInput(node);
+    }
+  }
+  return true;
+}
+
+
+// Returns true if {load} may move to the entry of {loop}. Loads behind a
+// branch may rely on the check it makes, like a map check or a bounds check,
+// and loads behind the exit test must not run when the loop is not entered
+// at all. Such loads only move if {entry_is_guarded}, i.e. if the loop has
+// been peeled: then the loop is entered only after the peeled iteration ran
+// the same load with the same checks, as long as the load runs in every
+// iteration.
+bool CanHoist(LoopTree* loop_tree, LoopTree::Loop* loop, Node* load,
+              NodeVector const& effects, bool entry_is_guarded) {
+  for (int i = 0; i < load->op()->ValueInputCount(); ++i) {
+    if (loop_tree->Contains(loop, load->InputAt(i))) return false;
+  }
+  Node* control = NodeProperties::GetControlInput(load);
+  if (entry_is_guarded) {
+    if (!RunsInEveryIteration(loop_tree, loop, control)) return false;
+  } else if (control != loop_tree->GetLoopControl(loop)) {
+    return false;
+  }
+  // Uses behind the loop could otherwise be scheduled after writes that
+  // follow the loop.
+  for (Edge edge : load->use_edges()) {
+    if (NodeProperties::IsValueEdge(edge) &&
+        !loop_tree->Contains(loop, edge.from())) {
+      return false;
+    }
+  }
+  for (Node* effect : effects) {
+    if (effect != load && MayClobber(effect, load)) return false;
+  }
+  return true;
+}
+
+
+// Returns the single effect phi of {loop}, or nullptr.
+Node* FindEffectPhi(LoopTree* loop_tree, LoopTree::Loop* loop) {
+  Node* effect_phi = nullptr;
+  for (Node* node : loop_tree->HeaderNodes(loop)) {
+    if (node->opcode() != IrOpcode::kEffectPhi) continue;
+    if (effect_phi != nullptr) return nullptr;
+    effect_phi = node;
+  }
+  return effect_phi;
+}
+
+
+void CollectEffects(LoopTree* loop_tree, LoopTree::Loop* loop,
+                    NodeVector* effects, NodeVector* loads) {
+  for (Node* node : loop_tree->LoopNodes(loop)) {
+    if (node->op()->EffectOutputCount() == 0) continue;
+    effects->push_back(node);
+    if (IsLoad(node)) loads->push_back(node);
+  }
+}
+
+
+// Returns true if peeling {loop} lets a load move out of it.
+bool ShouldPeel(LoopTree* loop_tree, LoopTree::Loop* loop, Zone* tmp_zone) {
+  if (!loop->children().empty()) return false;
+  if (loop->TotalSize() > kMaxPeeledLoopSize) return false;
+  if (FindEffectPhi(loop_tree, loop) == nullptr) return false;
+  if (!LoopPeeler::CanPeel(loop_tree, loop)) return false;
+  NodeVector effects(tmp_zone);
+  NodeVector loads(tmp_zone);
+  CollectEffects(loop_tree, loop, &effects, &loads);
+  for (Node* load : loads) {
+    if (!CanHoist(loop_tree, loop, load, effects, false) &&
+        CanHoist(loop_tree, loop, load, effects, true)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void PeelLoops(Graph* graph, CommonOperatorBuilder* common,
+               LoopTree* loop_tree, ZoneVector<LoopTree::Loop*> const& loops,
+               NodeVector* peeled_loops, Zone* tmp_zone) {
+  for (LoopTree::Loop* loop : loops) {
+    PeelLoops(graph, common, loop_tree, loop->children(), peeled_loops,
+              tmp_zone);
+    if (!ShouldPeel(loop_tree, loop, tmp_zone)) continue;
+    if (LoopPeeler::Peel(graph, common, loop_tree, loop, tmp_zone)) {
+      peeled_loops->push_back(loop_tree->GetLoopControl(loop));
+    }
+  }
+}
+
+
+void HoistLoads(LoopTree* loop_tree, LoopTree::Loop* loop,
+                bool entry_is_guarded, Zone* tmp_zone) {
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  Node* effect_phi = FindEffectPhi(loop_tree, loop);
+  if (effect_phi == nullptr) return;
+
+  NodeVector effects(tmp_zone);
+  NodeVector loads(tmp_zone);
+  CollectEffects(loop_tree, loop, &effects, &loads);
+
+  Node* entry_effect = effect_phi->InputAt(kAssumedLoopEntryIndex);
+  Node* entry_control = loop_node->InputAt(kAssumedLoopEntryIndex);
+  for (Node* load : loads) {
+    if (!CanHoist(loop_tree, loop, load, effects, entry_is_guarded)) continue;
+    Node* effect = NodeProperties::GetEffectInput(load);
+    for (Edge edge : load->use_edges()) {
+      if (NodeProperties::IsEffectEdge(edge)) edge.UpdateTo(effect);
+    }
+    NodeProperties::ReplaceEffectInput(load, entry_effect);
+    NodeProperties::ReplaceControlInput(load, entry_control);
+  }
+}
+
+
+void VisitLoop(LoopTree* loop_tree, LoopTree::Loop* loop,
+               NodeVector const& peeled_loops, Zone* tmp_zone) {
+  // Inner loops first, so that their loads can move further out.
+  for (LoopTree::Loop* child : loop->children()) {
+    VisitLoop(loop_tree, child, peeled_loops, tmp_zone);
+  }
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  bool entry_is_guarded =
+      std::find(peeled_loops.begin(), peeled_loops.end(), loop_node) !=
+      peeled_loops.end();
+  HoistLoads(loop_tree, loop, entry_is_guarded, tmp_zone);
+}
+
+}  // namespace
+
+
+// static
+void LoopInvariantCodeMotion::Run(Graph* graph, CommonOperatorBuilder* common,
+                                  Zone* tmp_zone) {
+  LoopTree* loop_tree = LoopFinder::BuildLoopTree(graph, tmp_zone);
+  NodeVector peeled_loops(tmp_zone);
+  PeelLoops(graph, common, loop_tree, loop_tree->outer_loops(), &peeled_loops,
+            tmp_zone);
+  // Peeling adds nodes to the enclosing loops.
+  if (!peeled_loops.empty()) {
+    loop_tree = LoopFinder::BuildLoopTree(graph, tmp_zone);
+  }
+  for (LoopTree::Loop* loop : loop_tree->outer_loops()) {
+    VisitLoop(loop_tree, loop, peeled_loops, tmp_zone);
+  }
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
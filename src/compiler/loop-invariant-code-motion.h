@@ -0,0 +1,37 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_COMPILER_LOOP_INVARIANT_CODE_MOTION_H_
+#define V8_COMPILER_LOOP_INVARIANT_CODE_MOTION_H_
+
+#include "src/compiler/loop-analysis.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+class CommonOperatorBuilder;
+
+// Moves loads out of loops. Pure nodes are already hoisted by the scheduler,
+// but loads are pinned into the loop by their effect input. A load whose
+// inputs are defined outside of the loop, which runs before any branch in the
+// loop, whose value is only used inside of the loop and which no write in the
+// loop may clobber is taken off the effect chain and attached to the loop
+// entry instead, so that the scheduler is free to hoist it.
+//
+// Loads behind the exit test or another check in the loop rely on the check,
+// so small innermost loops with such loads are peeled first. The loop is then
+// entered only after the peeled iteration passed all checks, and loads that
+// run in every iteration may move to the loop entry as well.
+class LoopInvariantCodeMotion {
+ public:
+  static void Run(Graph* graph, CommonOperatorBuilder* common,
+                  Zone* tmp_zone);
+};
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_COMPILER_LOOP_INVARIANT_CODE_MOTION_H_
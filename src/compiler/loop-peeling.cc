@@ -127,7 +127,11 @@ struct Peeling {
     for (Node* node : nodes) {
       inputs.clear();
       for (Node* input : node->inputs()) inputs.push_back(map(input));
-      Insert(node, graph->NewNode(node->op(), node->InputCount(), &inputs[0]));
+      Node* copy = graph->NewNode(node->op(), node->InputCount(), &inputs[0]);
+      if (NodeProperties::IsTyped(node)) {
+        NodeProperties::SetType(copy, NodeProperties::GetType(node));
+      }
+      Insert(node, copy);
     }
 
     // Fix remaining inputs of the copies.
@@ -250,6 +254,9 @@ PeeledIteration* LoopPeeler::Peel(Graph* graph, CommonOperatorBuilder* common,
           inputs.push_back(merge);
           const Operator* op = common->ResizeMergeOrPhi(node->op(), backedges);
           Node* phi = graph->NewNode(op, backedges + 1, &inputs[0]);
+          if (NodeProperties::IsTyped(node)) {
+            NodeProperties::SetType(phi, NodeProperties::GetType(node));
+          }
           node->ReplaceInput(0, phi);
           break;
         }
@@ -260,7 +267,7 @@ PeeledIteration* LoopPeeler::Peel(Graph* graph, CommonOperatorBuilder* common,
     // Only one backedge, simply replace the input to loop with output of
     // peeling.
     for (Node* node : loop_tree->HeaderNodes(loop)) {
-      node->ReplaceInput(0, peeling.map(node->InputAt(0)));
+      node->ReplaceInput(0, peeling.map(node->InputAt(1)));
     }
     new_entry = peeling.map(loop_node->InputAt(1));
   }
@@ -313,6 +320,9 @@ PeeledIteration* LoopPeeler::Peel(Graph* graph, CommonOperatorBuilder* common,
         // TODO(titzer): machine type is wrong here.
         Node* phi = graph->NewNode(common->Phi(kMachAnyTagged, 2), node,
                                    peeling.map(node), merge);
+        if (NodeProperties::IsTyped(node)) {
+          NodeProperties::SetType(phi, NodeProperties::GetType(node));
+        }
         for (Edge edge : value_edges) edge.UpdateTo(phi);
         value_edges.clear();
       }
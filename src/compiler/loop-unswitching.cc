@@ -0,0 +1,261 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/loop-unswitching.h"
+
+#include "src/compiler/common-operator.h"
+#include "src/compiler/js-graph.h"
+#include "src/compiler/node-marker.h"
+#include "src/compiler/node-properties.h"
+
+// Loop unswitching turns a loop with a branch on a loop invariant condition
+//
+//           entry
+//             |
+//          ( Loop )<----------------+
+//             |                     |
+//      ((=====|=============))      |
+//      ((  Branch(c)        ))      |
+//      ((   /      \        ))      |
+//      ((  A        B       ))------+
+//      ((=====|=============))
+//             |
+//           exit
+//
+// into a branch in front of two copies of the loop, one for each value of
+// the condition:
+//
+//                 entry
+//                   |
+//        +------Branch(c)------+
+//        |                     |
+//     ( Loop )<--+          ( Loop' )<--+
+//        |       |             |        |
+//     ((=|====)) |          ((=|====))  |
+//     ((  A   ))-+          ((  B'  ))--+
+//     ((=|====))            ((=|====))
+//        |                     |
+//      exit                  exit'
+//        |                     |
+//        +-------Merge---------+
+//
+// The values and effects that are used behind the loop get phis at the new
+// merge. The copies keep their branches, but with constant conditions.
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+namespace {
+
+// Maximum number of nodes in a loop that is duplicated by unswitching.
+const size_t kMaxUnswitchedLoopSize = 256;
+
+
+// Maps the nodes of a loop to their copies.
+class LoopCopier {
+ public:
+  LoopCopier(Graph* graph, size_t max, Zone* zone)
+      : node_map_(graph, static_cast<uint32_t>(max + 1)),
+        copies_(zone),
+        zone_(zone) {}
+
+  Node* map(Node* node) {
+    size_t index = node_map_.Get(node);
+    return index == 0 ? node : copies_[index - 1];
+  }
+
+  void CopyNodes(Graph* graph, NodeRange nodes) {
+    NodeVector inputs(zone_);
+    // Copy all the nodes first.
+    for (Node* node : nodes) {
+      inputs.clear();
+      for (Node* input : node->inputs()) inputs.push_back(map(input));
+      Node* copy = graph->NewNode(node->op(), node->InputCount(), &inputs[0]);
+      if (NodeProperties::IsTyped(node)) {
+        NodeProperties::SetType(copy, NodeProperties::GetType(node));
+      }
+      copies_.push_back(copy);
+      node_map_.Set(node, copies_.size());
+    }
+
+    // Fix the inputs of the copies that refer to nodes copied later.
+    for (Node* node : nodes) {
+      Node* copy = map(node);
+      for (int i = 0; i < copy->InputCount(); i++) {
+        copy->ReplaceInput(i, map(node->InputAt(i)));
+      }
+    }
+  }
+
+ private:
+  NodeMarker<size_t> node_map_;
+  NodeVector copies_;
+  Zone* zone_;
+};
+
+
+bool IsStateNode(Node* node) {
+  switch (node->opcode()) {
+    case IrOpcode::kFrameState:
+    case IrOpcode::kStateValues:
+    case IrOpcode::kTypedStateValues:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+void UnswitchInnermostLoops(JSGraph* jsgraph, LoopTree* loop_tree,
+                            LoopTree::Loop* loop, Zone* tmp_zone) {
+  if (loop->children().empty()) {
+    Node* branch = LoopUnswitcher::FindInvariantBranch(loop_tree, loop);
+    if (branch != nullptr) {
+      LoopUnswitcher::Unswitch(jsgraph, loop_tree, loop, branch, tmp_zone);
+    }
+    return;
+  }
+  for (LoopTree::Loop* child : loop->children()) {
+    UnswitchInnermostLoops(jsgraph, loop_tree, child, tmp_zone);
+  }
+}
+
+}  // namespace
+
+
+// static
+Node* LoopUnswitcher::FindInvariantBranch(LoopTree* loop_tree,
+                                          LoopTree::Loop* loop) {
+  for (Node* node : loop_tree->BodyNodes(loop)) {
+    if (node->opcode() != IrOpcode::kBranch) continue;
+    if (loop_tree->ContainingLoop(node) != loop) continue;
+    Node* condition = NodeProperties::GetValueInput(node, 0);
+    if (NodeProperties::IsConstant(condition) ||
+        loop_tree->Contains(loop, condition)) {
+      continue;
+    }
+    // Branches that leave the loop are left alone.
+    bool exits = false;
+    for (Node* use : node->uses()) {
+      if (!loop_tree->Contains(loop, use)) exits = true;
+    }
+    if (!exits) return node;
+  }
+  return nullptr;
+}
+
+
+// static
+bool LoopUnswitcher::Unswitch(JSGraph* jsgraph, LoopTree* loop_tree,
+                              LoopTree::Loop* loop, Node* branch,
+                              Zone* tmp_zone) {
+  Graph* graph = jsgraph->graph();
+  CommonOperatorBuilder* common = jsgraph->common();
+  if (loop->TotalSize() > kMaxUnswitchedLoopSize) return false;
+
+  // The loop must have a single exit, and all uses of its nodes from outside
+  // of the loop must be behind that exit, except for the Terminate nodes
+  // that connect the loop to end.
+  Node* exit = nullptr;
+  NodeVector terminates(tmp_zone);
+  for (Node* node : loop_tree->LoopNodes(loop)) {
+    for (Edge edge : node->use_edges()) {
+      Node* use = edge.from();
+      if (loop_tree->Contains(loop, use)) continue;
+      if (use->opcode() == IrOpcode::kTerminate) {
+        if (NodeProperties::IsControlEdge(edge)) terminates.push_back(use);
+      } else if (NodeProperties::IsControlEdge(edge)) {
+        if (exit != nullptr || (use->opcode() != IrOpcode::kIfTrue &&
+                                use->opcode() != IrOpcode::kIfFalse)) {
+          return false;
+        }
+        exit = use;
+      } else if (IsStateNode(use)) {
+        // Cannot put a phi into a frame state.
+        return false;
+      }
+    }
+  }
+  if (exit == nullptr) return false;
+
+  //============================================================================
+  // Copy the loop and branch on the condition in front of both copies.
+  //============================================================================
+  NodeId const first_new_id = graph->NodeCount();
+  LoopCopier copier(graph, loop->TotalSize(), tmp_zone);
+  copier.CopyNodes(graph, loop_tree->LoopNodes(loop));
+
+  Node* loop_node = loop_tree->GetLoopControl(loop);
+  Node* condition = NodeProperties::GetValueInput(branch, 0);
+  Node* entry = loop_node->InputAt(kAssumedLoopEntryIndex);
+  Node* unswitch = graph->NewNode(common->Branch(BranchHintOf(branch->op())),
+                                  condition, entry);
+  loop_node->ReplaceInput(kAssumedLoopEntryIndex,
+                          graph->NewNode(common->IfTrue(), unswitch));
+  copier.map(loop_node)->ReplaceInput(
+      kAssumedLoopEntryIndex, graph->NewNode(common->IfFalse(), unswitch));
+  branch->ReplaceInput(0, jsgraph->TrueConstant());
+  copier.map(branch)->ReplaceInput(0, jsgraph->FalseConstant());
+
+  //============================================================================
+  // Merge the exits of both copies.
+  //============================================================================
+  Node* exit_copy = graph->NewNode(exit->op(), copier.map(exit->InputAt(0)));
+  Node* merge = graph->NewNode(common->Merge(2), exit, exit_copy);
+  exit->ReplaceUses(merge);
+  merge->ReplaceInput(0, exit);  // input 0 overwritten by above line.
+
+  ZoneVector<Edge> value_edges(tmp_zone);
+  ZoneVector<Edge> effect_edges(tmp_zone);
+  for (Node* node : loop_tree->LoopNodes(loop)) {
+    for (Edge edge : node->use_edges()) {
+      Node* use = edge.from();
+      if (use->id() >= first_new_id || loop_tree->Contains(loop, use) ||
+          use->opcode() == IrOpcode::kTerminate) {
+        continue;
+      }
+      if (NodeProperties::IsEffectEdge(edge)) {
+        effect_edges.push_back(edge);
+      } else if (!NodeProperties::IsControlEdge(edge)) {
+        value_edges.push_back(edge);
+      }
+    }
+    if (!value_edges.empty()) {
+      Node* phi = graph->NewNode(common->Phi(kMachAnyTagged, 2), node,
+                                 copier.map(node), merge);
+      for (Edge edge : value_edges) edge.UpdateTo(phi);
+      value_edges.clear();
+    }
+    if (!effect_edges.empty()) {
+      Node* effect_phi = graph->NewNode(common->EffectPhi(2), node,
+                                        copier.map(node), merge);
+      for (Edge edge : effect_edges) edge.UpdateTo(effect_phi);
+      effect_edges.clear();
+    }
+  }
+
+  // Keep the copy of the loop alive, too.
+  for (Node* terminate : terminates) {
+    Node* copy = graph->NewNode(
+        common->Terminate(),
+        copier.map(NodeProperties::GetEffectInput(terminate)),
+        copier.map(NodeProperties::GetControlInput(terminate)));
+    NodeProperties::MergeControlToEnd(graph, common, copy);
+  }
+  return true;
+}
+
+
+// static
+void LoopUnswitcher::UnswitchLoops(JSGraph* jsgraph, LoopTree* loop_tree,
+                                   Zone* tmp_zone) {
+  for (LoopTree::Loop* loop : loop_tree->outer_loops()) {
+    UnswitchInnermostLoops(jsgraph, loop_tree, loop, tmp_zone);
+  }
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
@@ -0,0 +1,42 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_COMPILER_LOOP_UNSWITCHING_H_
+#define V8_COMPILER_LOOP_UNSWITCHING_H_
+
+#include "src/compiler/loop-analysis.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+// Forward declarations.
+class JSGraph;
+
+
+// Implements loop unswitching. A branch in the body of a loop whose condition
+// is defined outside of the loop is moved in front of the loop, and the loop
+// is duplicated, so that each copy only contains one side of the branch. The
+// branches left in the copies have constant conditions, which the
+// CommonOperatorReducer folds afterwards.
+class LoopUnswitcher {
+ public:
+  // Returns a branch in {loop} that can be unswitched, or nullptr.
+  static Node* FindInvariantBranch(LoopTree* loop_tree, LoopTree::Loop* loop);
+
+  // Unswitches {loop} on {branch}. Returns false if {loop} has a shape that
+  // is not supported, in which case the graph is not changed.
+  static bool Unswitch(JSGraph* jsgraph, LoopTree* loop_tree,
+                       LoopTree::Loop* loop, Node* branch, Zone* tmp_zone);
+
+  // Unswitches each innermost loop on its first invariant branch.
+  static void UnswitchLoops(JSGraph* jsgraph, LoopTree* loop_tree,
+                            Zone* tmp_zone);
+};
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_COMPILER_LOOP_UNSWITCHING_H_
@@ -12,6 +12,7 @@
 #include "src/compiler/ast-graph-builder.h"
 #include "src/compiler/ast-loop-assignment-analyzer.h"
 #include "src/compiler/basic-block-instrumentor.h"
+#include "src/compiler/bounds-check-elimination.h"
 #include "src/compiler/branch-elimination.h"
 #include "src/compiler/bytecode-graph-builder.h"
 #include "src/compiler/change-lowering.h"
@@ -41,7 +42,9 @@
 #include "src/compiler/live-range-separator.h"
 #include "src/compiler/load-elimination.h"
 #include "src/compiler/loop-analysis.h"
+#include "src/compiler/loop-invariant-code-motion.h"
 #include "src/compiler/loop-peeling.h"
+#include "src/compiler/loop-unswitching.h"
 #include "src/compiler/machine-operator-reducer.h"
 #include "src/compiler/move-optimizer.h"
 #include "src/compiler/osr.h"
@@ -573,6 +576,21 @@ struct TyperPhase {
 };
 
 
+struct InductionVariableNarrowingPhase {
+  static const char* phase_name() { return "induction variable narrowing"; }
+
+  void Run(PipelineData* data, Zone* temp_zone) {
+    GraphTrimmer trimmer(temp_zone, data->graph());
+    NodeVector roots(temp_zone);
+    data->jsgraph()->GetCachedNodes(&roots);
+    trimmer.TrimGraph(roots.begin(), roots.end());
+    BoundsCheckElimination bounds_check_elimination(data->jsgraph(),
+                                                    temp_zone);
+    bounds_check_elimination.NarrowInductionVariables();
+  }
+};
+
+
 struct OsrDeconstructionPhase {
   static const char* phase_name() { return "OSR deconstruction"; }
 
@@ -758,6 +776,59 @@ struct StressLoopPeelingPhase {
 };
 
 
+struct LoopUnswitchingPhase {
+  static const char* phase_name() { return "loop unswitching"; }
+
+  void Run(PipelineData* data, Zone* temp_zone) {
+    // Remove dead uses first, they would look like additional loop exits.
+    GraphTrimmer trimmer(temp_zone, data->graph());
+    NodeVector roots(temp_zone);
+    data->jsgraph()->GetCachedNodes(&roots);
+    trimmer.TrimGraph(roots.begin(), roots.end());
+    LoopTree* loop_tree = LoopFinder::BuildLoopTree(data->graph(), temp_zone);
+    LoopUnswitcher::UnswitchLoops(data->jsgraph(), loop_tree, temp_zone);
+
+    // Fold the branches on constant conditions left in the copies.
+    JSGraphReducer graph_reducer(data->jsgraph(), temp_zone);
+    DeadCodeElimination dead_code_elimination(&graph_reducer, data->graph(),
+                                              data->common());
+    CommonOperatorReducer common_reducer(&graph_reducer, data->graph(),
+                                         data->common(), data->machine());
+    AddReducer(data, &graph_reducer, &dead_code_elimination);
+    AddReducer(data, &graph_reducer, &common_reducer);
+    graph_reducer.ReduceGraph();
+  }
+};
+
+
+struct LoopInvariantCodeMotionPhase {
+  static const char* phase_name() { return "loop invariant code motion"; }
+
+  void Run(PipelineData* data, Zone* temp_zone) {
+    GraphTrimmer trimmer(temp_zone, data->graph());
+    NodeVector roots(temp_zone);
+    data->jsgraph()->GetCachedNodes(&roots);
+    trimmer.TrimGraph(roots.begin(), roots.end());
+    LoopInvariantCodeMotion::Run(data->graph(), data->common(), temp_zone);
+  }
+};
+
+
+struct BoundsCheckEliminationPhase {
+  static const char* phase_name() { return "bounds check elimination"; }
+
+  void Run(PipelineData* data, Zone* temp_zone) {
+    GraphTrimmer trimmer(temp_zone, data->graph());
+    NodeVector roots(temp_zone);
+    data->jsgraph()->GetCachedNodes(&roots);
+    trimmer.TrimGraph(roots.begin(), roots.end());
+    BoundsCheckElimination bounds_check_elimination(data->jsgraph(),
+                                                    temp_zone);
+    bounds_check_elimination.EliminateBoundsChecks();
+  }
+};
+
+
 struct GenericLoweringPhase {
   static const char* phase_name() { return "generic lowering"; }
 
@@ -1157,6 +1228,11 @@ Handle<Code> Pipeline::GenerateCode() {
   BeginPhaseKind("lowering");
 
   if (info()->is_typing_enabled()) {
+    if (FLAG_turbo_bounds_check_elimination) {
+      Run<InductionVariableNarrowingPhase>();
+      RunPrintAndVerify("Induction variables narrowed");
+    }
+
     // Lower JSOperators where we can determine types.
     Run<TypedLoweringPhase>();
     RunPrintAndVerify("Lowered typed");
@@ -1171,6 +1247,21 @@ Handle<Code> Pipeline::GenerateCode() {
       RunPrintAndVerify("JSType feedback");
     }
 
+    if (FLAG_turbo_loop_unswitching) {
+      Run<LoopUnswitchingPhase>();
+      RunPrintAndVerify("Loops unswitched");
+    }
+
+    if (FLAG_turbo_licm) {
+      Run<LoopInvariantCodeMotionPhase>();
+      RunPrintAndVerify("Loop invariants hoisted");
+    }
+
+    if (FLAG_turbo_bounds_check_elimination) {
+      Run<BoundsCheckEliminationPhase>();
+      RunPrintAndVerify("Bounds checks eliminated");
+    }
+
     // Lower simplified operators and insert changes.
     Run<SimplifiedLoweringPhase>();
     RunPrintAndVerify("Lowered simplified");
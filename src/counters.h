@@ -557,6 +557,8 @@ double AggregatedMemoryHistogram<Histogram>::Aggregate(double current_ms,
   SC(global_handles, V8.GlobalHandles)                                \
   /* OS Memory allocated */                                           \
   SC(memory_allocated, V8.OsMemoryAllocated)                          \
+  /* Page protection changes (mprotect calls) made by the heap */     \
+  SC(memory_protection_changes, V8.OsMemoryProtectionChanges)         \
   SC(normalized_maps, V8.NormalizedMaps)                              \
   SC(props_to_dictionary, V8.ObjectPropertiesToDictionary)            \
   SC(elements_to_dictionary, V8.ObjectElementsToDictionary)           \
@@ -588,6 +590,8 @@ double AggregatedMemoryHistogram<Histogram>::Aggregate(double current_ms,
   SC(total_compile_size, V8.TotalCompileSize)                         \
   /* Amount of source code compiled with the full codegen. */         \
   SC(total_full_codegen_source_size, V8.TotalFullCodegenSourceSize)   \
+  /* Number of bounds checks removed by TurboFan. */                  \
+  SC(turbo_bounds_checks_eliminated, V8.TurboBoundsChecksEliminated)  \
   /* Number of contexts created from scratch. */                      \
   SC(contexts_created_from_scratch, V8.ContextsCreatedFromScratch)    \
   /* Number of contexts created by partial snapshot. */               \
@@ -613,6 +617,7 @@ double AggregatedMemoryHistogram<Histogram>::Aggregate(double current_ms,
      V8.GCCompactorCausedByOldspaceExhaustion)                                 \
   SC(gc_last_resort_from_js, V8.GCLastResortFromJS)                            \
   SC(gc_last_resort_from_handles, V8.GCLastResortFromHandles)                  \
+  SC(gc_pause_budget_violations, V8.GCPauseBudgetViolations)                   \
   /* How is the generic keyed-load stub used? */                               \
   SC(keyed_load_generic_smi, V8.KeyedLoadGenericSmi)                           \
   SC(keyed_load_generic_symbol, V8.KeyedLoadGenericSymbol)                     \
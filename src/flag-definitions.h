@@ -260,6 +260,18 @@ DEFINE_BOOL(trace_pretenuring, false,
             "trace pretenuring decisions of HAllocate instructions")
 DEFINE_BOOL(trace_pretenuring_statistics, false,
             "trace allocation site pretenuring statistics")
+DEFINE_INT(pretenuring_tenure_threshold, 85,
+           "percentage of surviving objects at which an allocation site is "
+           "pretenured")
+DEFINE_INT(pretenuring_hysteresis, 1,
+           "number of consecutive GCs a survival rate has to stay on the same "
+           "side of the threshold before a pretenuring decision is made")
+DEFINE_INT(pretenuring_old_survival_threshold, 10,
+           "reset all pretenuring decisions when less than this percentage "
+           "of the old generation survives a mark-compact")
+DEFINE_INT(pretenuring_reevaluation_interval, 0,
+           "reset pretenured allocation sites to young allocation every n "
+           "mark-compacts to re-evaluate them (0 means never)")
 DEFINE_BOOL(track_fields, true, "track fields with only smi values")
 DEFINE_BOOL(track_double_fields, true, "track fields with double values")
 DEFINE_BOOL(track_heap_object_fields, true, "track fields with heap values")
@@ -392,6 +404,9 @@ DEFINE_BOOL(trace_concurrent_recompilation, false,
             "track concurrent recompilation")
 DEFINE_INT(concurrent_recompilation_queue_length, 8,
            "the length of the concurrent compilation queue")
+DEFINE_INT(concurrent_recompilation_tasks, 0,
+           "the number of background tasks that drain the concurrent "
+           "compilation queue (0 for one task per queued job)")
 DEFINE_INT(concurrent_recompilation_delay, 0,
            "artificial compilation delay in ms")
 DEFINE_BOOL(block_concurrent_recompilation, false,
@@ -451,6 +466,12 @@ DEFINE_BOOL(turbo_try_finally, false, "enable try-finally support in TurboFan")
 DEFINE_BOOL(turbo_stress_loop_peeling, false,
             "stress loop peeling optimization")
 DEFINE_BOOL(turbo_cf_optimization, true, "optimize control flow in TurboFan")
+DEFINE_BOOL(turbo_licm, false,
+            "hoist loop invariant loads out of loops in TurboFan")
+DEFINE_BOOL(turbo_loop_unswitching, false,
+            "unswitch loops on loop invariant branches in TurboFan")
+DEFINE_BOOL(turbo_bounds_check_elimination, false,
+            "eliminate bounds checks on induction variables in TurboFan")
 DEFINE_BOOL(turbo_frame_elision, true, "elide frames in TurboFan")
 DEFINE_BOOL(turbo_cache_shared_code, true, "cache context-independent code")
 DEFINE_BOOL(turbo_preserve_shared_code, false, "keep context-independent code")
@@ -614,6 +635,12 @@ DEFINE_INT(semi_space_growth_factor, 2, "factor by which to grow the new space")
 DEFINE_BOOL(experimental_new_space_growth_heuristic, false,
             "Grow the new space based on the percentage of survivors instead "
             "of their absolute value.")
+DEFINE_BOOL(semi_space_sizing_controller, false,
+            "size the new space from the allocation throughput and survival "
+            "rate to minimize the time spent in scavenges")
+DEFINE_FLOAT(scavenge_pause_target, 0,
+             "target scavenge pause in ms for the semi-space sizing "
+             "controller (0 means none)")
 DEFINE_INT(max_old_space_size, 0, "max size of the old space (in Mbytes)")
 DEFINE_INT(initial_old_space_size, 0, "initial old space size (in Mbytes)")
 DEFINE_INT(max_executable_size, 0, "max size of executable memory (in Mbytes)")
@@ -663,8 +690,50 @@ DEFINE_INT(min_progress_during_object_groups_marking, 128,
            "least this many unmarked objects")
 DEFINE_INT(max_object_groups_marking_rounds, 3,
            "at most try this many times to over approximate the weak closure")
+DEFINE_BOOL(concurrent_marking, false,
+            "use a background thread for incremental marking")
 DEFINE_BOOL(concurrent_sweeping, true, "use concurrent sweeping")
 DEFINE_BOOL(parallel_compaction, false, "use parallel compaction")
+DEFINE_BOOL(parallel_scavenge, false, "use parallel scavenging")
+DEFINE_INT(scavenge_tasks, 0,
+           "number of parallel scavenging tasks (0 means choose automatically)")
+DEFINE_BOOL(parallel_pointer_update, false,
+            "update pointers to evacuated objects in parallel")
+DEFINE_INT(pointer_update_tasks, 0,
+           "number of parallel pointer updating tasks (0 means choose "
+           "automatically)")
+DEFINE_INT(ephemeron_fixpoint_iterations, 10,
+           "number of fixpoint iterations over weak collections before "
+           "switching to linear ephemeron marking")
+DEFINE_BOOL(parallel_weak_processing, false,
+            "clear dead weak cells and weak collection entries in parallel")
+DEFINE_BOOL(page_promotion, false,
+            "promote mostly live new space pages to old space in one copy")
+DEFINE_INT(page_promotion_threshold, 70,
+           "min percentage of live bytes on a new space page to promote it "
+           "as a whole")
+DEFINE_BOOL(large_page_pool, false,
+            "keep freed large object pages mapped for reuse by later large "
+            "allocations")
+DEFINE_INT(large_page_pool_size, 16,
+           "maximum amount of memory in MB kept in the large page pool")
+DEFINE_INT(large_page_pool_decay, 1000,
+           "time in ms after which pooled large pages are unmapped")
+DEFINE_BOOL(heap_huge_pages, false,
+            "back old space and map space pages with transparent huge pages "
+            "(Linux only)")
+DEFINE_BOOL(incremental_external_string_finalization, false,
+            "dispose the resources of dead external strings in small steps "
+            "after the garbage collection pause")
+DEFINE_BOOL(concurrent_array_buffer_freeing, false,
+            "free the backing stores of dead array buffers on a background "
+            "thread")
+DEFINE_BOOL(parallel_marking, false,
+            "use parallel marking in the atomic pause of mark-compact")
+DEFINE_INT(marking_tasks, 0,
+           "number of parallel marking tasks (0 means choose automatically)")
+DEFINE_FLOAT(gc_pause_budget, 0,
+             "target maximum garbage collection pause in ms (0 means none)")
 DEFINE_BOOL(trace_incremental_marking, false,
             "trace progress of the incremental marking")
 DEFINE_BOOL(track_gc_object_stats, false,
@@ -710,6 +779,15 @@ DEFINE_BOOL(always_compact, false, "Perform compaction on every full GC")
 DEFINE_BOOL(never_compact, false,
             "Never perform compaction on full GC - testing only")
 DEFINE_BOOL(compact_code_space, true, "Compact code space on full collections")
+DEFINE_BOOL(compaction_scoring, false,
+            "select evacuation candidates by the memory they free per "
+            "predicted evacuation time")
+DEFINE_INT(compaction_min_fragmentation, 30,
+           "minimum percentage of free memory on a page for it to be "
+           "considered for compaction with --compaction-scoring")
+DEFINE_FLOAT(compaction_time_budget, 2.0,
+             "predicted evacuation time in ms that candidates selected with "
+             "--compaction-scoring may take per space")
 DEFINE_BOOL(cleanup_code_caches_at_gc, true,
             "Flush inline caches prior to mark compact collection and "
             "flush code caches in maps during mark compact cycle.")
@@ -817,6 +895,13 @@ DEFINE_NEG_IMPLICATION(predictable, concurrent_recompilation)
 DEFINE_NEG_IMPLICATION(predictable, concurrent_osr)
 DEFINE_NEG_IMPLICATION(predictable, concurrent_sweeping)
 DEFINE_NEG_IMPLICATION(predictable, parallel_compaction)
+DEFINE_NEG_IMPLICATION(predictable, parallel_pointer_update)
+DEFINE_NEG_IMPLICATION(predictable, parallel_weak_processing)
+DEFINE_NEG_IMPLICATION(predictable, parallel_scavenge)
+DEFINE_NEG_IMPLICATION(predictable, concurrent_marking)
+DEFINE_NEG_IMPLICATION(predictable, parallel_marking)
+DEFINE_NEG_IMPLICATION(predictable, concurrent_array_buffer_freeing)
+DEFINE_NEG_IMPLICATION(predictable, semi_space_sizing_controller)
 
 // mark-compact.cc
 DEFINE_BOOL(force_marking_deque_overflows, false,
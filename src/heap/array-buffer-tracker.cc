@@ -3,7 +3,8 @@
 // found in the LICENSE file.
 
 #include "src/heap/array-buffer-tracker.h"
-#include "src/heap/heap.h"
+#include "src/heap/heap-inl.h"
+#include "src/heap/mark-compact.h"
 #include "src/isolate.h"
 #include "src/objects.h"
 #include "src/objects-inl.h"
@@ -12,22 +13,86 @@
 namespace v8 {
 namespace internal {
 
+bool LocalArrayBufferTracker::Remove(Address buffer,
+                                     BackingStore* backing_store) {
+  auto it = array_buffers_.find(buffer);
+  if (it == array_buffers_.end()) return false;
+  *backing_store = it->second;
+  array_buffers_.erase(it);
+  return true;
+}
+
+
+void LocalArrayBufferTracker::RemoveDead(std::vector<BackingStore>* dead) {
+  auto it = array_buffers_.begin();
+  while (it != array_buffers_.end()) {
+    if (Marking::IsBlack(Marking::MarkBitFrom(it->first))) {
+      ++it;
+    } else {
+      dead->push_back(it->second);
+      it = array_buffers_.erase(it);
+    }
+  }
+}
+
+
+void LocalArrayBufferTracker::RemoveAll(std::vector<BackingStore>* dead) {
+  for (auto& buffer : array_buffers_) {
+    dead->push_back(buffer.second);
+  }
+  array_buffers_.clear();
+}
+
+
+class ArrayBufferTracker::FreeingTask : public v8::Task {
+ public:
+  FreeingTask(ArrayBufferTracker* tracker,
+              std::vector<BackingStore>* backing_stores)
+      : tracker_(tracker), backing_stores_(backing_stores) {}
+
+  virtual ~FreeingTask() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override {
+    tracker_->FreeBackingStores(backing_stores_);
+    delete backing_stores_;
+    tracker_->pending_freeing_tasks_semaphore_.Signal();
+  }
+
+  ArrayBufferTracker* tracker_;
+  std::vector<BackingStore>* backing_stores_;
+
+  DISALLOW_COPY_AND_ASSIGN(FreeingTask);
+};
+
+
 ArrayBufferTracker::~ArrayBufferTracker() {
-  Isolate* isolate = heap()->isolate();
-  size_t freed_memory = 0;
-  for (auto& buffer : live_array_buffers_) {
-    isolate->array_buffer_allocator()->Free(buffer.first, buffer.second);
-    freed_memory += buffer.second;
+  for (; pending_freeing_tasks_ > 0; pending_freeing_tasks_--) {
+    pending_freeing_tasks_semaphore_.Wait();
+  }
+
+  std::vector<BackingStore> backing_stores;
+  backing_stores.swap(queued_backing_stores_);
+  PageIterator it(heap()->old_space());
+  while (it.has_next()) {
+    Page* page = it.next();
+    if (page->local_tracker() != nullptr) {
+      page->local_tracker()->RemoveAll(&backing_stores);
+    }
   }
   for (auto& buffer : live_array_buffers_for_scavenge_) {
-    isolate->array_buffer_allocator()->Free(buffer.first, buffer.second);
-    freed_memory += buffer.second;
+    backing_stores.push_back(BackingStore(buffer.first, buffer.second));
   }
-  live_array_buffers_.clear();
   live_array_buffers_for_scavenge_.clear();
-  not_yet_discovered_array_buffers_.clear();
   not_yet_discovered_array_buffers_for_scavenge_.clear();
 
+  size_t freed_memory = 0;
+  for (auto& backing_store : backing_stores) {
+    freed_memory += backing_store.second;
+  }
+  FreeBackingStores(&backing_stores);
+
   if (freed_memory > 0) {
     heap()->update_amount_of_external_allocated_memory(
         -static_cast<int64_t>(freed_memory));
@@ -44,7 +109,9 @@ void ArrayBufferTracker::RegisterNew(JSArrayBuffer* buffer) {
   if (in_new_space) {
     live_array_buffers_for_scavenge_[data] = length;
   } else {
-    live_array_buffers_[data] = length;
+    base::LockGuard<base::Mutex> guard(&mutex_);
+    AddToPage(Page::FromAddress(buffer->address()), buffer->address(), data,
+              length);
   }
 
   // We may go over the limit of externally allocated memory here. We call the
@@ -58,18 +125,22 @@ void ArrayBufferTracker::Unregister(JSArrayBuffer* buffer) {
   void* data = buffer->backing_store();
   if (!data) return;
 
-  bool in_new_space = heap()->InNewSpace(buffer);
-  std::map<void*, size_t>* live_buffers =
-      in_new_space ? &live_array_buffers_for_scavenge_ : &live_array_buffers_;
-  std::map<void*, size_t>* not_yet_discovered_buffers =
-      in_new_space ? &not_yet_discovered_array_buffers_for_scavenge_
-                   : &not_yet_discovered_array_buffers_;
-
-  DCHECK(live_buffers->count(data) > 0);
-
-  size_t length = (*live_buffers)[data];
-  live_buffers->erase(data);
-  not_yet_discovered_buffers->erase(data);
+  size_t length;
+  if (heap()->InNewSpace(buffer)) {
+    DCHECK(live_array_buffers_for_scavenge_.count(data) > 0);
+    length = live_array_buffers_for_scavenge_[data];
+    live_array_buffers_for_scavenge_.erase(data);
+    not_yet_discovered_array_buffers_for_scavenge_.erase(data);
+  } else {
+    base::LockGuard<base::Mutex> guard(&mutex_);
+    LocalArrayBufferTracker* tracker =
+        Page::FromAddress(buffer->address())->local_tracker();
+    BackingStore backing_store;
+    CHECK(tracker != nullptr &&
+          tracker->Remove(buffer->address(), &backing_store));
+    DCHECK_EQ(data, backing_store.first);
+    length = backing_store.second;
+  }
 
   heap()->update_amount_of_external_allocated_memory(
       -static_cast<int64_t>(length));
@@ -81,38 +152,27 @@ void ArrayBufferTracker::MarkLive(JSArrayBuffer* buffer) {
 
   // ArrayBuffer might be in the middle of being constructed.
   if (data == heap()->undefined_value()) return;
-  if (heap()->InNewSpace(buffer)) {
-    not_yet_discovered_array_buffers_for_scavenge_.erase(data);
-  } else {
-    not_yet_discovered_array_buffers_.erase(data);
-  }
+  // Old space ArrayBuffers are kept alive by their mark bits.
+  if (!heap()->InNewSpace(buffer)) return;
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  not_yet_discovered_array_buffers_for_scavenge_.erase(data);
 }
 
 
-void ArrayBufferTracker::FreeDead(bool from_scavenge) {
-  size_t freed_memory = 0;
-  Isolate* isolate = heap()->isolate();
-  for (auto& buffer : not_yet_discovered_array_buffers_for_scavenge_) {
-    isolate->array_buffer_allocator()->Free(buffer.first, buffer.second);
-    freed_memory += buffer.second;
-    live_array_buffers_for_scavenge_.erase(buffer.first);
-  }
-
-  if (!from_scavenge) {
-    for (auto& buffer : not_yet_discovered_array_buffers_) {
-      isolate->array_buffer_allocator()->Free(buffer.first, buffer.second);
-      freed_memory += buffer.second;
-      live_array_buffers_.erase(buffer.first);
+void ArrayBufferTracker::FreeDeadInNewSpace() {
+  {
+    base::LockGuard<base::Mutex> guard(&mutex_);
+    for (auto& buffer : not_yet_discovered_array_buffers_for_scavenge_) {
+      queued_backing_stores_.push_back(
+          BackingStore(buffer.first, buffer.second));
+      live_array_buffers_for_scavenge_.erase(buffer.first);
     }
   }
 
   not_yet_discovered_array_buffers_for_scavenge_ =
       live_array_buffers_for_scavenge_;
-  if (!from_scavenge) not_yet_discovered_array_buffers_ = live_array_buffers_;
 
-  // Do not call through the api as this code is triggered while doing a GC.
-  heap()->update_amount_of_external_allocated_memory(
-      -static_cast<int64_t>(freed_memory));
+  FreeQueued();
 }
 
 
@@ -128,11 +188,94 @@ void ArrayBufferTracker::Promote(JSArrayBuffer* buffer) {
   if (!data) return;
   // ArrayBuffer might be in the middle of being constructed.
   if (data == heap()->undefined_value()) return;
+  base::LockGuard<base::Mutex> guard(&mutex_);
   DCHECK(live_array_buffers_for_scavenge_.count(data) > 0);
-  live_array_buffers_[data] = live_array_buffers_for_scavenge_[data];
+  AddToPage(Page::FromAddress(buffer->address()), buffer->address(), data,
+            live_array_buffers_for_scavenge_[data]);
   live_array_buffers_for_scavenge_.erase(data);
   not_yet_discovered_array_buffers_for_scavenge_.erase(data);
 }
 
+
+void ArrayBufferTracker::Move(Address old_address, JSArrayBuffer* buffer) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  LocalArrayBufferTracker* tracker =
+      Page::FromAddress(old_address)->local_tracker();
+  BackingStore backing_store;
+  // External and not yet constructed ArrayBuffers are not tracked.
+  if (tracker == nullptr || !tracker->Remove(old_address, &backing_store)) {
+    return;
+  }
+  AddToPage(Page::FromAddress(buffer->address()), buffer->address(),
+            backing_store.first, backing_store.second);
+}
+
+
+void ArrayBufferTracker::FreeDeadOnPage(Page* page) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  LocalArrayBufferTracker* tracker = page->local_tracker();
+  if (tracker == nullptr) return;
+  tracker->RemoveDead(&queued_backing_stores_);
+}
+
+
+void ArrayBufferTracker::FreeAllOnPage(Page* page) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  LocalArrayBufferTracker* tracker = page->local_tracker();
+  if (tracker == nullptr) return;
+  tracker->RemoveAll(&queued_backing_stores_);
+}
+
+
+void ArrayBufferTracker::FreeQueued() {
+  std::vector<BackingStore>* backing_stores = new std::vector<BackingStore>();
+  {
+    base::LockGuard<base::Mutex> guard(&mutex_);
+    backing_stores->swap(queued_backing_stores_);
+  }
+  if (backing_stores->empty()) {
+    delete backing_stores;
+    return;
+  }
+
+  size_t freed_memory = 0;
+  for (auto& backing_store : *backing_stores) {
+    freed_memory += backing_store.second;
+  }
+  // Do not call through the api as this code is triggered while doing a GC.
+  heap()->update_amount_of_external_allocated_memory(
+      -static_cast<int64_t>(freed_memory));
+
+  if (FLAG_concurrent_array_buffer_freeing) {
+    pending_freeing_tasks_++;
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new FreeingTask(this, backing_stores),
+        v8::Platform::kShortRunningTask);
+  } else {
+    FreeBackingStores(backing_stores);
+    delete backing_stores;
+  }
+}
+
+
+void ArrayBufferTracker::AddToPage(Page* page, Address buffer, void* data,
+                                   size_t length) {
+  DCHECK(page->owner()->identity() == OLD_SPACE);
+  if (page->local_tracker() == nullptr) {
+    page->set_local_tracker(new LocalArrayBufferTracker());
+  }
+  page->local_tracker()->Add(buffer, data, length);
+}
+
+
+void ArrayBufferTracker::FreeBackingStores(
+    std::vector<BackingStore>* backing_stores) {
+  v8::ArrayBuffer::Allocator* allocator =
+      heap()->isolate()->array_buffer_allocator();
+  for (auto& backing_store : *backing_stores) {
+    allocator->Free(backing_store.first, backing_store.second);
+  }
+}
+
 }  // namespace internal
 }  // namespace v8
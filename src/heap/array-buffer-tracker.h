@@ -6,7 +6,11 @@
 #define V8_HEAP_ARRAY_BUFFER_TRACKER_H_
 
 #include <map>
+#include <utility>
+#include <vector>
 
+#include "src/base/platform/mutex.h"
+#include "src/base/platform/semaphore.h"
 #include "src/globals.h"
 
 namespace v8 {
@@ -15,10 +19,53 @@ namespace internal {
 // Forward declarations.
 class Heap;
 class JSArrayBuffer;
+class Page;
+
+// Tracks the backing stores of the ArrayBuffers that live on a single old
+// space page. Liveness of the ArrayBuffers is taken from the mark bits of the
+// page when it is swept, so no separate discovery pass is needed.
+//
+// Note: Not thread-safe. Accesses are guarded by the mutex of the owning
+// ArrayBufferTracker.
+class LocalArrayBufferTracker {
+ public:
+  typedef std::pair<void*, size_t> BackingStore;
+
+  LocalArrayBufferTracker() {}
+  ~LocalArrayBufferTracker() { DCHECK(IsEmpty()); }
+
+  void Add(Address buffer, void* data, size_t length) {
+    array_buffers_[buffer] = BackingStore(data, length);
+  }
+
+  // Removes |buffer| and stores its backing store in |backing_store|. Returns
+  // false if the ArrayBuffer is not tracked on this page.
+  bool Remove(Address buffer, BackingStore* backing_store);
+
+  // Moves the backing stores of ArrayBuffers that are not marked to |dead|.
+  void RemoveDead(std::vector<BackingStore>* dead);
+
+  // Moves all backing stores to |dead|.
+  void RemoveAll(std::vector<BackingStore>* dead);
+
+  bool IsEmpty() { return array_buffers_.empty(); }
+
+ private:
+  // Maps the address of an ArrayBuffer to its backing store.
+  std::map<Address, BackingStore> array_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(LocalArrayBufferTracker);
+};
+
 
 class ArrayBufferTracker {
  public:
-  explicit ArrayBufferTracker(Heap* heap) : heap_(heap) {}
+  typedef LocalArrayBufferTracker::BackingStore BackingStore;
+
+  explicit ArrayBufferTracker(Heap* heap)
+      : heap_(heap),
+        pending_freeing_tasks_(0),
+        pending_freeing_tasks_semaphore_(0) {}
   ~ArrayBufferTracker();
 
   inline Heap* heap() { return heap_; }
@@ -32,41 +79,73 @@ class ArrayBufferTracker {
   // The backing store |data| is no longer owned by V8.
   void Unregister(JSArrayBuffer* buffer);
 
-  // A live ArrayBuffer was discovered during marking/scavenge.
+  // A live ArrayBuffer in new space was discovered during marking/scavenge.
+  // May be called concurrently by parallel scavenging tasks.
   void MarkLive(JSArrayBuffer* buffer);
 
-  // Frees all backing store pointers that weren't discovered in the previous
-  // marking or scavenge phase.
-  void FreeDead(bool from_scavenge);
+  // Frees all new space backing store pointers that weren't discovered in the
+  // previous marking or scavenge phase. Old space backing stores are freed
+  // when their pages are swept.
+  void FreeDeadInNewSpace();
 
   // Prepare for a new scavenge phase. A new marking phase is implicitly
   // prepared by finishing the previous one.
   void PrepareDiscoveryInNewSpace();
 
-  // An ArrayBuffer moved from new space to old space.
+  // An ArrayBuffer moved from new space to old space. May be called
+  // concurrently by parallel scavenging tasks.
   void Promote(JSArrayBuffer* buffer);
 
+  // An old space ArrayBuffer moved from |old_address| during compaction. May
+  // be called concurrently by parallel compaction tasks.
+  void Move(Address old_address, JSArrayBuffer* buffer);
+
+  // Queues the backing stores of the ArrayBuffers on |page| that were not
+  // marked. Called when the page is swept, possibly on a sweeper task.
+  void FreeDeadOnPage(Page* page);
+
+  // Queues the backing stores of all ArrayBuffers on |page|, which is about
+  // to be released.
+  void FreeAllOnPage(Page* page);
+
+  // Hands the queued backing stores over to a background task, or frees them
+  // right away without --concurrent-array-buffer-freeing.
+  void FreeQueued();
+
  private:
+  class FreeingTask;
+
+  // Requires |mutex_|.
+  void AddToPage(Page* page, Address buffer, void* data, size_t length);
+
+  void FreeBackingStores(std::vector<BackingStore>* backing_stores);
+
   Heap* heap_;
 
-  // |live_array_buffers_| maps externally allocated memory used as backing
-  // store for ArrayBuffers to the length of the respective memory blocks.
-  //
-  // At the beginning of mark/compact, |not_yet_discovered_array_buffers_| is
-  // a copy of |live_array_buffers_| and we remove pointers as we discover live
-  // ArrayBuffer objects during marking. At the end of mark/compact, the
-  // remaining memory blocks can be freed.
-  std::map<void*, size_t> live_array_buffers_;
-  std::map<void*, size_t> not_yet_discovered_array_buffers_;
-
-  // To be able to free memory held by ArrayBuffers during scavenge as well, we
-  // have a separate list of allocated memory held by ArrayBuffers in new space.
+  // Guards the discovery maps against concurrent updates from parallel
+  // scavenging tasks, and the per page trackers and the queue of backing
+  // stores to free against concurrent sweeper and compaction tasks.
+  base::Mutex mutex_;
+
+  // |live_array_buffers_for_scavenge_| maps externally allocated memory used
+  // as backing store for new space ArrayBuffers to the length of the
+  // respective memory blocks. Old space ArrayBuffers are tracked per page in
+  // LocalArrayBufferTracker.
   //
-  // Since mark/compact also evacuates the new space, all pointers in the
-  // |live_array_buffers_for_scavenge_| list are also in the
-  // |live_array_buffers_| list.
+  // At the beginning of a scavenge, |not_yet_discovered_array_buffers_| is a
+  // copy of |live_array_buffers_for_scavenge_| and we remove pointers as we
+  // discover live ArrayBuffer objects. At the end of the scavenge, the
+  // remaining memory blocks can be freed. Mark/compact evacuates the new
+  // space and does the same.
   std::map<void*, size_t> live_array_buffers_for_scavenge_;
   std::map<void*, size_t> not_yet_discovered_array_buffers_for_scavenge_;
+
+  // Backing stores of dead ArrayBuffers that have not yet been handed over to
+  // a freeing task.
+  std::vector<BackingStore> queued_backing_stores_;
+
+  int pending_freeing_tasks_;
+  base::Semaphore pending_freeing_tasks_semaphore_;
 };
 }  // namespace internal
 }  // namespace v8
@@ -0,0 +1,270 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/heap/concurrent-marking.h"
+
+#include "src/heap/heap-inl.h"
+#include "src/heap/incremental-marking.h"
+#include "src/heap/mark-compact-inl.h"
+#include "src/heap/objects-visiting.h"
+#include "src/v8.h"
+
+namespace v8 {
+namespace internal {
+
+class ConcurrentMarking::Task : public v8::Task {
+ public:
+  explicit Task(ConcurrentMarking* concurrent_marking)
+      : concurrent_marking_(concurrent_marking) {}
+
+  virtual ~Task() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override { concurrent_marking_->Run(); }
+
+  ConcurrentMarking* concurrent_marking_;
+
+  DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+
+ConcurrentMarking::ConcurrentMarking(Heap* heap)
+    : heap_(heap),
+      pending_task_semaphore_(0),
+      task_pending_(false),
+      preemption_requested_(false),
+      is_compacting_(false),
+      bytes_marked_(0),
+      total_bytes_marked_(0) {}
+
+
+ConcurrentMarking::~ConcurrentMarking() { AbortTask(); }
+
+
+void ConcurrentMarking::ScheduleTask() {
+  if (!TryFinishTask()) return;
+
+  MarkingDeque* marking_deque =
+      heap_->mark_compact_collector()->marking_deque();
+  if (marking_deque->IsEmpty()) return;
+
+  // Explicitly skip one word fillers. Incremental markbit patterns are
+  // correct only for objects that occupy at least two words.
+  Map* filler_map = heap_->one_pointer_filler_map();
+  while (!marking_deque->IsEmpty()) {
+    HeapObject* object = marking_deque->Pop();
+    if (object->map() == filler_map) continue;
+    worklist_.Add(object);
+  }
+  if (worklist_.is_empty()) return;
+
+  is_compacting_ = heap_->incremental_marking()->IsCompacting();
+  bytes_marked_ = 0;
+  preemption_requested_.SetValue(false);
+  task_pending_ = true;
+  V8::GetCurrentPlatform()->CallOnBackgroundThread(
+      new Task(this), v8::Platform::kShortRunningTask);
+}
+
+
+bool ConcurrentMarking::TryFinishTask() {
+  if (!task_pending_) return true;
+  if (!pending_task_semaphore_.WaitFor(base::TimeDelta::FromSeconds(0))) {
+    return false;
+  }
+  task_pending_ = false;
+  PublishResults();
+  return true;
+}
+
+
+void ConcurrentMarking::FinishTask() {
+  if (!task_pending_) return;
+  WaitForTask(true);
+  PublishResults();
+}
+
+
+void ConcurrentMarking::AbortTask() {
+  if (task_pending_) WaitForTask(true);
+  DropResults();
+}
+
+
+void ConcurrentMarking::WaitForTask(bool preempt) {
+  DCHECK(task_pending_);
+  if (preempt) preemption_requested_.SetValue(true);
+  pending_task_semaphore_.Wait();
+  task_pending_ = false;
+}
+
+
+void ConcurrentMarking::PublishResults() {
+  DCHECK(!task_pending_);
+  DCHECK(heap_->incremental_marking()->IsMarking());
+  MarkCompactCollector* collector = heap_->mark_compact_collector();
+
+  for (auto& entry : live_bytes_) {
+    entry.first->IncrementLiveBytes(static_cast<int>(entry.second));
+  }
+  live_bytes_.clear();
+
+  // Slots may have been overwritten since they were recorded, RecordSlot
+  // filters them again.
+  for (int i = 0; i < recorded_slots_.length(); i++) {
+    RecordedSlot& recorded = recorded_slots_[i];
+    Object* target = *recorded.slot;
+    if (target->IsHeapObject()) {
+      collector->RecordSlot(recorded.host, recorded.slot, target);
+    }
+  }
+  recorded_slots_.Rewind(0);
+
+  // Objects that the task claimed but did not scan are black. They are handed
+  // back as grey objects so that they are found again when the marking deque
+  // overflows.
+  MarkingDeque* marking_deque = collector->marking_deque();
+  for (int i = 0; i < bailout_.length(); i++) worklist_.Add(bailout_[i]);
+  bailout_.Rewind(0);
+  for (int i = 0; i < worklist_.length(); i++) {
+    HeapObject* object = worklist_[i];
+    MarkBit mark_bit = Marking::MarkBitFrom(object);
+    if (Marking::IsBlack(mark_bit)) {
+      Marking::BlackToGrey(mark_bit);
+      MemoryChunk::IncrementLiveBytesFromGC(object, -object->Size());
+    }
+    marking_deque->Push(object);
+  }
+  worklist_.Rewind(0);
+
+  total_bytes_marked_ += bytes_marked_;
+  if (FLAG_trace_incremental_marking) {
+    PrintIsolate(heap_->isolate(),
+                 "[IncrementalMarking] Concurrent task marked %" V8_PTR_PREFIX
+                 "d bytes\n",
+                 bytes_marked_);
+  }
+}
+
+
+void ConcurrentMarking::DropResults() {
+  DCHECK(!task_pending_);
+  live_bytes_.clear();
+  recorded_slots_.Rewind(0);
+  bailout_.Rewind(0);
+  worklist_.Rewind(0);
+}
+
+
+void ConcurrentMarking::Run() {
+  intptr_t bytes_marked = 0;
+  while (!worklist_.is_empty() && bytes_marked < kMaxBytesPerTask &&
+         !preemption_requested_.Value()) {
+    bytes_marked += VisitObject(worklist_.RemoveLast());
+  }
+  bytes_marked_ = bytes_marked;
+  pending_task_semaphore_.Signal();
+}
+
+
+// The layout of the objects below only changes in ways that are safe for a
+// concurrent reader: in-place transitions keep tagged fields tagged and
+// trimming leaves valid filler objects behind. Everything else, e.g. objects
+// with raw fields or weak references, is traced on the main thread.
+static const int kNoConcurrentVisit = -1;
+
+static int ConcurrentBodyStartOffset(Map* map) {
+  // Objects without tagged fields return kMaxInt.
+  int id = map->visitor_id();
+  if (id >= StaticVisitorBase::kVisitDataObject &&
+      id <= StaticVisitorBase::kVisitDataObjectGeneric) {
+    return kMaxInt;
+  }
+  if (id >= StaticVisitorBase::kVisitStruct &&
+      id <= StaticVisitorBase::kVisitStructGeneric) {
+    return StructBodyDescriptor::kStartOffset;
+  }
+  if (id >= StaticVisitorBase::kVisitJSObject &&
+      id <= StaticVisitorBase::kVisitJSObjectGeneric) {
+    // Field representation changes write raw doubles into the object before
+    // the new map is installed.
+    if (FLAG_unbox_double_fields) return kNoConcurrentVisit;
+    return JSObject::BodyDescriptor::kStartOffset;
+  }
+  switch (id) {
+    case StaticVisitorBase::kVisitFixedArray:
+      return FixedArray::BodyDescriptor::kStartOffset;
+    case StaticVisitorBase::kVisitSeqOneByteString:
+    case StaticVisitorBase::kVisitSeqTwoByteString:
+    case StaticVisitorBase::kVisitByteArray:
+    case StaticVisitorBase::kVisitFixedDoubleArray:
+      return kMaxInt;
+    default:
+      return kNoConcurrentVisit;
+  }
+}
+
+
+int ConcurrentMarking::VisitObject(HeapObject* object) {
+  Map* map = object->synchronized_map();
+  int start_offset = ConcurrentBodyStartOffset(map);
+  if (start_offset == kNoConcurrentVisit) {
+    bailout_.Add(object);
+    return 0;
+  }
+
+  int size = object->SizeFromMap(map);
+  MarkBit mark_bit = Marking::MarkBitFrom(object);
+  if (Marking::IsGrey(mark_bit)) {
+    // Grey objects were handed over by the main thread and are not accounted
+    // for yet.
+    if (!Marking::GreyToBlackAtomic(mark_bit)) return 0;
+    AccountLiveBytes(object, size);
+  }
+
+  MarkObject(map);
+  if (start_offset < size) {
+    VisitPointers(object, HeapObject::RawField(object, start_offset),
+                  HeapObject::RawField(object, size));
+  }
+  return size;
+}
+
+
+void ConcurrentMarking::VisitPointers(HeapObject* host, Object** start,
+                                      Object** end) {
+  for (Object** slot = start; slot < end; slot++) {
+    Object* target = reinterpret_cast<Object*>(
+        base::NoBarrier_Load(reinterpret_cast<base::AtomicWord*>(slot)));
+    if (!target->IsHeapObject()) continue;
+    HeapObject* heap_object = HeapObject::cast(target);
+    if (is_compacting_ &&
+        Page::FromAddress(heap_object->address())->IsEvacuationCandidate()) {
+      RecordedSlot recorded = {host, slot};
+      recorded_slots_.Add(recorded);
+    }
+    MarkObject(heap_object);
+  }
+}
+
+
+void ConcurrentMarking::MarkObject(HeapObject* object) {
+  MarkBit mark_bit = Marking::MarkBitFrom(object);
+  if (Marking::IsBlackOrGrey(mark_bit)) return;
+  Map* map = object->synchronized_map();
+  InstanceType type = map->instance_type();
+  if (type == FILLER_TYPE || type == FREE_SPACE_TYPE) return;
+  if (!Marking::WhiteToBlackAtomic(mark_bit)) return;
+  AccountLiveBytes(object, object->SizeFromMap(map));
+  worklist_.Add(object);
+}
+
+
+void ConcurrentMarking::AccountLiveBytes(HeapObject* object, int size) {
+  live_bytes_[MemoryChunk::FromAddress(object->address())] += size;
+}
+
+}  // namespace internal
+}  // namespace v8
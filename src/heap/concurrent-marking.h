@@ -0,0 +1,114 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_HEAP_CONCURRENT_MARKING_H_
+#define V8_HEAP_CONCURRENT_MARKING_H_
+
+#include <map>
+
+#include "src/atomic-utils.h"
+#include "src/base/platform/semaphore.h"
+#include "src/globals.h"
+#include "src/list.h"
+
+namespace v8 {
+namespace internal {
+
+class Heap;
+class HeapObject;
+class Map;
+class MemoryChunk;
+class Object;
+
+// The concurrent marker helps the incremental marker by tracing objects on a
+// background thread while the mutator runs. The main thread hands over the
+// grey objects of the marking deque to a background task, which marks the
+// objects reachable from them and returns what it could not handle:
+//   - Objects whose layout may change under its feet or that need special
+//     (weak) treatment, e.g. maps, code, functions and contexts. These are
+//     "bailed out" to the main thread.
+//   - Objects left over when the task is preempted by a GC.
+//
+// Synchronization with the mutator relies on atomic mark bit updates (see
+// Marking::WhiteToBlackAtomic) and on the write barrier marking every white
+// value that is stored while marking. Objects claimed by the task are marked
+// black right away, live bytes and recorded slots are accumulated locally and
+// published on the main thread when the task is finished.
+class ConcurrentMarking {
+ public:
+  explicit ConcurrentMarking(Heap* heap);
+  ~ConcurrentMarking();
+
+  // Moves the grey objects from the main-thread marking deque to a new
+  // background task. Results of a previous task that has finished in the
+  // meantime are published first. Does nothing while a task is running.
+  void ScheduleTask();
+
+  // Returns true if a task has been posted whose results have not been
+  // published yet.
+  bool IsTaskPending() const { return task_pending_; }
+
+  // Bytes traced by all tasks whose results have been published.
+  intptr_t total_bytes_marked() const { return total_bytes_marked_; }
+
+  // Publishes the results of a finished task without blocking. Returns false
+  // if the task is still running.
+  bool TryFinishTask();
+
+  // Preempts a running task, waits for it and publishes its results. Must be
+  // called before objects are moved, i.e. before every GC.
+  void FinishTask();
+
+  // Preempts a running task, waits for it and drops its results. Used when
+  // incremental marking is stopped without finishing.
+  void AbortTask();
+
+ private:
+  class Task;
+
+  struct RecordedSlot {
+    HeapObject* host;
+    Object** slot;
+  };
+
+  // The task stops after marking this many bytes so that bailouts are
+  // handled by the main thread in a timely manner.
+  static const intptr_t kMaxBytesPerTask = 16 * MB;
+
+  // Body of the background task.
+  void Run();
+
+  void WaitForTask(bool preempt);
+  void PublishResults();
+  void DropResults();
+
+  // Traces the object and returns its size, or returns 0 if the object has
+  // been bailed out to the main thread.
+  int VisitObject(HeapObject* object);
+  void VisitPointers(HeapObject* host, Object** start, Object** end);
+  void MarkObject(HeapObject* object);
+  void AccountLiveBytes(HeapObject* object, int size);
+
+  Heap* heap_;
+  base::Semaphore pending_task_semaphore_;
+  bool task_pending_;
+  AtomicValue<bool> preemption_requested_;
+
+  // The following fields are owned by the task while it is pending and by
+  // the main thread otherwise.
+  bool is_compacting_;
+  List<HeapObject*> worklist_;
+  List<HeapObject*> bailout_;
+  List<RecordedSlot> recorded_slots_;
+  std::map<MemoryChunk*, intptr_t> live_bytes_;
+  intptr_t bytes_marked_;
+  intptr_t total_bytes_marked_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentMarking);
+};
+
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_HEAP_CONCURRENT_MARKING_H_
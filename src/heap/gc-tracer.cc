@@ -38,6 +38,11 @@ GCTracer::SurvivalEvent::SurvivalEvent(double promotion_ratio) {
 }
 
 
+GCTracer::CompactionEvent::CompactionEvent(double duration,
+                                           intptr_t live_bytes_compacted)
+    : duration_(duration), live_bytes_compacted_(live_bytes_compacted) {}
+
+
 GCTracer::Event::Event(Type type, const char* gc_reason,
                        const char* collector_reason)
     : type(type),
@@ -314,6 +319,13 @@ void GCTracer::AddSurvivalRatio(double promotion_ratio) {
 }
 
 
+void GCTracer::AddCompactionEvent(double duration,
+                                  intptr_t live_bytes_compacted) {
+  compaction_events_.push_front(
+      CompactionEvent(duration, live_bytes_compacted));
+}
+
+
 void GCTracer::AddIncrementalMarkingStep(double duration, intptr_t bytes) {
   cumulative_incremental_marking_steps_++;
   cumulative_incremental_marking_bytes_ += bytes;
@@ -488,7 +500,6 @@ void GCTracer::PrintNVP() const {
                    "evacuate=%.1f "
                    "new_new=%.1f "
                    "root_new=%.1f "
-                   "old_new=%.1f "
                    "compaction_ptrs=%.1f "
                    "intracompaction_ptrs=%.1f "
                    "misc_compaction=%.1f "
@@ -551,7 +562,6 @@ void GCTracer::PrintNVP() const {
                    current_.scopes[Scope::MC_EVACUATE_PAGES],
                    current_.scopes[Scope::MC_UPDATE_NEW_TO_NEW_POINTERS],
                    current_.scopes[Scope::MC_UPDATE_ROOT_TO_NEW_POINTERS],
-                   current_.scopes[Scope::MC_UPDATE_OLD_TO_NEW_POINTERS],
                    current_.scopes[Scope::MC_UPDATE_POINTERS_TO_EVACUATED],
                    current_.scopes[Scope::MC_UPDATE_POINTERS_BETWEEN_EVACUATED],
                    current_.scopes[Scope::MC_UPDATE_MISC_POINTERS],
@@ -696,6 +706,23 @@ intptr_t GCTracer::ScavengeSpeedInBytesPerMillisecond(
 }
 
 
+intptr_t GCTracer::CompactionSpeedInBytesPerMillisecond() const {
+  if (compaction_events_.size() == 0) return 0;
+  intptr_t bytes = 0;
+  double durations = 0.0;
+  CompactionEventBuffer::const_iterator iter = compaction_events_.begin();
+  while (iter != compaction_events_.end()) {
+    bytes += iter->live_bytes_compacted_;
+    durations += iter->duration_;
+    ++iter;
+  }
+
+  if (durations == 0.0) return 0;
+  // Make sure the result is at least 1.
+  return Max<intptr_t>(static_cast<intptr_t>(bytes / durations + 0.5), 1);
+}
+
+
 intptr_t GCTracer::MarkCompactSpeedInBytesPerMillisecond() const {
   intptr_t bytes = 0;
   double durations = 0.0;
@@ -118,7 +118,6 @@ class GCTracer {
       MC_EVACUATE_PAGES,
       MC_UPDATE_NEW_TO_NEW_POINTERS,
       MC_UPDATE_ROOT_TO_NEW_POINTERS,
-      MC_UPDATE_OLD_TO_NEW_POINTERS,
       MC_UPDATE_POINTERS_TO_EVACUATED,
       MC_UPDATE_POINTERS_BETWEEN_EVACUATED,
       MC_UPDATE_MISC_POINTERS,
@@ -199,6 +198,18 @@ class GCTracer {
   };
 
 
+  class CompactionEvent {
+   public:
+    // Default constructor leaves the event uninitialized.
+    CompactionEvent() {}
+
+    CompactionEvent(double duration, intptr_t live_bytes_compacted);
+
+    double duration_;
+    intptr_t live_bytes_compacted_;
+  };
+
+
   class Event {
    public:
     enum Type {
@@ -314,6 +325,9 @@ class GCTracer {
 
   typedef RingBuffer<SurvivalEvent, kRingBufferMaxSize> SurvivalEventBuffer;
 
+  typedef RingBuffer<CompactionEvent, kRingBufferMaxSize>
+      CompactionEventBuffer;
+
   static const int kThroughputTimeFrameMs = 5000;
 
   explicit GCTracer(Heap* heap);
@@ -336,6 +350,9 @@ class GCTracer {
 
   void AddSurvivalRatio(double survival_ratio);
 
+  // Log the evacuation of |live_bytes_compacted| from evacuation candidates.
+  void AddCompactionEvent(double duration, intptr_t live_bytes_compacted);
+
   // Log an incremental marking step.
   void AddIncrementalMarkingStep(double duration, intptr_t bytes);
 
@@ -408,6 +425,15 @@ class GCTracer {
   // Returns 0 if no events have been recorded.
   intptr_t MarkCompactSpeedInBytesPerMillisecond() const;
 
+  // Compute the average compaction speed in bytes/millisecond.
+  // Returns 0 if no events have been recorded.
+  intptr_t CompactionSpeedInBytesPerMillisecond() const;
+
+  // Duration of the last garbage collection pause. Valid after Stop().
+  double last_gc_pause_in_ms() const {
+    return current_.end_time - current_.start_time;
+  }
+
   // Compute the average incremental mark-sweep finalize speed in
   // bytes/millisecond.
   // Returns 0 if no events have been recorded.
@@ -521,6 +547,9 @@ class GCTracer {
   // RingBuffer for survival events.
   SurvivalEventBuffer survival_events_;
 
+  // RingBuffer for compaction events.
+  CompactionEventBuffer compaction_events_;
+
   // Cumulative number of incremental marking steps since creation of tracer.
   int cumulative_incremental_marking_steps_;
 
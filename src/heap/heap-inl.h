@@ -344,7 +344,12 @@ void Heap::FinalizeExternalString(String* string) {
 
   // Dispose of the C++ object if it has not already been disposed.
   if (*resource_addr != NULL) {
-    (*resource_addr)->Dispose();
+    if (FLAG_incremental_external_string_finalization &&
+        gc_state_ != NOT_IN_GC) {
+      external_string_table_.QueueForDisposal(*resource_addr);
+    } else {
+      (*resource_addr)->Dispose();
+    }
     *resource_addr = NULL;
   }
 }
@@ -586,6 +591,12 @@ void Heap::ExternalStringTable::AddOldString(String* string) {
 }
 
 
+void Heap::ExternalStringTable::QueueForDisposal(
+    v8::String::ExternalStringResourceBase* resource) {
+  disposal_queue_.Add(resource);
+}
+
+
 void Heap::ExternalStringTable::ShrinkNewStrings(int position) {
   new_space_strings_.Rewind(position);
 #ifdef VERIFY_HEAP
@@ -17,6 +17,7 @@
 #include "src/deoptimizer.h"
 #include "src/global-handles.h"
 #include "src/heap/array-buffer-tracker.h"
+#include "src/heap/concurrent-marking.h"
 #include "src/heap/gc-idle-time-handler.h"
 #include "src/heap/gc-tracer.h"
 #include "src/heap/incremental-marking.h"
@@ -26,6 +27,7 @@
 #include "src/heap/object-stats.h"
 #include "src/heap/objects-visiting-inl.h"
 #include "src/heap/objects-visiting.h"
+#include "src/heap/remembered-set.h"
 #include "src/heap/scavenge-job.h"
 #include "src/heap/scavenger-inl.h"
 #include "src/heap/store-buffer.h"
@@ -79,7 +81,6 @@ Heap::Heap()
       always_allocate_scope_count_(0),
       contexts_disposed_(0),
       global_ic_age_(0),
-      scan_on_scavenge_pages_(0),
       new_space_(this),
       old_space_(NULL),
       code_space_(NULL),
@@ -99,8 +100,12 @@ Heap::Heap()
       old_generation_allocation_limit_(initial_old_generation_size_),
       old_gen_exhausted_(false),
       optimize_for_memory_usage_(false),
+      pause_budget_in_ms_(FLAG_gc_pause_budget),
+      pause_budget_violation_callback_(nullptr),
+      scavenge_pause_target_in_ms_(FLAG_scavenge_pause_target),
+      memory_pressure_level_(MemoryPressureLevel::kNone),
+      memory_pressure_check_pending_(false),
       inline_allocation_disabled_(false),
-      store_buffer_rebuilder_(store_buffer()),
       total_regexp_code_generated_(0),
       tracer_(nullptr),
       high_survival_rate_period_length_(0),
@@ -125,9 +130,13 @@ Heap::Heap()
       mark_compact_collector_(nullptr),
       store_buffer_(this),
       incremental_marking_(nullptr),
+      concurrent_marking_(nullptr),
       gc_idle_time_handler_(nullptr),
       memory_reducer_(nullptr),
       object_stats_(nullptr),
+      object_stats_sample_(nullptr),
+      object_stats_sampling_(false),
+      object_stats_callback_(nullptr),
       scavenge_job_(nullptr),
       full_codegen_bytes_generated_(0),
       crankshaft_codegen_bytes_generated_(0),
@@ -143,7 +152,9 @@ Heap::Heap()
       current_gc_flags_(Heap::kNoGCFlags),
       current_gc_callback_flags_(GCCallbackFlags::kNoGCCallbackFlags),
       external_string_table_(this),
+      external_string_disposal_task_pending_(false),
       chunks_queued_for_free_(NULL),
+      large_page_pool_decay_task_pending_(false),
       concurrent_unmapping_tasks_active_(0),
       pending_unmapping_tasks_semaphore_(0),
       gc_callbacks_depth_(0),
@@ -191,7 +202,8 @@ intptr_t Heap::CommittedOldGenerationMemory() {
 intptr_t Heap::CommittedMemory() {
   if (!HasBeenSetUp()) return 0;
 
-  return new_space_.CommittedMemory() + CommittedOldGenerationMemory();
+  return new_space_.CommittedMemory() + CommittedOldGenerationMemory() +
+         isolate()->memory_allocator()->LargePagePoolSize();
 }
 
 
@@ -646,6 +658,8 @@ void Heap::GarbageCollectionEpilogue() {
 
   UpdateMaximumCommitted();
 
+  ScheduleExternalStringDisposal();
+
   isolate_->counters()->alive_after_last_gc()->Set(
       static_cast<int>(SizeOfObjects()));
 
@@ -726,6 +740,7 @@ void Heap::GarbageCollectionEpilogue() {
   new_space_top_after_last_gc_ = new_space()->top();
   last_gc_time_ = MonotonicallyIncreasingTimeInMs();
 
+  if (UsesSemiSpaceSizingController()) ControlNewSpaceSize();
   ReduceNewSpaceSize();
 }
 
@@ -879,6 +894,139 @@ void Heap::CollectAllAvailableGarbage(const char* gc_reason) {
   set_current_gc_flags(kNoGCFlags);
   new_space_.Shrink();
   UncommitFromSpace();
+  DisposeQueuedExternalStrings();
+}
+
+
+void Heap::CollectGarbageOnMemoryPressure(const char* gc_reason) {
+  const int kGarbageThresholdInBytes = 8 * MB;
+  const double kGarbageThresholdAsFractionOfTotalMemory = 0.1;
+  // This constant is the maximum response time in RAIL performance model.
+  const double kMaxMemoryPressurePauseMs = 50;
+
+  double start = MonotonicallyIncreasingTimeInMs();
+  isolate_->compilation_cache()->Clear();
+  CollectAllGarbage(kReduceMemoryFootprintMask | kAbortIncrementalMarkingMask,
+                    gc_reason, kGCCallbackFlagForced);
+  double end = MonotonicallyIncreasingTimeInMs();
+
+  // Estimate how much memory we can free.
+  int64_t potential_garbage = (CommittedMemory() - SizeOfObjects()) +
+                              amount_of_external_allocated_memory_;
+  // If we can potentially free large amount of memory, then start GC right
+  // away instead of waiting for memory reducer.
+  if (potential_garbage >= kGarbageThresholdInBytes &&
+      potential_garbage >=
+          CommittedMemory() * kGarbageThresholdAsFractionOfTotalMemory) {
+    // If we spent less than half of the time budget, then perform full GC
+    // Otherwise, start incremental marking.
+    if (end - start < kMaxMemoryPressurePauseMs / 2) {
+      CollectAllGarbage(
+          kReduceMemoryFootprintMask | kAbortIncrementalMarkingMask, gc_reason,
+          kGCCallbackFlagForced);
+    } else if (FLAG_incremental_marking && incremental_marking()->IsStopped()) {
+      StartIncrementalMarking(kReduceMemoryFootprintMask, kNoGCCallbackFlags,
+                              gc_reason);
+    }
+  }
+  new_space_.Shrink();
+  UncommitFromSpace();
+}
+
+
+class Heap::ExternalStringDisposalTask : public CancelableTask {
+ public:
+  explicit ExternalStringDisposalTask(Heap* heap)
+      : CancelableTask(heap->isolate()), heap_(heap) {}
+
+  virtual ~ExternalStringDisposalTask() {}
+
+ private:
+  // v8::internal::CancelableTask overrides.
+  void RunInternal() override {
+    const double kStepSizeInMs = 1;
+    heap_->external_string_disposal_task_pending_ = false;
+    if (!heap_->external_string_table_.DisposeQueued(
+            heap_->MonotonicallyIncreasingTimeInMs() + kStepSizeInMs)) {
+      heap_->ScheduleExternalStringDisposal();
+    }
+  }
+
+  Heap* heap_;
+  DISALLOW_COPY_AND_ASSIGN(ExternalStringDisposalTask);
+};
+
+
+void Heap::ScheduleExternalStringDisposal() {
+  if (external_string_disposal_task_pending_ ||
+      !external_string_table_.HasQueuedForDisposal()) {
+    return;
+  }
+  external_string_disposal_task_pending_ = true;
+  V8::GetCurrentPlatform()->CallOnForegroundThread(
+      reinterpret_cast<v8::Isolate*>(isolate()),
+      new ExternalStringDisposalTask(this));
+}
+
+
+void Heap::DisposeQueuedExternalStrings() {
+  external_string_table_.DisposeQueued(
+      std::numeric_limits<double>::infinity());
+}
+
+
+class Heap::MemoryPressureInterruptTask : public CancelableTask {
+ public:
+  explicit MemoryPressureInterruptTask(Heap* heap)
+      : CancelableTask(heap->isolate()), heap_(heap) {}
+
+  virtual ~MemoryPressureInterruptTask() {}
+
+ private:
+  // v8::internal::CancelableTask overrides.
+  void RunInternal() override { heap_->CheckMemoryPressure(); }
+
+  Heap* heap_;
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureInterruptTask);
+};
+
+
+static void MemoryPressureInterrupt(v8::Isolate* isolate, void* data) {
+  reinterpret_cast<Heap*>(data)->CheckMemoryPressure();
+}
+
+
+void Heap::MemoryPressureNotification(MemoryPressureLevel level,
+                                      bool is_isolate_locked) {
+  MemoryPressureLevel previous = memory_pressure_level_.Value();
+  memory_pressure_level_.SetValue(level);
+  if ((previous != MemoryPressureLevel::kCritical &&
+       level == MemoryPressureLevel::kCritical) ||
+      (previous == MemoryPressureLevel::kNone &&
+       level == MemoryPressureLevel::kModerate)) {
+    memory_pressure_check_pending_.SetValue(true);
+    if (is_isolate_locked) {
+      CheckMemoryPressure();
+    } else {
+      isolate()->RequestInterrupt(&MemoryPressureInterrupt, this);
+      V8::GetCurrentPlatform()->CallOnForegroundThread(
+          reinterpret_cast<v8::Isolate*>(isolate()),
+          new MemoryPressureInterruptTask(this));
+    }
+  }
+}
+
+
+void Heap::CheckMemoryPressure() {
+  if (!memory_pressure_check_pending_.TrySetValue(true, false)) return;
+  if (memory_pressure_level_.Value() == MemoryPressureLevel::kCritical) {
+    CollectGarbageOnMemoryPressure("memory pressure");
+  } else if (memory_pressure_level_.Value() == MemoryPressureLevel::kModerate) {
+    if (FLAG_incremental_marking && incremental_marking()->IsStopped()) {
+      StartIncrementalMarking(kReduceMemoryFootprintMask, kNoGCCallbackFlags,
+                              "memory pressure");
+    }
+  }
 }
 
 
@@ -958,7 +1106,8 @@ bool Heap::CollectGarbage(GarbageCollector collector, const char* gc_reason,
     incremental_marking()->Step(kStepSizeWhenDelayedByScavenge,
                                 IncrementalMarking::NO_GC_VIA_STACK_GUARD);
     if (!incremental_marking()->IsComplete() &&
-        !mark_compact_collector()->marking_deque_.IsEmpty() &&
+        (!mark_compact_collector()->marking_deque_.IsEmpty() ||
+         concurrent_marking()->IsTaskPending()) &&
         !FLAG_gc_global) {
       if (FLAG_trace_incremental_marking) {
         PrintF("[IncrementalMarking] Delaying MarkSweep.\n");
@@ -968,6 +1117,9 @@ bool Heap::CollectGarbage(GarbageCollector collector, const char* gc_reason,
     }
   }
 
+  // Objects must not move while the concurrent marker is tracing them.
+  concurrent_marking()->FinishTask();
+
   bool next_gc_likely_to_collect_more = false;
   intptr_t committed_memory_before = 0;
 
@@ -1015,6 +1167,8 @@ bool Heap::CollectGarbage(GarbageCollector collector, const char* gc_reason,
     tracer()->Stop(collector);
   }
 
+  if (HasPauseBudget()) CheckPauseBudget(collector);
+
   if (collector == MARK_COMPACTOR &&
       (gc_callback_flags & kGCCallbackFlagForced) != 0) {
     isolate()->CountUsage(v8::Isolate::kForcedGC);
@@ -1031,6 +1185,34 @@ bool Heap::CollectGarbage(GarbageCollector collector, const char* gc_reason,
 }
 
 
+void Heap::SetPauseBudget(
+    double budget_in_ms, v8::Isolate::GCPauseBudgetViolationCallback callback) {
+  DCHECK(budget_in_ms >= 0);
+  pause_budget_in_ms_ = budget_in_ms;
+  pause_budget_violation_callback_ = callback;
+}
+
+
+void Heap::CheckPauseBudget(GarbageCollector collector) {
+  double pause = tracer()->last_gc_pause_in_ms();
+  if (pause <= pause_budget_in_ms_) return;
+  isolate()->counters()->gc_pause_budget_violations()->Increment();
+  if (FLAG_trace_gc_verbose) {
+    PrintIsolate(isolate_,
+                 "%s pause of %.1f ms exceeded the budget of %.1f ms\n",
+                 collector == SCAVENGER ? "Scavenge" : "Mark-compact", pause,
+                 pause_budget_in_ms_);
+  }
+  if (pause_budget_violation_callback_ == nullptr) return;
+  GCType type =
+      collector == SCAVENGER ? kGCTypeScavenge : kGCTypeMarkSweepCompact;
+  VMState<EXTERNAL> state(isolate_);
+  HandleScope handle_scope(isolate_);
+  pause_budget_violation_callback_(reinterpret_cast<v8::Isolate*>(isolate_),
+                                   type, pause, pause_budget_in_ms_);
+}
+
+
 int Heap::NotifyContextDisposed(bool dependant_context) {
   if (!dependant_context) {
     tracer()->ResetSurvivalEvents();
@@ -1476,7 +1658,82 @@ static void VerifyNonPointerSpacePointers(Heap* heap) {
 #endif  // VERIFY_HEAP
 
 
+bool Heap::NewSpaceGrowthFitsPauseBudget() {
+  if (!HasPauseBudget()) return true;
+  intptr_t speed = tracer()->ScavengeSpeedInBytesPerMillisecond(
+      kForSurvivedObjects);
+  if (speed == 0) return true;
+  // The survivors of a scavenge scale with the size of the semi-space, which
+  // doubles when the new space grows.
+  double predicted_pause =
+      2.0 * static_cast<double>(survived_last_scavenge_) / speed;
+  return predicted_pause <= pause_budget_in_ms_;
+}
+
+
+void Heap::ControlNewSpaceSize() {
+  // Every scavenge has a cost independent of the new space size for
+  // processing roots and the remembered set, and a cost proportional to the
+  // surviving objects. With allocation throughput T, survival rate s,
+  // scavenge speed v and capacity C, scavenges take
+  //   T / C * (kFixedCost + s * C / v) = T * kFixedCost / C + T * s / v
+  // per ms of mutator time. The overhead falls with the capacity, so pick the
+  // smallest capacity that brings it down to kTargetOverhead, and bound it by
+  // the capacity whose survivors can be scavenged within the pause target.
+  const double kFixedCostInMs = 0.5;
+  const double kTargetOverhead = 0.01;
+  // Shrink only if the wanted capacity is far below the current one, so that
+  // bursts of allocations do not make the new space oscillate.
+  const int kShrinkHysteresisFactor = 2;
+
+  double throughput = static_cast<double>(
+      tracer()->NewSpaceAllocationThroughputInBytesPerMillisecond());
+  double speed = static_cast<double>(
+      tracer()->ScavengeSpeedInBytesPerMillisecond(kForSurvivedObjects));
+  if (throughput == 0 || speed == 0 || !tracer()->SurvivalEventsRecorded()) {
+    return;
+  }
+  double survival_rate = tracer()->AverageSurvivalRatio() / 100;
+  double proportional_overhead = throughput * survival_rate / speed;
+  double capacity = new_space_.MaximumCapacity();
+  if (proportional_overhead < kTargetOverhead) {
+    capacity = Min(capacity, throughput * kFixedCostInMs /
+                                 (kTargetOverhead - proportional_overhead));
+  }
+  double pause_target = scavenge_pause_target_in_ms_;
+  if (HasPauseBudget() &&
+      (pause_target == 0 || pause_budget_in_ms_ < pause_target)) {
+    pause_target = pause_budget_in_ms_;
+  }
+  if (pause_target > 0 && survival_rate > 0) {
+    capacity = Min(capacity, pause_target * speed / survival_rate);
+  }
+  // The throughput of the first few scavenges says little about the steady
+  // state, so grow at the usual rate instead of jumping to the target. A jump
+  // would also eat up the room that the old generation allocation limit
+  // reserves for the new space and start incremental marking right away.
+  int current_capacity = static_cast<int>(new_space_.TotalCapacity());
+  capacity = Min(capacity, static_cast<double>(current_capacity) *
+                               FLAG_semi_space_growth_factor);
+
+  int target_capacity = static_cast<int>(capacity);
+  if (target_capacity > current_capacity ||
+      target_capacity * kShrinkHysteresisFactor <= current_capacity) {
+    new_space_.Resize(target_capacity);
+  }
+  if (FLAG_trace_gc_verbose) {
+    PrintIsolate(isolate_,
+                 "Semi-space sizing: throughput %.0f bytes/ms, survival "
+                 "%.1f%%, target %d KB, capacity %d KB\n",
+                 throughput, survival_rate * 100, target_capacity / KB,
+                 static_cast<int>(new_space_.TotalCapacity() / KB));
+  }
+}
+
+
 void Heap::CheckNewSpaceExpansionCriteria() {
+  if (UsesSemiSpaceSizingController()) return;
+  if (!NewSpaceGrowthFitsPauseBudget()) return;
   if (FLAG_experimental_new_space_growth_heuristic) {
     if (new_space_.TotalCapacity() < new_space_.MaximumCapacity() &&
         survived_last_scavenge_ * 100 / new_space_.TotalCapacity() >= 10) {
@@ -1501,12 +1758,6 @@ static bool IsUnscavengedHeapObject(Heap* heap, Object** p) {
 }
 
 
-void Heap::ScavengeStoreBufferCallback(Heap* heap, MemoryChunk* page,
-                                       StoreBufferEvent event) {
-  heap->store_buffer_rebuilder_.Callback(page, event);
-}
-
-
 void PromotionQueue::Initialize() {
   // The last to-space page may be used for promotion queue. On promotion
   // conflict, we use the emergency stack.
@@ -1629,8 +1880,6 @@ void Heap::Scavenge() {
     // Copy objects reachable from the old generation.
     GCTracer::Scope gc_scope(tracer(),
                              GCTracer::Scope::SCAVENGER_OLD_TO_NEW_POINTERS);
-    StoreBufferRebuildScope scope(this, store_buffer(),
-                                  &ScavengeStoreBufferCallback);
     store_buffer()->IteratePointersToNewSpace(&Scavenger::ScavengeObject);
   }
 
@@ -1654,6 +1903,10 @@ void Heap::Scavenge() {
 
   {
     GCTracer::Scope gc_scope(tracer(), GCTracer::Scope::SCAVENGER_SEMISPACE);
+    if (scavenge_collector_->CanScavengeInParallel()) {
+      new_space_front =
+          scavenge_collector_->ScavengeInParallel(new_space_front);
+    }
     new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
   }
 
@@ -1690,7 +1943,7 @@ void Heap::Scavenge() {
   // Set age mark.
   new_space_.set_age_mark(new_space_.top());
 
-  array_buffer_tracker()->FreeDead(true);
+  array_buffer_tracker()->FreeDeadInNewSpace();
 
   // Update how much has survived scavenge.
   IncrementYoungSurvivorsCounter(static_cast<int>(
@@ -1816,7 +2069,8 @@ void Heap::EvaluateOldSpaceLocalPretenuring(
       (static_cast<double>(size_of_objects_after_gc) * 100) /
       static_cast<double>(size_of_objects_before_gc);
 
-  if (old_generation_survival_rate < kOldSurvivalRateLowThreshold) {
+  if (old_generation_survival_rate <
+      FLAG_pretenuring_old_survival_threshold) {
     // Too many objects died in the old generation, pretenuring of wrong
     // allocation sites may be the cause for that. We have to deopt all
     // dependent code registered in the allocation sites to re-evaluate
@@ -1828,6 +2082,15 @@ void Heap::EvaluateOldSpaceLocalPretenuring(
           "rate in the old generation %f\n",
           old_generation_survival_rate);
     }
+  } else if (FLAG_pretenuring_reevaluation_interval > 0 &&
+             ms_count_ % FLAG_pretenuring_reevaluation_interval == 0) {
+    // Tenured sites do not produce survival feedback anymore. Send them back
+    // to the young generation from time to time to check that their
+    // decision still holds.
+    ResetAllAllocationSitesDependentCode(TENURED);
+    if (FLAG_trace_pretenuring) {
+      PrintF("Deopt all allocation sites dependent code for re-evaluation\n");
+    }
   }
 }
 
@@ -1877,8 +2140,6 @@ Address Heap::DoScavenge(ObjectVisitor* scavenge_visitor,
 
     // Promote and process all the to-be-promoted objects.
     {
-      StoreBufferRebuildScope scope(this, store_buffer(),
-                                    &ScavengeStoreBufferCallback);
       while (!promotion_queue()->is_empty()) {
         HeapObject* target;
         int size;
@@ -3066,6 +3327,11 @@ bool Heap::CanMoveObjectStart(HeapObject* object) {
 
   if (lo_space()->Contains(object)) return false;
 
+  // The concurrent marker may be reading the object header.
+  if (FLAG_concurrent_marking && incremental_marking()->IsMarking()) {
+    return false;
+  }
+
   Page* page = Page::FromAddress(address);
   // We can move the object start if:
   // (1) the object is not in old space,
@@ -3078,6 +3344,9 @@ bool Heap::CanMoveObjectStart(HeapObject* object) {
 
 
 void Heap::AdjustLiveBytes(HeapObject* object, int by, InvocationMode mode) {
+  // The concurrent marker may account the object with its trimmed size
+  // already. Over-approximating the live bytes of a page is safe.
+  if (FLAG_concurrent_marking && by < 0) return;
   if (incremental_marking()->IsMarking() &&
       Marking::IsBlack(Marking::MarkBitFrom(object->address()))) {
     if (mode == SEQUENTIAL_TO_SWEEPER) {
@@ -3089,6 +3358,15 @@ void Heap::AdjustLiveBytes(HeapObject* object, int by, InvocationMode mode) {
 }
 
 
+void Heap::ClearRecordedSlotRange(HeapObject* object, Address start,
+                                  Address end) {
+  MemoryChunk* chunk = MemoryChunk::FromAddress(object->address());
+  if (chunk->InNewSpace()) return;
+  RememberedSet<OLD_TO_NEW>::RemoveRange(chunk, start, end);
+  RememberedSet<OLD_TO_OLD>::RemoveRange(chunk, start, end);
+}
+
+
 FixedArrayBase* Heap::LeftTrimFixedArray(FixedArrayBase* object,
                                          int elements_to_trim) {
   DCHECK(!object->IsFixedTypedArrayBase());
@@ -3116,6 +3394,7 @@ FixedArrayBase* Heap::LeftTrimFixedArray(FixedArrayBase* object,
   // debug mode which iterates through the heap), but to play safer
   // we still do it.
   CreateFillerObjectAt(object->address(), bytes_to_trim);
+  ClearRecordedSlotRange(object, object->address(), new_start);
 
   // Initialize header of the trimmed array. Since left trimming is only
   // performed on pages which are not concurrently swept creating a filler
@@ -3184,6 +3463,7 @@ void Heap::RightTrimFixedArray(FixedArrayBase* object, int elements_to_trim) {
   if (!lo_space()->Contains(object)) {
     CreateFillerObjectAt(new_end, bytes_to_trim);
   }
+  ClearRecordedSlotRange(object, new_end, new_end + bytes_to_trim);
 
   // Initialize header of the trimmed array. We are storing the new length
   // using release store after creating a filler for the left-over space to
@@ -4061,7 +4341,7 @@ void Heap::ReduceNewSpaceSize() {
   if (FLAG_predictable) return;
 
   if (ShouldReduceMemory() ||
-      ((allocation_throughput != 0) &&
+      (!UsesSemiSpaceSizingController() && (allocation_throughput != 0) &&
        (allocation_throughput < kLowAllocationThroughput))) {
     new_space_.Shrink();
     UncommitFromSpace();
@@ -4449,10 +4729,6 @@ void Heap::IterateAndMarkPointersToFromSpace(HeapObject* object, Address start,
   while (slot_address < end) {
     Object** slot = reinterpret_cast<Object**>(slot_address);
     Object* target = *slot;
-    // If the store buffer becomes overfull we mark pages as being exempt from
-    // the store buffer.  These pages are scanned to find pointers that point
-    // to the new space.  In that case we may hit newly promoted objects and
-    // fix the pointers before the promotion queue gets to them.  Thus the 'if'.
     if (target->IsHeapObject()) {
       if (Heap::InFromSpace(target)) {
         callback(reinterpret_cast<HeapObject**>(slot),
@@ -4461,8 +4737,8 @@ void Heap::IterateAndMarkPointersToFromSpace(HeapObject* object, Address start,
         if (InNewSpace(new_target)) {
           SLOW_DCHECK(Heap::InToSpace(new_target));
           SLOW_DCHECK(new_target->IsHeapObject());
-          store_buffer_.EnterDirectlyIntoStoreBuffer(
-              reinterpret_cast<Address>(slot));
+          RememberedSet<OLD_TO_NEW>::Insert(
+              MemoryChunk::FromAddress(object->address()), slot_address);
         }
         SLOW_DCHECK(!MarkCompactCollector::IsOnEvacuationCandidate(new_target));
       } else if (record_slots &&
@@ -5020,6 +5296,8 @@ bool Heap::SetUp() {
   // Initialize incremental marking.
   incremental_marking_ = new IncrementalMarking(this);
 
+  concurrent_marking_ = new ConcurrentMarking(this);
+
   // Set up new space.
   if (!new_space_.SetUp(reserved_semispace_size_, max_semi_space_size_)) {
     return false;
@@ -5079,6 +5357,8 @@ bool Heap::SetUp() {
 
   object_stats_ = new ObjectStats(this);
   object_stats_->ClearObjectStats(true);
+  object_stats_sample_ = new ObjectStats(this);
+  object_stats_sample_->ClearObjectStats(true);
 
   scavenge_job_ = new ScavengeJob();
 
@@ -5190,6 +5470,9 @@ void Heap::TearDown() {
     PrintAlloctionsHash();
   }
 
+  delete concurrent_marking_;
+  concurrent_marking_ = nullptr;
+
   delete scavenge_collector_;
   scavenge_collector_ = nullptr;
 
@@ -5214,6 +5497,9 @@ void Heap::TearDown() {
   delete object_stats_;
   object_stats_ = nullptr;
 
+  delete object_stats_sample_;
+  object_stats_sample_ = nullptr;
+
   delete scavenge_job_;
   scavenge_job_ = nullptr;
 
@@ -5932,7 +6218,26 @@ void Heap::ExternalStringTable::CleanUp() {
 }
 
 
+bool Heap::ExternalStringTable::DisposeQueued(double deadline_in_ms) {
+  // Only check the time every few resources.
+  const int kResourcesPerDeadlineCheck = 32;
+  while (!disposal_queue_.is_empty()) {
+    for (int i = 0; i < kResourcesPerDeadlineCheck; i++) {
+      if (disposal_queue_.is_empty()) break;
+      disposal_queue_.RemoveLast()->Dispose();
+    }
+    if (heap_->MonotonicallyIncreasingTimeInMs() >= deadline_in_ms) break;
+  }
+  if (disposal_queue_.is_empty()) {
+    disposal_queue_.Free();
+    return true;
+  }
+  return false;
+}
+
+
 void Heap::ExternalStringTable::TearDown() {
+  DisposeQueued(std::numeric_limits<double>::infinity());
   for (int i = 0; i < new_space_strings_.length(); ++i) {
     heap_->FinalizeExternalString(ExternalString::cast(new_space_strings_[i]));
   }
@@ -5946,24 +6251,65 @@ void Heap::ExternalStringTable::TearDown() {
 
 class Heap::UnmapFreeMemoryTask : public v8::Task {
  public:
-  UnmapFreeMemoryTask(Heap* heap, MemoryChunk* head)
-      : heap_(heap), head_(head) {}
+  UnmapFreeMemoryTask(Heap* heap, MemoryChunk* head,
+                      double large_page_pool_decay_in_ms)
+      : heap_(heap),
+        head_(head),
+        large_page_pool_decay_in_ms_(large_page_pool_decay_in_ms) {}
   virtual ~UnmapFreeMemoryTask() {}
 
  private:
   // v8::Task overrides.
   void Run() override {
     heap_->FreeQueuedChunks(head_);
+    heap_->isolate()->memory_allocator()->ReleaseDecayedLargePages(
+        large_page_pool_decay_in_ms_);
     heap_->pending_unmapping_tasks_semaphore_.Signal();
   }
 
   Heap* heap_;
   MemoryChunk* head_;
+  double large_page_pool_decay_in_ms_;
 
   DISALLOW_COPY_AND_ASSIGN(UnmapFreeMemoryTask);
 };
 
 
+class Heap::LargePagePoolDecayTask : public CancelableTask {
+ public:
+  explicit LargePagePoolDecayTask(Heap* heap)
+      : CancelableTask(heap->isolate()), heap_(heap) {}
+
+  virtual ~LargePagePoolDecayTask() {}
+
+ private:
+  // v8::internal::CancelableTask overrides.
+  void RunInternal() override {
+    heap_->large_page_pool_decay_task_pending_ = false;
+    MemoryAllocator* allocator = heap_->isolate()->memory_allocator();
+    allocator->ReleaseDecayedLargePages(FLAG_large_page_pool_decay);
+    if (allocator->LargePagePoolSize() > 0) {
+      heap_->ScheduleLargePagePoolDecay();
+    }
+  }
+
+  Heap* heap_;
+  DISALLOW_COPY_AND_ASSIGN(LargePagePoolDecayTask);
+};
+
+
+void Heap::ScheduleLargePagePoolDecay() {
+  if (!FLAG_large_page_pool || large_page_pool_decay_task_pending_) return;
+  large_page_pool_decay_task_pending_ = true;
+  // Leave some room for precision error in task scheduler.
+  const double kSlackMs = 100;
+  V8::GetCurrentPlatform()->CallDelayedOnForegroundThread(
+      reinterpret_cast<v8::Isolate*>(isolate()),
+      new LargePagePoolDecayTask(this),
+      (FLAG_large_page_pool_decay + kSlackMs) / 1000.0);
+}
+
+
 void Heap::WaitUntilUnmappingOfFreeChunksCompleted() {
   while (concurrent_unmapping_tasks_active_ > 0) {
     pending_unmapping_tasks_semaphore_.Wait();
@@ -5991,17 +6337,27 @@ void Heap::FilterStoreBufferEntriesOnAboutToBeFreedPages() {
     next = chunk->next_chunk();
     chunk->SetFlag(MemoryChunk::ABOUT_TO_BE_FREED);
   }
-  store_buffer()->Compact();
-  store_buffer()->Filter(MemoryChunk::ABOUT_TO_BE_FREED);
+  // Slot sets are owned by their chunks and go away with them. Only entries
+  // still sitting in the store buffer have to be flushed before the chunks
+  // are unmapped.
+  store_buffer()->MoveEntriesToRememberedSet();
 }
 
 
 void Heap::FreeQueuedChunks() {
-  if (chunks_queued_for_free_ != NULL) {
+  if (chunks_queued_for_free_ != NULL ||
+      isolate_->memory_allocator()->LargePagePoolSize() > 0) {
+    // Pooled large pages are dropped right away when reducing memory.
+    double large_page_pool_decay_in_ms =
+        ShouldReduceMemory() ? 0 : FLAG_large_page_pool_decay;
     V8::GetCurrentPlatform()->CallOnBackgroundThread(
-        new UnmapFreeMemoryTask(this, chunks_queued_for_free_),
+        new UnmapFreeMemoryTask(this, chunks_queued_for_free_,
+                                large_page_pool_decay_in_ms),
         v8::Platform::kShortRunningTask);
     chunks_queued_for_free_ = NULL;
+    // The freed large pages enter the pool on the background thread. They
+    // decay on a timer in case no further garbage collection happens.
+    ScheduleLargePagePoolDecay();
   } else {
     // If we do not have anything to unmap, we just signal the semaphore
     // that we are done.
@@ -6072,13 +6428,65 @@ size_t Heap::NumberOfTrackedHeapObjectTypes() {
 
 size_t Heap::ObjectCountAtLastGC(size_t index) {
   if (index >= ObjectStats::OBJECT_STATS_COUNT) return 0;
-  return object_stats_->object_count_last_gc(index);
+  ObjectStats* stats =
+      FLAG_track_gc_object_stats ? object_stats_ : object_stats_sample_;
+  return stats->object_count_last_gc(index);
 }
 
 
 size_t Heap::ObjectSizeAtLastGC(size_t index) {
   if (index >= ObjectStats::OBJECT_STATS_COUNT) return 0;
-  return object_stats_->object_size_last_gc(index);
+  ObjectStats* stats =
+      FLAG_track_gc_object_stats ? object_stats_ : object_stats_sample_;
+  return stats->object_size_last_gc(index);
+}
+
+
+class Heap::ObjectStatsCallbackTask : public CancelableTask {
+ public:
+  ObjectStatsCallbackTask(Heap* heap,
+                          v8::Isolate::HeapObjectStatisticsCallback callback)
+      : CancelableTask(heap->isolate()), heap_(heap), callback_(callback) {}
+
+  virtual ~ObjectStatsCallbackTask() {}
+
+ private:
+  // v8::internal::CancelableTask overrides.
+  void RunInternal() override {
+    // Sampling may have been disabled or redirected in the meantime.
+    if (!heap_->object_stats_sampling_ ||
+        heap_->object_stats_callback_ != callback_) {
+      return;
+    }
+    callback_(reinterpret_cast<v8::Isolate*>(heap_->isolate()));
+  }
+
+  Heap* heap_;
+  v8::Isolate::HeapObjectStatisticsCallback callback_;
+  DISALLOW_COPY_AND_ASSIGN(ObjectStatsCallbackTask);
+};
+
+
+void Heap::SetObjectStatsSampling(
+    bool enabled, v8::Isolate::HeapObjectStatisticsCallback callback) {
+  object_stats_sampling_ = enabled;
+  object_stats_callback_ = enabled ? callback : nullptr;
+  if (!enabled) object_stats_sample_->ClearObjectStats(true);
+}
+
+
+void Heap::ObjectStatsSampleComplete() {
+  // Large objects are not swept page by page, so they are accounted for here.
+  LargeObjectIterator it(lo_space());
+  for (HeapObject* obj = it.Next(); obj != nullptr; obj = it.Next()) {
+    object_stats_sample_->RecordObject(obj, obj->map(), obj->Size());
+  }
+  object_stats_sample_->CheckpointSample();
+  if (object_stats_callback_ != nullptr) {
+    V8::GetCurrentPlatform()->CallOnForegroundThread(
+        reinterpret_cast<v8::Isolate*>(isolate()),
+        new ObjectStatsCallbackTask(this, object_stats_callback_));
+  }
 }
 
 
@@ -444,6 +444,7 @@ class HistogramTimer;
 class Isolate;
 class MemoryReducer;
 class ObjectStats;
+class ConcurrentMarking;
 class Scavenger;
 class ScavengeJob;
 class WeakObjectRetainer;
@@ -835,6 +836,9 @@ class Heap {
   // Maintain consistency of live bytes during incremental marking.
   void AdjustLiveBytes(HeapObject* object, int by, InvocationMode mode);
 
+  // Removes the recorded slots in [start, end) of the given object's chunk.
+  void ClearRecordedSlotRange(HeapObject* object, Address start, Address end);
+
   // Trim the given array from the left. Note that this relocates the object
   // start and hence is only valid if there is only a single reference to it.
   FixedArrayBase* LeftTrimFixedArray(FixedArrayBase* obj, int elements_to_trim);
@@ -852,20 +856,6 @@ class Heap {
   // Notify the heap that a context has been disposed.
   int NotifyContextDisposed(bool dependant_context);
 
-  inline void increment_scan_on_scavenge_pages() {
-    scan_on_scavenge_pages_++;
-    if (FLAG_gc_verbose) {
-      PrintF("Scan-on-scavenge pages: %d\n", scan_on_scavenge_pages_);
-    }
-  }
-
-  inline void decrement_scan_on_scavenge_pages() {
-    scan_on_scavenge_pages_--;
-    if (FLAG_gc_verbose) {
-      PrintF("Scan-on-scavenge pages: %d\n", scan_on_scavenge_pages_);
-    }
-  }
-
   void set_native_contexts_list(Object* object) {
     native_contexts_list_ = object;
   }
@@ -1002,6 +992,10 @@ class Heap {
 
   void DeoptMarkedAllocationSites();
 
+  // Deopts all code that contains allocation instruction which are tenured or
+  // not tenured. Moreover it clears the pretenuring allocation site statistics.
+  void ResetAllAllocationSitesDependentCode(PretenureFlag flag);
+
   bool DeoptMaybeTenuredAllocationSites() {
     return new_space_.IsAtMaximumCapacity() && maximum_size_scavenges_ == 0;
   }
@@ -1029,7 +1023,40 @@ class Heap {
   bool HasHighFragmentation();
   bool HasHighFragmentation(intptr_t used, intptr_t committed);
 
-  bool ShouldOptimizeForMemoryUsage() { return optimize_for_memory_usage_; }
+  bool ShouldOptimizeForMemoryUsage() {
+    return optimize_for_memory_usage_ || HighMemoryPressure();
+  }
+
+  bool HighMemoryPressure() {
+    return memory_pressure_level_.Value() != MemoryPressureLevel::kNone;
+  }
+
+  // Records the memory pressure level reported by the embedder. Escalations
+  // trigger a garbage collection right away if |is_isolate_locked|, otherwise
+  // on the isolate's thread via an interrupt or a foreground task.
+  void MemoryPressureNotification(MemoryPressureLevel level,
+                                  bool is_isolate_locked);
+
+  // Performs the garbage collection requested by the last escalation of the
+  // memory pressure level, if it has not been performed yet.
+  void CheckMemoryPressure();
+
+  // In pause budget mode the heap sizes its work such that the predicted
+  // garbage collection pauses stay below the budget.
+  void SetPauseBudget(double budget_in_ms,
+                      v8::Isolate::GCPauseBudgetViolationCallback callback);
+  bool HasPauseBudget() { return pause_budget_in_ms_ > 0; }
+  double pause_budget_in_ms() { return pause_budget_in_ms_; }
+
+  // A scavenge pause target hands the sizing of the new space to the
+  // semi-space sizing controller, see ControlNewSpaceSize.
+  void SetScavengePauseTarget(double target_in_ms) {
+    scavenge_pause_target_in_ms_ = target_in_ms;
+  }
+  bool UsesSemiSpaceSizingController() {
+    return !FLAG_predictable && (FLAG_semi_space_sizing_controller ||
+                                 scavenge_pause_target_in_ms_ > 0);
+  }
 
   // ===========================================================================
   // Initialization. ===========================================================
@@ -1229,6 +1256,10 @@ class Heap {
   // Last hope GC, should try to squeeze as much as possible.
   void CollectAllAvailableGarbage(const char* gc_reason = NULL);
 
+  // Aggressive GC that compacts the heap and releases as many pages as
+  // possible under critical memory pressure.
+  void CollectGarbageOnMemoryPressure(const char* gc_reason);
+
   // Reports and external memory pressure event, either performs a major GC or
   // completes incremental marking in order to free external resources.
   void ReportExternalMemoryPressure(const char* gc_reason = NULL);
@@ -1291,6 +1322,8 @@ class Heap {
 
   IncrementalMarking* incremental_marking() { return incremental_marking_; }
 
+  ConcurrentMarking* concurrent_marking() { return concurrent_marking_; }
+
   // ===========================================================================
   // External string table API. ================================================
   // ===========================================================================
@@ -1299,9 +1332,15 @@ class Heap {
   inline void RegisterExternalString(String* string);
 
   // Finalizes an external string by deleting the associated external
-  // data and clearing the resource pointer.
+  // data and clearing the resource pointer. With
+  // --incremental-external-string-finalization the data of strings that die
+  // in a garbage collection is deleted by a task after the pause.
   inline void FinalizeExternalString(String* string);
 
+  // Deletes the external data of all strings whose finalization has been
+  // deferred.
+  void DisposeQueuedExternalStrings();
+
   // ===========================================================================
   // Methods checking/returning the space of a given object/address. ===========
   // ===========================================================================
@@ -1346,6 +1385,18 @@ class Heap {
   bool GetObjectTypeName(size_t index, const char** object_type,
                          const char** object_sub_type);
 
+  // Enables sampling of object statistics by the sweeper. Without
+  // --track-gc-object-stats, the statistics at the last GC are then taken
+  // from the most recent sample.
+  void SetObjectStatsSampling(
+      bool enabled, v8::Isolate::HeapObjectStatisticsCallback callback);
+  bool object_stats_sampling() { return object_stats_sampling_; }
+  ObjectStats* object_stats_sample() { return object_stats_sample_; }
+
+  // Called on the main thread once sweeping has finished and all sampled
+  // object statistics have been merged.
+  void ObjectStatsSampleComplete();
+
   // ===========================================================================
   // GC statistics. ============================================================
   // ===========================================================================
@@ -1551,6 +1602,10 @@ class Heap {
 #endif
 
  private:
+  class ExternalStringDisposalTask;
+  class LargePagePoolDecayTask;
+  class MemoryPressureInterruptTask;
+  class ObjectStatsCallbackTask;
   class UnmapFreeMemoryTask;
 
   // External strings table is a place where all external strings are
@@ -1570,6 +1625,16 @@ class Heap {
     // Destroys all allocated memory.
     void TearDown();
 
+    // Defers the disposal of the resource of a dead external string.
+    inline void QueueForDisposal(
+        v8::String::ExternalStringResourceBase* resource);
+
+    // Disposes queued resources until the deadline is reached. Returns true
+    // if no resources are left in the queue.
+    bool DisposeQueued(double deadline_in_ms);
+
+    bool HasQueuedForDisposal() { return !disposal_queue_.is_empty(); }
+
    private:
     explicit ExternalStringTable(Heap* heap) : heap_(heap) {}
 
@@ -1585,6 +1650,10 @@ class Heap {
     List<Object*> new_space_strings_;
     List<Object*> old_space_strings_;
 
+    // Resources of strings that died in a garbage collection, most recent
+    // ones last.
+    List<v8::String::ExternalStringResourceBase*> disposal_queue_;
+
     Heap* heap_;
 
     friend class Heap;
@@ -1640,7 +1709,6 @@ class Heap {
 
   static const int kYoungSurvivalRateHighThreshold = 90;
   static const int kYoungSurvivalRateAllowedDeviation = 15;
-  static const int kOldSurvivalRateLowThreshold = 10;
 
   static const int kMaxMarkCompactsInIdleRound = 7;
   static const int kIdleScavengeThreshold = 5;
@@ -1652,9 +1720,6 @@ class Heap {
   static String* UpdateNewSpaceReferenceInExternalStringTableEntry(
       Heap* heap, Object** pointer);
 
-  static void ScavengeStoreBufferCallback(Heap* heap, MemoryChunk* page,
-                                          StoreBufferEvent event);
-
   // Selects the proper allocation space based on the pretenuring decision.
   static AllocationSpace SelectSpace(PretenureFlag pretenure) {
     return (pretenure == TENURED) ? OLD_SPACE : NEW_SPACE;
@@ -1750,13 +1815,9 @@ class Heap {
   // Fill in bogus values in from space
   void ZapFromSpace();
 
-  // Deopts all code that contains allocation instruction which are tenured or
-  // not tenured. Moreover it clears the pretenuring allocation site statistics.
-  void ResetAllAllocationSitesDependentCode(PretenureFlag flag);
-
   // Evaluates local pretenuring for the old space and calls
   // ResetAllTenuredAllocationSitesDependentCode if too many objects died in
-  // the old space.
+  // the old space or the periodic re-evaluation of tenured sites is due.
   void EvaluateOldSpaceLocalPretenuring(uint64_t size_of_objects_before_gc);
 
   // Record statistics before and after garbage collection.
@@ -1837,6 +1898,19 @@ class Heap {
   void GarbageCollectionPrologue();
   void GarbageCollectionEpilogue();
 
+  // Reports the pause of the last garbage collection if it exceeded the pause
+  // budget.
+  void CheckPauseBudget(GarbageCollector collector);
+
+  // Returns false if growing the new space would make scavenges exceed the
+  // pause budget.
+  bool NewSpaceGrowthFitsPauseBudget();
+
+  // Resizes the new space to the capacity that keeps the time spent in
+  // scavenges per unit of mutator time low without exceeding the scavenge
+  // pause target.
+  void ControlNewSpaceSize();
+
   // Performs a major collection in the whole heap.
   void MarkCompact();
 
@@ -1855,6 +1929,14 @@ class Heap {
   void UpdateReferencesInExternalStringTable(
       ExternalStringTableUpdaterCallback updater_func);
 
+  // Posts a task that disposes the resources of external strings queued
+  // during the last garbage collection.
+  void ScheduleExternalStringDisposal();
+
+  // Posts a delayed task that unmaps pooled large pages once they have
+  // decayed, so that the pool shrinks without further garbage collections.
+  void ScheduleLargePagePoolDecay();
+
   void ProcessAllWeakReferences(WeakObjectRetainer* retainer);
   void ProcessYoungWeakReferences(WeakObjectRetainer* retainer);
   void ProcessNativeContexts(WeakObjectRetainer* retainer);
@@ -2158,8 +2240,6 @@ class Heap {
 
   int global_ic_age_;
 
-  int scan_on_scavenge_pages_;
-
   NewSpace new_space_;
   OldSpace* old_space_;
   OldSpace* code_space_;
@@ -2212,6 +2292,21 @@ class Heap {
   // TODO(ulan): Merge it with memory reducer once chromium:490559 is fixed.
   bool optimize_for_memory_usage_;
 
+  // Maximum pause in pause budget mode, 0 if the mode is off.
+  double pause_budget_in_ms_;
+  v8::Isolate::GCPauseBudgetViolationCallback pause_budget_violation_callback_;
+
+  // Target scavenge pause of the semi-space sizing controller, 0 if none.
+  double scavenge_pause_target_in_ms_;
+
+  // Last memory pressure level reported by the embedder. Written from
+  // arbitrary threads.
+  AtomicValue<MemoryPressureLevel> memory_pressure_level_;
+
+  // Set when an escalation of the memory pressure level still has to be
+  // handled on the isolate's thread.
+  AtomicValue<bool> memory_pressure_check_pending_;
+
   // Indicates that inline bump-pointer allocation has been globally disabled
   // for all spaces. This is used to disable allocations in generated code.
   bool inline_allocation_disabled_;
@@ -2228,8 +2323,6 @@ class Heap {
 
   Object* encountered_weak_cells_;
 
-  StoreBufferRebuilder store_buffer_rebuilder_;
-
   List<GCCallbackPair> gc_epilogue_callbacks_;
   List<GCCallbackPair> gc_prologue_callbacks_;
 
@@ -2289,12 +2382,19 @@ class Heap {
 
   IncrementalMarking* incremental_marking_;
 
+  ConcurrentMarking* concurrent_marking_;
+
   GCIdleTimeHandler* gc_idle_time_handler_;
 
   MemoryReducer* memory_reducer_;
 
   ObjectStats* object_stats_;
 
+  // Object statistics gathered during sweeping, see SetObjectStatsSampling.
+  ObjectStats* object_stats_sample_;
+  bool object_stats_sampling_;
+  v8::Isolate::HeapObjectStatisticsCallback object_stats_callback_;
+
   ScavengeJob* scavenge_job_;
 
   // These two counters are monotomically increasing and never reset.
@@ -2344,8 +2444,12 @@ class Heap {
 
   ExternalStringTable external_string_table_;
 
+  bool external_string_disposal_task_pending_;
+
   MemoryChunk* chunks_queued_for_free_;
 
+  bool large_page_pool_decay_task_pending_;
+
   size_t concurrent_unmapping_tasks_active_;
 
   base::Semaphore pending_unmapping_tasks_semaphore_;
@@ -2369,6 +2473,7 @@ class Heap {
   friend class HeapIterator;
   friend class IncrementalMarking;
   friend class MarkCompactCollector;
+  template <MarkBit::AccessMode>
   friend class MarkCompactMarkingVisitor;
   friend class NewSpace;
   friend class ObjectStatsVisitor;
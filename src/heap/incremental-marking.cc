@@ -7,6 +7,7 @@
 #include "src/code-stubs.h"
 #include "src/compilation-cache.h"
 #include "src/conversions.h"
+#include "src/heap/concurrent-marking.h"
 #include "src/heap/gc-idle-time-handler.h"
 #include "src/heap/gc-tracer.h"
 #include "src/heap/mark-compact-inl.h"
@@ -51,6 +52,17 @@ bool IncrementalMarking::BaseRecordWrite(HeapObject* obj, Object** slot,
                                          Object* value) {
   HeapObject* value_heap_obj = HeapObject::cast(value);
   MarkBit value_bit = Marking::MarkBitFrom(value_heap_obj);
+  if (FLAG_concurrent_marking) {
+    // The concurrent marker may be scanning the host right now, so its color
+    // does not tell whether the new value will be seen. Mark the value
+    // instead and record the slot unconditionally; slots in dead objects are
+    // filtered before evacuation.
+    if (Marking::IsWhite(value_bit)) {
+      WhiteToGreyAndPush<MarkBit::ATOMIC>(value_heap_obj, value_bit);
+      RestartIfNotMarking();
+    }
+    return is_compacting_;
+  }
   if (Marking::IsWhite(value_bit)) {
     MarkBit obj_bit = Marking::MarkBitFrom(obj);
     if (Marking::IsBlack(obj_bit)) {
@@ -81,7 +93,7 @@ void IncrementalMarking::RecordWriteSlow(HeapObject* obj, Object** slot,
                                          Object* value) {
   if (BaseRecordWrite(obj, slot, value) && slot != NULL) {
     MarkBit obj_bit = Marking::MarkBitFrom(obj);
-    if (Marking::IsBlack(obj_bit)) {
+    if (FLAG_concurrent_marking || Marking::IsBlack(obj_bit)) {
       // Object is not going to be rescanned we need to record the slot.
       heap_->mark_compact_collector()->RecordSlot(obj, slot, value);
     }
@@ -96,7 +108,12 @@ void IncrementalMarking::RecordWriteFromCode(HeapObject* obj, Object** slot,
 
   MemoryChunk* chunk = MemoryChunk::FromAddress(obj->address());
   int counter = chunk->write_barrier_counter();
-  if (counter < (MemoryChunk::kWriteBarrierCounterGranularity / 2)) {
+  if (FLAG_concurrent_marking) {
+    // Keep the counter exhausted so that generated code always calls into
+    // the runtime instead of updating mark bits non-atomically.
+    marking->write_barriers_invoked_since_last_step_++;
+    chunk->set_write_barrier_counter(0);
+  } else if (counter < (MemoryChunk::kWriteBarrierCounterGranularity / 2)) {
     marking->write_barriers_invoked_since_last_step_ +=
         MemoryChunk::kWriteBarrierCounterGranularity -
         chunk->write_barrier_counter();
@@ -146,7 +163,11 @@ void IncrementalMarking::RecordWriteIntoCodeSlow(HeapObject* obj,
   if (Marking::IsWhite(value_bit)) {
     MarkBit obj_bit = Marking::MarkBitFrom(obj);
     if (Marking::IsBlack(obj_bit)) {
-      BlackToGreyAndUnshift(obj, obj_bit);
+      if (FLAG_concurrent_marking) {
+        BlackToGreyAndUnshift<MarkBit::ATOMIC>(obj, obj_bit);
+      } else {
+        BlackToGreyAndUnshift(obj, obj_bit);
+      }
       RestartIfNotMarking();
     }
     // Object is either grey or white.  It will be scanned if survives.
@@ -166,25 +187,33 @@ void IncrementalMarking::RecordWriteIntoCodeSlow(HeapObject* obj,
 
 void IncrementalMarking::RecordWrites(HeapObject* obj) {
   if (IsMarking()) {
+    // Make the preceding writes visible before the color is checked. A grey
+    // object is then scanned by the concurrent marker after the writes.
+    if (FLAG_concurrent_marking) base::MemoryBarrier();
     MarkBit obj_bit = Marking::MarkBitFrom(obj);
     if (Marking::IsBlack(obj_bit)) {
       MemoryChunk* chunk = MemoryChunk::FromAddress(obj->address());
       if (chunk->IsFlagSet(MemoryChunk::HAS_PROGRESS_BAR)) {
         chunk->set_progress_bar(0);
       }
-      BlackToGreyAndUnshift(obj, obj_bit);
+      if (FLAG_concurrent_marking) {
+        BlackToGreyAndUnshift<MarkBit::ATOMIC>(obj, obj_bit);
+      } else {
+        BlackToGreyAndUnshift(obj, obj_bit);
+      }
       RestartIfNotMarking();
     }
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 void IncrementalMarking::BlackToGreyAndUnshift(HeapObject* obj,
                                                MarkBit mark_bit) {
   DCHECK(Marking::MarkBitFrom(obj) == mark_bit);
   DCHECK(obj->Size() >= 2 * kPointerSize);
   DCHECK(IsMarking());
-  Marking::BlackToGrey(mark_bit);
+  Marking::BlackToGrey<mode>(mark_bit);
   int obj_size = obj->Size();
   MemoryChunk::IncrementLiveBytesFromGC(obj, -obj_size);
   bytes_scanned_ -= obj_size;
@@ -210,12 +239,25 @@ void IncrementalMarking::BlackToGreyAndUnshift(HeapObject* obj,
 }
 
 
+template <MarkBit::AccessMode mode>
 void IncrementalMarking::WhiteToGreyAndPush(HeapObject* obj, MarkBit mark_bit) {
-  Marking::WhiteToGrey(mark_bit);
+  if (mode == MarkBit::ATOMIC) {
+    // The concurrent marker may have claimed the object since the caller
+    // checked its color.
+    if (!Marking::WhiteToGreyAtomic(mark_bit)) return;
+  } else {
+    Marking::WhiteToGrey(mark_bit);
+  }
   heap_->mark_compact_collector()->marking_deque()->Push(obj);
 }
 
 
+// Used by Marking::TransferMark.
+template void IncrementalMarking::WhiteToGreyAndPush<MarkBit::NON_ATOMIC>(
+    HeapObject* obj, MarkBit mark_bit);
+
+
+template <MarkBit::AccessMode mode>
 static void MarkObjectGreyDoNotEnqueue(Object* obj) {
   if (obj->IsHeapObject()) {
     HeapObject* heap_obj = HeapObject::cast(obj);
@@ -223,28 +265,37 @@ static void MarkObjectGreyDoNotEnqueue(Object* obj) {
     if (Marking::IsBlack(mark_bit)) {
       MemoryChunk::IncrementLiveBytesFromGC(heap_obj, -heap_obj->Size());
     }
-    Marking::AnyToGrey(mark_bit);
+    Marking::AnyToGrey<mode>(mark_bit);
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 static inline void MarkBlackOrKeepBlack(HeapObject* heap_object,
                                         MarkBit mark_bit, int size) {
   DCHECK(!Marking::IsImpossible(mark_bit));
   if (Marking::IsBlack(mark_bit)) return;
-  Marking::MarkBlack(mark_bit);
+  Marking::MarkBlack<mode>(mark_bit);
   MemoryChunk::IncrementLiveBytesFromGC(heap_object, size);
 }
 
 
+// The mark bit access mode is ATOMIC for the instance that runs next to the
+// concurrent marking task.
+template <MarkBit::AccessMode mode>
 class IncrementalMarkingMarkingVisitor
-    : public StaticMarkingVisitor<IncrementalMarkingMarkingVisitor> {
+    : public StaticMarkingVisitor<IncrementalMarkingMarkingVisitor<mode> > {
  public:
+  typedef StaticMarkingVisitor<IncrementalMarkingMarkingVisitor<mode> > Base;
+
   static void Initialize() {
-    StaticMarkingVisitor<IncrementalMarkingMarkingVisitor>::Initialize();
-    table_.Register(kVisitFixedArray, &VisitFixedArrayIncremental);
-    table_.Register(kVisitNativeContext, &VisitNativeContextIncremental);
-    table_.Register(kVisitJSRegExp, &VisitJSRegExp);
+    Base::Initialize();
+    Base::table_.Register(StaticVisitorBase::kVisitFixedArray,
+                          &VisitFixedArrayIncremental);
+    Base::table_.Register(StaticVisitorBase::kVisitNativeContext,
+                          &VisitNativeContextIncremental);
+    Base::table_.Register(StaticVisitorBase::kVisitJSRegExp,
+                          &Base::VisitJSRegExp);
   }
 
   static const int kProgressBarScanningChunk = 32 * 1024;
@@ -284,13 +335,13 @@ class IncrementalMarkingMarkingVisitor
           heap->mark_compact_collector()->marking_deque()->Unshift(object);
         } else {
           DCHECK(Marking::IsBlack(Marking::MarkBitFrom(object)));
-          heap->mark_compact_collector()->UnshiftBlack(object);
+          heap->mark_compact_collector()->UnshiftBlack<mode>(object);
         }
         heap->incremental_marking()->NotifyIncompleteScanOfObject(
             object_size - (start_offset - already_scanned_offset));
       }
     } else {
-      FixedArrayVisitor::Visit(map, object);
+      Base::FixedArrayVisitor::Visit(map, object);
     }
   }
 
@@ -302,9 +353,9 @@ class IncrementalMarkingMarkingVisitor
     // so the cache can be undefined.
     Object* cache = context->get(Context::NORMALIZED_MAP_CACHE_INDEX);
     if (!cache->IsUndefined()) {
-      MarkObjectGreyDoNotEnqueue(cache);
+      MarkObjectGreyDoNotEnqueue<mode>(cache);
     }
-    VisitNativeContext(map, context);
+    Base::VisitNativeContext(map, context);
   }
 
   INLINE(static void VisitPointer(Heap* heap, HeapObject* object, Object** p)) {
@@ -328,7 +379,7 @@ class IncrementalMarkingMarkingVisitor
 
   // Marks the object grey and pushes it on the marking stack.
   INLINE(static void MarkObject(Heap* heap, Object* obj)) {
-    IncrementalMarking::MarkObject(heap, HeapObject::cast(obj));
+    IncrementalMarking::MarkObject<mode>(heap, HeapObject::cast(obj));
   }
 
   // Marks the object black without pushing it on the marking stack.
@@ -337,7 +388,7 @@ class IncrementalMarkingMarkingVisitor
     HeapObject* heap_object = HeapObject::cast(obj);
     MarkBit mark_bit = Marking::MarkBitFrom(heap_object);
     if (Marking::IsWhite(mark_bit)) {
-      Marking::MarkBlack(mark_bit);
+      Marking::MarkBlack<mode>(mark_bit);
       MemoryChunk::IncrementLiveBytesFromGC(heap_object, heap_object->Size());
       return true;
     }
@@ -346,6 +397,7 @@ class IncrementalMarkingMarkingVisitor
 };
 
 
+template <MarkBit::AccessMode mode>
 class IncrementalMarkingRootMarkingVisitor : public ObjectVisitor {
  public:
   explicit IncrementalMarkingRootMarkingVisitor(
@@ -363,7 +415,7 @@ class IncrementalMarkingRootMarkingVisitor : public ObjectVisitor {
     Object* obj = *p;
     if (!obj->IsHeapObject()) return;
 
-    IncrementalMarking::MarkObject(heap_, HeapObject::cast(obj));
+    IncrementalMarking::MarkObject<mode>(heap_, HeapObject::cast(obj));
   }
 
   Heap* heap_;
@@ -371,7 +423,8 @@ class IncrementalMarkingRootMarkingVisitor : public ObjectVisitor {
 
 
 void IncrementalMarking::Initialize() {
-  IncrementalMarkingMarkingVisitor::Initialize();
+  IncrementalMarkingMarkingVisitor<MarkBit::NON_ATOMIC>::Initialize();
+  IncrementalMarkingMarkingVisitor<MarkBit::ATOMIC>::Initialize();
 }
 
 
@@ -381,6 +434,7 @@ void IncrementalMarking::SetOldSpacePageFlags(MemoryChunk* chunk,
   if (is_marking) {
     chunk->SetFlag(MemoryChunk::POINTERS_TO_HERE_ARE_INTERESTING);
     chunk->SetFlag(MemoryChunk::POINTERS_FROM_HERE_ARE_INTERESTING);
+    if (FLAG_concurrent_marking) chunk->set_write_barrier_counter(0);
   } else {
     chunk->ClearFlag(MemoryChunk::POINTERS_TO_HERE_ARE_INTERESTING);
     chunk->SetFlag(MemoryChunk::POINTERS_FROM_HERE_ARE_INTERESTING);
@@ -393,6 +447,7 @@ void IncrementalMarking::SetNewSpacePageFlags(MemoryChunk* chunk,
   chunk->SetFlag(MemoryChunk::POINTERS_TO_HERE_ARE_INTERESTING);
   if (is_marking) {
     chunk->SetFlag(MemoryChunk::POINTERS_FROM_HERE_ARE_INTERESTING);
+    if (FLAG_concurrent_marking) chunk->set_write_barrier_counter(0);
   } else {
     chunk->ClearFlag(MemoryChunk::POINTERS_FROM_HERE_ARE_INTERESTING);
   }
@@ -609,11 +664,12 @@ void IncrementalMarking::StartMarking() {
   if (FLAG_cleanup_code_caches_at_gc) {
     // We will mark cache black with a separate pass
     // when we finish marking.
-    MarkObjectGreyDoNotEnqueue(heap_->polymorphic_code_cache());
+    MarkObjectGreyDoNotEnqueue<MarkBit::NON_ATOMIC>(
+        heap_->polymorphic_code_cache());
   }
 
-  // Mark strong roots grey.
-  IncrementalMarkingRootMarkingVisitor visitor(this);
+  // Mark strong roots grey. No concurrent marking task is running yet.
+  IncrementalMarkingRootMarkingVisitor<MarkBit::NON_ATOMIC> visitor(this);
   heap_->IterateStrongRoots(&visitor, VISIT_ONLY_STRONG);
 
   // Ready to start incremental marking.
@@ -623,6 +679,18 @@ void IncrementalMarking::StartMarking() {
 }
 
 
+template <MarkBit::AccessMode mode>
+static void MarkObjectGroupsGrey(IncrementalMarking* marking) {
+  Heap* heap = marking->heap();
+  heap->mark_compact_collector()->MarkImplicitRefGroups(
+      &IncrementalMarking::MarkObject<mode>);
+
+  IncrementalMarkingRootMarkingVisitor<mode> visitor(marking);
+  heap->isolate()->global_handles()->IterateObjectGroups(
+      &visitor, &MarkCompactCollector::IsUnmarkedHeapObjectWithHeap);
+}
+
+
 void IncrementalMarking::MarkObjectGroups() {
   DCHECK(FLAG_overapproximate_weak_closure);
   DCHECK(!weak_closure_was_overapproximated_);
@@ -631,11 +699,12 @@ void IncrementalMarking::MarkObjectGroups() {
   int old_marking_deque_top =
       heap_->mark_compact_collector()->marking_deque()->top();
 
-  heap_->mark_compact_collector()->MarkImplicitRefGroups(&MarkObject);
-
-  IncrementalMarkingRootMarkingVisitor visitor(this);
-  heap_->isolate()->global_handles()->IterateObjectGroups(
-      &visitor, &MarkCompactCollector::IsUnmarkedHeapObjectWithHeap);
+  // The concurrent marking task may be running.
+  if (FLAG_concurrent_marking) {
+    MarkObjectGroupsGrey<MarkBit::ATOMIC>(this);
+  } else {
+    MarkObjectGroupsGrey<MarkBit::NON_ATOMIC>(this);
+  }
 
   int marking_progress =
       abs(old_marking_deque_top -
@@ -656,6 +725,11 @@ void IncrementalMarking::MarkObjectGroups() {
 void IncrementalMarking::UpdateMarkingDequeAfterScavenge() {
   if (!IsMarking()) return;
 
+  // Pages that were flipped into to-space carry stale write barrier counters.
+  if (FLAG_concurrent_marking) {
+    ActivateIncrementalWriteBarrier(heap_->new_space());
+  }
+
   MarkingDeque* marking_deque =
       heap_->mark_compact_collector()->marking_deque();
   int current = marking_deque->bottom();
@@ -703,10 +777,11 @@ void IncrementalMarking::UpdateMarkingDequeAfterScavenge() {
 }
 
 
+template <MarkBit::AccessMode mode>
 void IncrementalMarking::VisitObject(Map* map, HeapObject* obj, int size) {
-  MarkObject(heap_, map);
+  MarkObject<mode>(heap_, map);
 
-  IncrementalMarkingMarkingVisitor::IterateBody(map, obj);
+  IncrementalMarkingMarkingVisitor<mode>::IterateBody(map, obj);
 
   MarkBit mark_bit = Marking::MarkBitFrom(obj);
 #if ENABLE_SLOW_DCHECKS
@@ -716,18 +791,20 @@ void IncrementalMarking::VisitObject(Map* map, HeapObject* obj, int size) {
               (chunk->IsFlagSet(MemoryChunk::HAS_PROGRESS_BAR) &&
                Marking::IsBlack(mark_bit)));
 #endif
-  MarkBlackOrKeepBlack(obj, mark_bit, size);
+  MarkBlackOrKeepBlack<mode>(obj, mark_bit, size);
 }
 
 
+template <MarkBit::AccessMode mode>
 void IncrementalMarking::MarkObject(Heap* heap, HeapObject* obj) {
   MarkBit mark_bit = Marking::MarkBitFrom(obj);
   if (Marking::IsWhite(mark_bit)) {
-    heap->incremental_marking()->WhiteToGreyAndPush(obj, mark_bit);
+    heap->incremental_marking()->WhiteToGreyAndPush<mode>(obj, mark_bit);
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 intptr_t IncrementalMarking::ProcessMarkingDeque(intptr_t bytes_to_process) {
   intptr_t bytes_processed = 0;
   Map* filler_map = heap_->one_pointer_filler_map();
@@ -743,7 +820,7 @@ intptr_t IncrementalMarking::ProcessMarkingDeque(intptr_t bytes_to_process) {
 
     int size = obj->SizeFromMap(map);
     unscanned_bytes_of_large_object_ = 0;
-    VisitObject(map, obj, size);
+    VisitObject<mode>(map, obj, size);
     bytes_processed += size - unscanned_bytes_of_large_object_;
   }
   return bytes_processed;
@@ -762,13 +839,15 @@ void IncrementalMarking::ProcessMarkingDeque() {
     Map* map = obj->map();
     if (map == filler_map) continue;
 
-    VisitObject(map, obj, obj->SizeFromMap(map));
+    // Runs after the concurrent marking task is finished.
+    VisitObject<MarkBit::NON_ATOMIC>(map, obj, obj->SizeFromMap(map));
   }
 }
 
 
 void IncrementalMarking::Hurry() {
   if (state() == MARKING) {
+    heap_->concurrent_marking()->FinishTask();
     double start = 0.0;
     if (FLAG_trace_incremental_marking || FLAG_print_cumulative_gc_stat) {
       start = base::OS::TimeCurrentMillis();
@@ -825,6 +904,7 @@ void IncrementalMarking::Stop() {
   IncrementalMarking::set_should_hurry(false);
   ResetStepCounters();
   if (IsMarking()) {
+    heap_->concurrent_marking()->AbortTask();
     PatchIncrementalMarkingRecordWriteStubs(heap_,
                                             RecordWriteStub::STORE_BUFFER_ONLY);
     DeactivateIncrementalWriteBarrier();
@@ -1052,6 +1132,16 @@ intptr_t IncrementalMarking::Step(intptr_t allocated_bytes,
     intptr_t bytes_to_process =
         marking_speed_ *
         Max(allocated_, write_barriers_invoked_since_last_step_);
+    if (heap_->HasPauseBudget()) {
+      // Keep the step within the pause budget at the price of more steps.
+      intptr_t speed =
+          heap_->tracer()->IncrementalMarkingSpeedInBytesPerMillisecond();
+      if (speed > 0) {
+        bytes_to_process = Min(
+            bytes_to_process, static_cast<intptr_t>(
+                                  speed * heap_->pause_budget_in_ms()));
+      }
+    }
     allocated_ = 0;
     write_barriers_invoked_since_last_step_ = 0;
 
@@ -1068,8 +1158,18 @@ intptr_t IncrementalMarking::Step(intptr_t allocated_bytes,
         StartMarking();
       }
     } else if (state_ == MARKING) {
-      bytes_processed = ProcessMarkingDeque(bytes_to_process);
-      if (heap_->mark_compact_collector()->marking_deque()->IsEmpty()) {
+      // Objects that the concurrent marker bailed out are processed first.
+      heap_->concurrent_marking()->TryFinishTask();
+      if (FLAG_concurrent_marking) {
+        bytes_processed =
+            ProcessMarkingDeque<MarkBit::ATOMIC>(bytes_to_process);
+        heap_->concurrent_marking()->ScheduleTask();
+      } else {
+        bytes_processed =
+            ProcessMarkingDeque<MarkBit::NON_ATOMIC>(bytes_to_process);
+      }
+      if (heap_->mark_compact_collector()->marking_deque()->IsEmpty() &&
+          !heap_->concurrent_marking()->IsTaskPending()) {
         if (completion == FORCE_COMPLETION ||
             IsIdleMarkingDelayCounterLimitReached()) {
           if (FLAG_overapproximate_weak_closure &&
@@ -8,13 +8,13 @@
 #include "src/cancelable-task.h"
 #include "src/execution.h"
 #include "src/heap/incremental-marking-job.h"
+#include "src/heap/spaces.h"
 #include "src/objects.h"
 
 namespace v8 {
 namespace internal {
 
 // Forward declarations.
-class MarkBit;
 class PagedSpace;
 
 class IncrementalMarking {
@@ -176,8 +176,12 @@ class IncrementalMarking {
 
   void RecordWrites(HeapObject* obj);
 
+  // Mark bits have to be updated atomically while a concurrent marking task
+  // may be running, i.e. with --concurrent-marking. Callers choose the mode.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   void BlackToGreyAndUnshift(HeapObject* obj, MarkBit mark_bit);
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   void WhiteToGreyAndPush(HeapObject* obj, MarkBit mark_bit);
 
   inline void SetOldSpacePageFlags(MemoryChunk* chunk) {
@@ -206,6 +210,7 @@ class IncrementalMarking {
 
   bool IsIdleMarkingDelayCounterLimitReached();
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void MarkObject(Heap* heap, HeapObject* object));
 
   Heap* heap() const { return heap_; }
@@ -238,8 +243,10 @@ class IncrementalMarking {
 
   INLINE(void ProcessMarkingDeque());
 
+  template <MarkBit::AccessMode mode>
   INLINE(intptr_t ProcessMarkingDeque(intptr_t bytes_to_process));
 
+  template <MarkBit::AccessMode mode>
   INLINE(void VisitObject(Map* map, HeapObject* obj, int size));
 
   void IncrementIdleMarkingDelayCounter();
@@ -6,45 +6,60 @@
 #define V8_HEAP_MARK_COMPACT_INL_H_
 
 #include "src/heap/mark-compact.h"
+#include "src/heap/remembered-set.h"
 #include "src/heap/slots-buffer.h"
 #include "src/isolate.h"
 
 namespace v8 {
 namespace internal {
 
+template <MarkBit::AccessMode mode>
 void MarkCompactCollector::PushBlack(HeapObject* obj) {
   DCHECK(Marking::IsBlack(Marking::MarkBitFrom(obj)));
   if (marking_deque_.Push(obj)) {
     MemoryChunk::IncrementLiveBytesFromGC(obj, obj->Size());
   } else {
-    Marking::BlackToGrey(obj);
+    Marking::BlackToGrey<mode>(obj);
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 void MarkCompactCollector::UnshiftBlack(HeapObject* obj) {
   DCHECK(Marking::IsBlack(Marking::MarkBitFrom(obj)));
   if (!marking_deque_.Unshift(obj)) {
     MemoryChunk::IncrementLiveBytesFromGC(obj, -obj->Size());
-    Marking::BlackToGrey(obj);
+    Marking::BlackToGrey<mode>(obj);
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 void MarkCompactCollector::MarkObject(HeapObject* obj, MarkBit mark_bit) {
   DCHECK(Marking::MarkBitFrom(obj) == mark_bit);
   if (Marking::IsWhite(mark_bit)) {
-    Marking::WhiteToBlack(mark_bit);
+    if (mode == MarkBit::ATOMIC) {
+      // Parallel marking tasks may claim the object concurrently.
+      if (!Marking::WhiteToBlackAtomic(mark_bit)) return;
+    } else {
+      Marking::WhiteToBlack(mark_bit);
+    }
     DCHECK(obj->GetIsolate()->heap()->Contains(obj));
-    PushBlack(obj);
+    PushBlack<mode>(obj);
   }
 }
 
 
+template <MarkBit::AccessMode mode>
 void MarkCompactCollector::SetMark(HeapObject* obj, MarkBit mark_bit) {
-  DCHECK(Marking::IsWhite(mark_bit));
   DCHECK(Marking::MarkBitFrom(obj) == mark_bit);
-  Marking::WhiteToBlack(mark_bit);
+  if (mode == MarkBit::ATOMIC) {
+    // Parallel marking tasks may have claimed the object in the meantime.
+    if (!Marking::WhiteToBlackAtomic(mark_bit)) return;
+  } else {
+    DCHECK(Marking::IsWhite(mark_bit));
+    Marking::WhiteToBlack(mark_bit);
+  }
   MemoryChunk::IncrementLiveBytesFromGC(obj, obj->Size());
 }
 
@@ -61,24 +76,16 @@ void MarkCompactCollector::RecordSlot(HeapObject* object, Object** slot,
   Page* target_page = Page::FromAddress(reinterpret_cast<Address>(target));
   if (target_page->IsEvacuationCandidate() &&
       !ShouldSkipEvacuationSlotRecording(object)) {
-    if (!SlotsBuffer::AddTo(slots_buffer_allocator_,
-                            target_page->slots_buffer_address(), slot,
-                            SlotsBuffer::FAIL_ON_OVERFLOW)) {
-      EvictPopularEvacuationCandidate(target_page);
-    }
+    RememberedSet<OLD_TO_OLD>::Insert(
+        MemoryChunk::FromAddress(object->address()),
+        reinterpret_cast<Address>(slot));
   }
 }
 
 
 void MarkCompactCollector::ForceRecordSlot(HeapObject* object, Object** slot,
                                            Object* target) {
-  Page* target_page = Page::FromAddress(reinterpret_cast<Address>(target));
-  if (target_page->IsEvacuationCandidate() &&
-      !ShouldSkipEvacuationSlotRecording(object)) {
-    CHECK(SlotsBuffer::AddTo(slots_buffer_allocator_,
-                             target_page->slots_buffer_address(), slot,
-                             SlotsBuffer::IGNORE_OVERFLOW));
-  }
+  RecordSlot(object, slot, target);
 }
 
 
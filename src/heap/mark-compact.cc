@@ -15,12 +15,15 @@
 #include "src/gdb-jit.h"
 #include "src/global-handles.h"
 #include "src/heap/array-buffer-tracker.h"
+#include "src/heap/gc-idle-time-handler.h"
 #include "src/heap/gc-tracer.h"
 #include "src/heap/incremental-marking.h"
 #include "src/heap/mark-compact-inl.h"
 #include "src/heap/object-stats.h"
 #include "src/heap/objects-visiting.h"
 #include "src/heap/objects-visiting-inl.h"
+#include "src/heap/parallel-marking.h"
+#include "src/heap/remembered-set.h"
 #include "src/heap/slots-buffer.h"
 #include "src/heap/spaces-inl.h"
 #include "src/ic/ic.h"
@@ -60,9 +63,11 @@ MarkCompactCollector::MarkCompactCollector(Heap* heap)
       marking_deque_memory_(NULL),
       marking_deque_memory_committed_(0),
       code_flusher_(NULL),
+      parallel_marking_background_bytes_(0),
       have_code_to_deoptimize_(false),
       compacting_(false),
       sweeping_in_progress_(false),
+      sampling_object_stats_(false),
       compaction_in_progress_(false),
       pending_sweeper_tasks_semaphore_(0),
       pending_compaction_tasks_semaphore_(0),
@@ -297,7 +302,9 @@ bool MarkCompactCollector::StartCompaction(CompactionMode mode) {
 
 
 void MarkCompactCollector::ClearInvalidStoreAndSlotsBufferEntries() {
-  heap_->store_buffer()->ClearInvalidStoreBufferEntries();
+  heap_->store_buffer()->MoveEntriesToRememberedSet();
+  RememberedSet<OLD_TO_NEW>::ClearInvalidSlots(heap_);
+  RememberedSet<OLD_TO_OLD>::ClearInvalidSlots(heap_);
 
   int number_of_pages = evacuation_candidates_.length();
   for (int i = 0; i < number_of_pages; i++) {
@@ -318,7 +325,8 @@ static void VerifyValidSlotsBufferEntries(Heap* heap, PagedSpace* space) {
 
 
 void MarkCompactCollector::VerifyValidStoreAndSlotsBufferEntries() {
-  heap()->store_buffer()->VerifyValidStoreBufferEntries();
+  RememberedSet<OLD_TO_NEW>::VerifyValidSlots(heap());
+  RememberedSet<OLD_TO_OLD>::VerifyValidSlots(heap());
 
   VerifyValidSlotsBufferEntries(heap(), heap()->old_space());
   VerifyValidSlotsBufferEntries(heap(), heap()->code_space());
@@ -345,11 +353,14 @@ void MarkCompactCollector::CollectGarbage() {
   // ClearNonLiveReferences can deoptimize code in dependent code arrays.
   // Process weak cells before so that weak cells in dependent code
   // arrays are cleared or contain only live code objects.
-  ProcessAndClearWeakCells();
-
-  ClearNonLiveReferences();
-
-  ClearWeakCollections();
+  if (FLAG_parallel_weak_processing) {
+    ClearWeakReferencesInParallel();
+    ClearNonLiveReferences();
+  } else {
+    ProcessAndClearWeakCells();
+    ClearNonLiveReferences();
+    ClearWeakCollections();
+  }
 
   heap_->set_encountered_weak_cells(Smi::FromInt(0));
 
@@ -497,6 +508,66 @@ class MarkCompactCollector::CompactionTask : public v8::Task {
 };
 
 
+// The work shared by all pointer updating tasks after evacuation. Items are
+// single slots buffers followed by chunks with remembered sets.
+class MarkCompactCollector::PointersUpdatingWork {
+ public:
+  PointersUpdatingWork() : next_item_(0) {}
+
+  void AddSlotsBufferChain(SlotsBuffer* buffer) {
+    for (; buffer != NULL; buffer = buffer->next()) buffers_.Add(buffer);
+  }
+
+  void AddChunk(MemoryChunk* chunk) { chunks_.Add(chunk); }
+
+  int length() { return buffers_.length() + chunks_.length(); }
+
+  // Processes work items until none are left.
+  void Process(MarkCompactCollector* collector) {
+    while (true) {
+      int index =
+          static_cast<int>(base::NoBarrier_AtomicIncrement(&next_item_, 1)) -
+          1;
+      if (index >= length()) break;
+      if (index < buffers_.length()) {
+        collector->UpdateSlots(buffers_[index]);
+      } else {
+        collector->UpdatePointersInChunk(chunks_[index - buffers_.length()]);
+      }
+    }
+  }
+
+ private:
+  List<SlotsBuffer*> buffers_;
+  List<MemoryChunk*> chunks_;
+  base::AtomicWord next_item_;
+
+  DISALLOW_COPY_AND_ASSIGN(PointersUpdatingWork);
+};
+
+
+class MarkCompactCollector::PointersUpdatingTask : public v8::Task {
+ public:
+  PointersUpdatingTask(Heap* heap, PointersUpdatingWork* work)
+      : heap_(heap), work_(work) {}
+
+  virtual ~PointersUpdatingTask() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override {
+    MarkCompactCollector* mark_compact = heap_->mark_compact_collector();
+    work_->Process(mark_compact);
+    mark_compact->pending_compaction_tasks_semaphore_.Signal();
+  }
+
+  Heap* heap_;
+  PointersUpdatingWork* work_;
+
+  DISALLOW_COPY_AND_ASSIGN(PointersUpdatingTask);
+};
+
+
 class MarkCompactCollector::SweeperTask : public v8::Task {
  public:
   SweeperTask(Heap* heap, PagedSpace* space) : heap_(heap), space_(space) {}
@@ -566,10 +637,16 @@ void MarkCompactCollector::EnsureSweepingCompleted() {
 
   ParallelSweepSpacesComplete();
   sweeping_in_progress_ = false;
+  heap()->array_buffer_tracker()->FreeQueued();
   heap()->old_space()->RefillFreeList();
   heap()->code_space()->RefillFreeList();
   heap()->map_space()->RefillFreeList();
 
+  if (sampling_object_stats_) {
+    sampling_object_stats_ = false;
+    heap()->ObjectStatsSampleComplete();
+  }
+
 #ifdef VERIFY_HEAP
   if (FLAG_verify_heap && !evacuation()) {
     VerifyEvacuation(heap_);
@@ -652,7 +729,7 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
   int area_size = space->AreaSize();
 
   // Pairs of (live_bytes_in_page, page).
-  std::vector<std::pair<int, Page*> > pages;
+  std::vector<LiveBytesPagePair> pages;
   pages.reserve(number_of_pages);
 
   PageIterator it(space);
@@ -698,6 +775,12 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
         AddEvacuationCandidate(p);
       }
     }
+  } else if (FLAG_compaction_scoring) {
+    candidate_count = SelectEvacuationCandidatesByScore(
+        space, &pages, reduce_memory, &total_live_bytes);
+    for (int i = 0; i < candidate_count; i++) {
+      AddEvacuationCandidate(pages[i].second);
+    }
   } else {
     const int kTargetFragmentationPercent = 50;
     const int kMaxEvacuatedBytes = 4 * Page::kPageSize;
@@ -715,6 +798,21 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
       target_fragmentation_percent = kTargetFragmentationPercent;
       max_evacuated_bytes = kMaxEvacuatedBytes;
     }
+    if (heap()->HasPauseBudget()) {
+      // Leave the larger part of the pause budget to marking and updating
+      // pointers.
+      const double kPauseBudgetFractionForCompaction = 0.25;
+      intptr_t compaction_speed =
+          heap()->tracer()->CompactionSpeedInBytesPerMillisecond();
+      if (compaction_speed > 0) {
+        double max_evacuated_bytes_in_budget =
+            compaction_speed * heap()->pause_budget_in_ms() *
+            kPauseBudgetFractionForCompaction;
+        if (max_evacuated_bytes_in_budget < max_evacuated_bytes) {
+          max_evacuated_bytes = static_cast<int>(max_evacuated_bytes_in_budget);
+        }
+      }
+    }
     intptr_t free_bytes_threshold =
         target_fragmentation_percent * (area_size / 100);
 
@@ -768,8 +866,124 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
 }
 
 
+int MarkCompactCollector::SelectEvacuationCandidatesByScore(
+    PagedSpace* space, std::vector<LiveBytesPagePair>* pages,
+    bool reduce_memory, int* total_live_bytes) {
+  // Memory in the smaller free list categories can only be reused by small
+  // objects, so freeing it by compaction is worth more than freeing memory
+  // the allocator can already put to use.
+  const double kSmallFreeListWeight = 1.0;
+  const double kMediumFreeListWeight = 0.75;
+  const double kLargeFreeListWeight = 0.5;
+  const double kHugeFreeListWeight = 0.25;
+  const int kMinFragmentationPercentForReduceMemory = 20;
+  const double kTimeBudgetFactorForReduceMemory = 3;
+  // Leave the larger part of a pause budget to marking and updating pointers.
+  const double kPauseBudgetFractionForCompaction = 0.25;
+
+  int area_size = space->AreaSize();
+  int min_fragmentation_percent = FLAG_compaction_min_fragmentation;
+  double time_budget_in_ms = FLAG_compaction_time_budget;
+  if (reduce_memory) {
+    min_fragmentation_percent = Min(min_fragmentation_percent,
+                                    kMinFragmentationPercentForReduceMemory);
+    time_budget_in_ms *= kTimeBudgetFactorForReduceMemory;
+  }
+  if (heap()->HasPauseBudget()) {
+    time_budget_in_ms =
+        Min(time_budget_in_ms,
+            heap()->pause_budget_in_ms() * kPauseBudgetFractionForCompaction);
+  }
+  intptr_t compaction_speed =
+      heap()->tracer()->CompactionSpeedInBytesPerMillisecond();
+  if (compaction_speed == 0) {
+    compaction_speed = static_cast<intptr_t>(
+        GCIdleTimeHandler::kInitialConservativeMarkCompactSpeed);
+  }
+  intptr_t min_free_bytes = min_fragmentation_percent * (area_size / 100);
+
+  // Pairs of (score, index into |pages|), sorted by decreasing score.
+  std::vector<std::pair<double, size_t> > scores;
+  scores.reserve(pages->size());
+  for (size_t i = 0; i < pages->size(); i++) {
+    Page* p = (*pages)[i].second;
+    int free_bytes = area_size - (*pages)[i].first;
+    double reclaimable = free_bytes;
+    if (p->WasSwept()) {
+      intptr_t in_free_lists = p->available_in_small_free_list() +
+                               p->available_in_medium_free_list() +
+                               p->available_in_large_free_list() +
+                               p->available_in_huge_free_list();
+      reclaimable =
+          (free_bytes - in_free_lists) +
+          kSmallFreeListWeight * p->available_in_small_free_list() +
+          kMediumFreeListWeight * p->available_in_medium_free_list() +
+          kLargeFreeListWeight * p->available_in_large_free_list() +
+          kHugeFreeListWeight * p->available_in_huge_free_list();
+    }
+    scores.push_back(
+        std::make_pair(reclaimable / ((*pages)[i].first + 1), i));
+  }
+  std::sort(scores.begin(), scores.end(),
+            std::greater<std::pair<double, size_t> >());
+
+  std::vector<LiveBytesPagePair> selected;
+  std::vector<LiveBytesPagePair> rejected;
+  double predicted_time_in_ms = 0;
+  intptr_t total_free_bytes = 0;
+  for (size_t i = 0; i < scores.size(); i++) {
+    LiveBytesPagePair page = (*pages)[scores[i].second];
+    int live_bytes = page.first;
+    int free_bytes = area_size - live_bytes;
+    double time_in_ms = static_cast<double>(live_bytes) / compaction_speed;
+    bool select = FLAG_always_compact ||
+                  (free_bytes >= min_free_bytes &&
+                   predicted_time_in_ms + time_in_ms <= time_budget_in_ms);
+    if (select) {
+      selected.push_back(page);
+      predicted_time_in_ms += time_in_ms;
+      total_free_bytes += free_bytes;
+      *total_live_bytes += live_bytes;
+    } else {
+      rejected.push_back(page);
+    }
+    if (FLAG_trace_fragmentation_verbose) {
+      PrintF(
+          "Page in %s: %d KB free, %d KB live, score %.2f, evacuation "
+          "%.3f ms [%s]\n",
+          AllocationSpaceName(space->identity()),
+          static_cast<int>(free_bytes / KB), static_cast<int>(live_bytes / KB),
+          scores[i].first, time_in_ms, select ? "selected" : "skipped");
+    }
+  }
+
+  int candidate_count = static_cast<int>(selected.size());
+  // How many pages we will allocate for the evacuated objects in the worst
+  // case. Avoid (compact -> expand) cycles.
+  int estimated_new_pages = (*total_live_bytes + area_size - 1) / area_size;
+  if (candidate_count == estimated_new_pages && !FLAG_always_compact) {
+    candidate_count = 0;
+    *total_live_bytes = 0;
+  }
+  if (FLAG_trace_fragmentation) {
+    PrintF(
+        "Scored %d pages in %s: %d KB free in %d pages, evacuation predicted "
+        "at %.3f ms [budget %.3f ms, %d%% fragmentation or more]\n",
+        static_cast<int>(pages->size()),
+        AllocationSpaceName(space->identity()),
+        static_cast<int>(total_free_bytes / KB), candidate_count,
+        predicted_time_in_ms, time_budget_in_ms, min_fragmentation_percent);
+  }
+
+  selected.insert(selected.end(), rejected.begin(), rejected.end());
+  pages->swap(selected);
+  return candidate_count;
+}
+
+
 void MarkCompactCollector::AbortCompaction() {
   if (compacting_) {
+    RememberedSet<OLD_TO_OLD>::ClearAll(heap());
     int npages = evacuation_candidates_.length();
     for (int i = 0; i < npages; i++) {
       Page* p = evacuation_candidates_[i];
@@ -1214,9 +1428,14 @@ MarkCompactCollector::~MarkCompactCollector() {
 }
 
 
+// The mark bit access mode is ATOMIC for the instance that runs on the main
+// thread next to parallel marking tasks, see ParallelMarking.
+template <MarkBit::AccessMode mode>
 class MarkCompactMarkingVisitor
-    : public StaticMarkingVisitor<MarkCompactMarkingVisitor> {
+    : public StaticMarkingVisitor<MarkCompactMarkingVisitor<mode> > {
  public:
+  typedef StaticMarkingVisitor<MarkCompactMarkingVisitor<mode> > Base;
+
   static void Initialize();
 
   INLINE(static void VisitPointer(Heap* heap, HeapObject* object, Object** p)) {
@@ -1226,8 +1445,11 @@ class MarkCompactMarkingVisitor
   INLINE(static void VisitPointers(Heap* heap, HeapObject* object,
                                    Object** start, Object** end)) {
     // Mark all objects pointed to in [start, end).
+    // Recursive marking visits objects without claiming them, which would
+    // race with parallel marking tasks.
     const int kMinRangeForMarkingRecursion = 64;
-    if (end - start >= kMinRangeForMarkingRecursion) {
+    if (end - start >= kMinRangeForMarkingRecursion &&
+        mode == MarkBit::NON_ATOMIC) {
       if (VisitUnmarkedObjects(heap, object, start, end)) return;
       // We are close to a stack overflow, so just mark the objects.
     }
@@ -1240,7 +1462,7 @@ class MarkCompactMarkingVisitor
   // Marks the object black and pushes it on the marking stack.
   INLINE(static void MarkObject(Heap* heap, HeapObject* object)) {
     MarkBit mark = Marking::MarkBitFrom(object);
-    heap->mark_compact_collector()->MarkObject(object, mark);
+    heap->mark_compact_collector()->MarkObject<mode>(object, mark);
   }
 
   // Marks the object black without pushing it on the marking stack.
@@ -1248,7 +1470,7 @@ class MarkCompactMarkingVisitor
   INLINE(static bool MarkObjectWithoutPush(Heap* heap, HeapObject* object)) {
     MarkBit mark_bit = Marking::MarkBitFrom(object);
     if (Marking::IsWhite(mark_bit)) {
-      heap->mark_compact_collector()->SetMark(object, mark_bit);
+      heap->mark_compact_collector()->SetMark<mode>(object, mark_bit);
       return true;
     }
     return false;
@@ -1261,7 +1483,7 @@ class MarkCompactMarkingVisitor
     HeapObject* target_object = HeapObject::cast(*p);
     collector->RecordSlot(object, p, target_object);
     MarkBit mark = Marking::MarkBitFrom(target_object);
-    collector->MarkObject(target_object, mark);
+    collector->MarkObject<mode>(target_object, mark);
   }
 
 
@@ -1275,11 +1497,11 @@ class MarkCompactMarkingVisitor
     Map* map = obj->map();
     Heap* heap = obj->GetHeap();
     MarkBit mark = Marking::MarkBitFrom(obj);
-    heap->mark_compact_collector()->SetMark(obj, mark);
+    heap->mark_compact_collector()->SetMark<mode>(obj, mark);
     // Mark the map pointer and the body.
     MarkBit map_mark = Marking::MarkBitFrom(map);
-    heap->mark_compact_collector()->MarkObject(map, map_mark);
-    IterateBody(map, obj);
+    heap->mark_compact_collector()->MarkObject<mode>(map, map_mark);
+    Base::IterateBody(map, obj);
   }
 
   // Visit all unmarked objects pointed to by [start, end).
@@ -1369,7 +1591,7 @@ class MarkCompactMarkingVisitor
     Heap* heap = map->GetHeap();
     MarkCompactCollector* collector = heap->mark_compact_collector();
     if (!collector->is_code_flushing_enabled()) {
-      VisitJSRegExp(map, object);
+      Base::VisitJSRegExp(map, object);
       return;
     }
     JSRegExp* re = reinterpret_cast<JSRegExp*>(object);
@@ -1377,18 +1599,21 @@ class MarkCompactMarkingVisitor
     UpdateRegExpCodeAgeAndFlush(heap, re, true);
     UpdateRegExpCodeAgeAndFlush(heap, re, false);
     // Visit the fields of the RegExp, including the updated FixedArray.
-    VisitJSRegExp(map, object);
+    Base::VisitJSRegExp(map, object);
   }
 };
 
 
-void MarkCompactMarkingVisitor::Initialize() {
-  StaticMarkingVisitor<MarkCompactMarkingVisitor>::Initialize();
+template <MarkBit::AccessMode mode>
+void MarkCompactMarkingVisitor<mode>::Initialize() {
+  Base::Initialize();
 
-  table_.Register(kVisitJSRegExp, &VisitRegExpAndFlushCode);
+  Base::table_.Register(StaticVisitorBase::kVisitJSRegExp,
+                        &VisitRegExpAndFlushCode);
 
-  if (FLAG_track_gc_object_stats) {
-    ObjectStatsVisitor::Initialize(&table_);
+  // Object statistics are not tracked with parallel marking.
+  if (FLAG_track_gc_object_stats && mode == MarkBit::NON_ATOMIC) {
+    ObjectStatsVisitor::Initialize(&Base::table_);
   }
 }
 
@@ -1444,8 +1669,8 @@ void MarkCompactCollector::PrepareThreadForCodeFlushing(Isolate* isolate,
     MarkBit code_mark = Marking::MarkBitFrom(code);
     MarkObject(code, code_mark);
     if (frame->is_optimized()) {
-      MarkCompactMarkingVisitor::MarkInlinedFunctionsCode(heap(),
-                                                          frame->LookupCode());
+      MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::MarkInlinedFunctionsCode(
+          heap(), frame->LookupCode());
     }
   }
 }
@@ -1512,11 +1737,12 @@ class RootMarkingVisitor : public ObjectVisitor {
     // Mark the map pointer and body, and push them on the marking stack.
     MarkBit map_mark = Marking::MarkBitFrom(map);
     collector_->MarkObject(map, map_mark);
-    MarkCompactMarkingVisitor::IterateBody(map, object);
+    MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::IterateBody(map, object);
 
     // Mark all the objects reachable from the map and body.  May leave
-    // overflowed objects in the heap.
-    collector_->EmptyMarkingDeque();
+    // overflowed objects in the heap. Parallel marking processes the
+    // marking deque once all roots are visited.
+    if (!collector_->UseParallelMarking()) collector_->EmptyMarkingDeque();
   }
 
   MarkCompactCollector* collector_;
@@ -1833,24 +2059,40 @@ void MarkCompactCollector::MarkImplicitRefGroups(
 void MarkCompactCollector::EmptyMarkingDeque() {
   Map* filler_map = heap_->one_pointer_filler_map();
   while (!marking_deque_.IsEmpty()) {
+    if (!parallel_marking_.is_empty() &&
+        marking_deque_.Size() >= kMinMarkingDequeSizeForParallelMarking) {
+      parallel_marking_background_bytes_ +=
+          parallel_marking_->ProcessMarkingDeque(&marking_deque_);
+      return;
+    }
     HeapObject* object = marking_deque_.Pop();
     // Explicitly skip one word fillers. Incremental markbit patterns are
     // correct only for objects that occupy at least two words.
-    Map* map = object->map();
-    if (map == filler_map) continue;
+    if (object->map() == filler_map) continue;
+    VisitObjectBody(object);
+  }
+}
 
-    DCHECK(object->IsHeapObject());
-    DCHECK(heap()->Contains(object));
-    DCHECK(!Marking::IsWhite(Marking::MarkBitFrom(object)));
 
-    MarkBit map_mark = Marking::MarkBitFrom(map);
-    MarkObject(map, map_mark);
+template <MarkBit::AccessMode mode>
+void MarkCompactCollector::VisitObjectBody(HeapObject* object) {
+  DCHECK(object->IsHeapObject());
+  DCHECK(heap()->Contains(object));
+  DCHECK(!Marking::IsWhite(Marking::MarkBitFrom(object)));
 
-    MarkCompactMarkingVisitor::IterateBody(map, object);
-  }
+  Map* map = object->map();
+  MarkBit map_mark = Marking::MarkBitFrom(map);
+  MarkObject<mode>(map, map_mark);
+
+  MarkCompactMarkingVisitor<mode>::IterateBody(map, object);
 }
 
 
+// Used by the main thread during parallel marking.
+template void MarkCompactCollector::VisitObjectBody<MarkBit::ATOMIC>(
+    HeapObject* object);
+
+
 // Sweep the heap for overflowed objects, clear their overflow bits, and
 // push them on the marking stack.  Stop early if the marking stack fills
 // before sweeping completes.  If sweeping completes, there are no remaining
@@ -1898,15 +2140,23 @@ void MarkCompactCollector::ProcessMarkingDeque() {
 void MarkCompactCollector::ProcessEphemeralMarking(
     ObjectVisitor* visitor, bool only_process_harmony_weak_collections) {
   bool work_to_do = true;
+  int iterations = 0;
   DCHECK(marking_deque_.IsEmpty() && !marking_deque_.overflowed());
   while (work_to_do) {
     if (!only_process_harmony_weak_collections) {
       isolate()->global_handles()->IterateObjectGroups(
           visitor, &IsUnmarkedHeapObjectWithHeap);
-      MarkImplicitRefGroups(&MarkCompactMarkingVisitor::MarkObject);
+      MarkImplicitRefGroups(
+          &MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::MarkObject);
+    }
+    // Chains of ephemerons can take one iteration per link to converge, so
+    // switch to the linear algorithm once the fixpoint is slow to reach.
+    if (iterations++ >= FLAG_ephemeron_fixpoint_iterations) {
+      work_to_do = ProcessWeakCollectionsLinear();
+    } else {
+      ProcessWeakCollections();
+      work_to_do = !marking_deque_.IsEmpty();
     }
-    ProcessWeakCollections();
-    work_to_do = !marking_deque_.IsEmpty();
     ProcessMarkingDeque();
   }
 }
@@ -2110,6 +2360,11 @@ void MarkCompactCollector::MarkLiveObjects() {
   EnsureMarkingDequeIsCommittedAndInitialize(
       MarkCompactCollector::kMaxMarkingDequeSize);
 
+  parallel_marking_background_bytes_ = 0;
+  if (UseParallelMarking()) {
+    parallel_marking_.Reset(new ParallelMarking(heap()));
+  }
+
   {
     GCTracer::Scope gc_scope(heap()->tracer(),
                              GCTracer::Scope::MC_MARK_PREPARE_CODE_FLUSH);
@@ -2169,6 +2424,8 @@ void MarkCompactCollector::MarkLiveObjects() {
 
   AfterMarking();
 
+  parallel_marking_.Reset(NULL);
+
   if (FLAG_print_cumulative_gc_stat) {
     heap_->tracer()->AddMarkingTime(base::OS::TimeCurrentMillis() - start_time);
   }
@@ -2474,8 +2731,8 @@ void MarkCompactCollector::ProcessWeakCollections() {
           RecordSlot(table, key_slot, *key_slot);
           Object** value_slot =
               table->RawFieldOfElementAt(ObjectHashTable::EntryToValueIndex(i));
-          MarkCompactMarkingVisitor::MarkObjectByPointer(this, table,
-                                                         value_slot);
+          MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::MarkObjectByPointer(
+              this, table, value_slot);
         }
       }
     }
@@ -2484,9 +2741,19 @@ void MarkCompactCollector::ProcessWeakCollections() {
 }
 
 
-void MarkCompactCollector::ClearWeakCollections() {
+bool MarkCompactCollector::ProcessWeakCollectionsLinear() {
   GCTracer::Scope gc_scope(heap()->tracer(),
-                           GCTracer::Scope::MC_WEAKCOLLECTION_CLEAR);
+                           GCTracer::Scope::MC_WEAKCOLLECTION_PROCESS);
+  // Entries with unmarked keys, chained per key through |next|.
+  struct Ephemeron {
+    ObjectHashTable* table;
+    int entry;
+    int next;
+  };
+  List<Ephemeron> ephemerons;
+  HashMap pending_keys(HashMap::PointersMatch);
+  bool marked = !marking_deque_.IsEmpty() || marking_deque_.overflowed();
+
   Object* weak_collection_obj = heap()->encountered_weak_collections();
   while (weak_collection_obj != Smi::FromInt(0)) {
     JSWeakCollection* weak_collection =
@@ -2496,12 +2763,92 @@ void MarkCompactCollector::ClearWeakCollections() {
       ObjectHashTable* table = ObjectHashTable::cast(weak_collection->table());
       for (int i = 0; i < table->Capacity(); i++) {
         HeapObject* key = HeapObject::cast(table->KeyAt(i));
-        if (!MarkCompactCollector::IsMarked(key)) {
-          table->RemoveEntry(i);
+        Object** key_slot =
+            table->RawFieldOfElementAt(ObjectHashTable::EntryToIndex(i));
+        Object** value_slot =
+            table->RawFieldOfElementAt(ObjectHashTable::EntryToValueIndex(i));
+        if (MarkCompactCollector::IsMarked(key)) {
+          RecordSlot(table, key_slot, *key_slot);
+          MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::MarkObjectByPointer(
+              this, table, value_slot);
+        } else if ((*value_slot)->IsHeapObject() &&
+                   !MarkCompactCollector::IsMarked(*value_slot)) {
+          HashMap::Entry* pending =
+              pending_keys.LookupOrInsert(key, ComputePointerHash(key));
+          int next = pending->value == nullptr
+                         ? -1
+                         : static_cast<int>(
+                               reinterpret_cast<intptr_t>(pending->value)) -
+                               1;
+          Ephemeron ephemeron = {table, i, next};
+          ephemerons.Add(ephemeron);
+          pending->value = reinterpret_cast<void*>(
+              static_cast<intptr_t>(ephemerons.length()));
         }
       }
     }
     weak_collection_obj = weak_collection->next();
+  }
+
+  // Objects are popped from the marking deque once after they got marked,
+  // which is when the values of their pending entries get marked. Keys that
+  // the visitor marks without pushing them are found by the next call, which
+  // the caller makes as long as this returns true.
+  Map* filler_map = heap_->one_pointer_filler_map();
+  while (true) {
+    if (!marking_deque_.IsEmpty()) marked = true;
+    while (!marking_deque_.IsEmpty()) {
+      HeapObject* object = marking_deque_.Pop();
+      if (object->map() == filler_map) continue;
+      VisitObjectBody(object);
+      if (pending_keys.occupancy() == 0) continue;
+      void* chain = pending_keys.Remove(object, ComputePointerHash(object));
+      if (chain == nullptr) continue;
+      for (int i = static_cast<int>(reinterpret_cast<intptr_t>(chain)) - 1;
+           i >= 0; i = ephemerons[i].next) {
+        ObjectHashTable* table = ephemerons[i].table;
+        int entry = ephemerons[i].entry;
+        Object** key_slot =
+            table->RawFieldOfElementAt(ObjectHashTable::EntryToIndex(entry));
+        RecordSlot(table, key_slot, *key_slot);
+        Object** value_slot = table->RawFieldOfElementAt(
+            ObjectHashTable::EntryToValueIndex(entry));
+        MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::MarkObjectByPointer(
+            this, table, value_slot);
+      }
+    }
+    if (!marking_deque_.overflowed()) break;
+    marked = true;
+    RefillMarkingDeque();
+  }
+  return marked;
+}
+
+
+void MarkCompactCollector::ClearDeadWeakCollectionEntries(
+    ObjectHashTable* table) {
+  for (int i = 0; i < table->Capacity(); i++) {
+    HeapObject* key = HeapObject::cast(table->KeyAt(i));
+    if (!MarkCompactCollector::IsMarked(key)) {
+      table->RemoveEntry(i);
+    }
+  }
+}
+
+
+void MarkCompactCollector::ClearWeakCollections() {
+  GCTracer::Scope gc_scope(heap()->tracer(),
+                           GCTracer::Scope::MC_WEAKCOLLECTION_CLEAR);
+  Object* weak_collection_obj = heap()->encountered_weak_collections();
+  while (weak_collection_obj != Smi::FromInt(0)) {
+    JSWeakCollection* weak_collection =
+        reinterpret_cast<JSWeakCollection*>(weak_collection_obj);
+    DCHECK(MarkCompactCollector::IsMarked(weak_collection));
+    if (weak_collection->table()->IsHashTable()) {
+      ClearDeadWeakCollectionEntries(
+          ObjectHashTable::cast(weak_collection->table()));
+    }
+    weak_collection_obj = weak_collection->next();
     weak_collection->set_next(heap()->undefined_value());
   }
   heap()->set_encountered_weak_collections(Smi::FromInt(0));
@@ -2527,40 +2874,197 @@ void MarkCompactCollector::ProcessAndClearWeakCells() {
   Object* weak_cell_obj = heap()->encountered_weak_cells();
   while (weak_cell_obj != Smi::FromInt(0)) {
     WeakCell* weak_cell = reinterpret_cast<WeakCell*>(weak_cell_obj);
-    // We do not insert cleared weak cells into the list, so the value
-    // cannot be a Smi here.
-    HeapObject* value = HeapObject::cast(weak_cell->value());
-    if (!MarkCompactCollector::IsMarked(value)) {
-      // Cells for new-space objects embedded in optimized code are wrapped in
-      // WeakCell and put into Heap::weak_object_to_code_table.
-      // Such cells do not have any strong references but we want to keep them
-      // alive as long as the cell value is alive.
-      // TODO(ulan): remove this once we remove Heap::weak_object_to_code_table.
-      if (value->IsCell()) {
-        Object* cell_value = Cell::cast(value)->value();
-        if (cell_value->IsHeapObject() &&
-            MarkCompactCollector::IsMarked(HeapObject::cast(cell_value))) {
-          // Resurrect the cell.
-          MarkBit mark = Marking::MarkBitFrom(value);
-          SetMark(value, mark);
-          Object** slot = HeapObject::RawField(value, Cell::kValueOffset);
-          RecordSlot(value, slot, *slot);
-          slot = HeapObject::RawField(weak_cell, WeakCell::kValueOffset);
-          RecordSlot(weak_cell, slot, *slot);
-        } else {
-          weak_cell->clear();
-        }
+    ProcessWeakCell(weak_cell);
+    weak_cell_obj = weak_cell->next();
+    weak_cell->clear_next(heap());
+  }
+  heap()->set_encountered_weak_cells(Smi::FromInt(0));
+}
+
+
+void MarkCompactCollector::ProcessWeakCell(WeakCell* weak_cell) {
+  // We do not insert cleared weak cells into the list, so the value
+  // cannot be a Smi here.
+  HeapObject* value = HeapObject::cast(weak_cell->value());
+  if (!MarkCompactCollector::IsMarked(value)) {
+    // Cells for new-space objects embedded in optimized code are wrapped in
+    // WeakCell and put into Heap::weak_object_to_code_table.
+    // Such cells do not have any strong references but we want to keep them
+    // alive as long as the cell value is alive.
+    // TODO(ulan): remove this once we remove Heap::weak_object_to_code_table.
+    if (value->IsCell()) {
+      Object* cell_value = Cell::cast(value)->value();
+      if (cell_value->IsHeapObject() &&
+          MarkCompactCollector::IsMarked(HeapObject::cast(cell_value))) {
+        // Resurrect the cell.
+        MarkBit mark = Marking::MarkBitFrom(value);
+        SetMark(value, mark);
+        Object** slot = HeapObject::RawField(value, Cell::kValueOffset);
+        RecordSlot(value, slot, *slot);
+        slot = HeapObject::RawField(weak_cell, WeakCell::kValueOffset);
+        RecordSlot(weak_cell, slot, *slot);
       } else {
         weak_cell->clear();
       }
     } else {
-      Object** slot = HeapObject::RawField(weak_cell, WeakCell::kValueOffset);
-      RecordSlot(weak_cell, slot, *slot);
+      weak_cell->clear();
     }
+  } else {
+    Object** slot = HeapObject::RawField(weak_cell, WeakCell::kValueOffset);
+    RecordSlot(weak_cell, slot, *slot);
+  }
+}
+
+
+// The work shared by all weak clearing tasks. Items are ranges of weak cells
+// followed by the tables of weak collections. Weak cells that need slots
+// recorded or may have to be resurrected are deferred to the main thread.
+class MarkCompactCollector::WeakClearingWork {
+ public:
+  WeakClearingWork() : deferred_cells_(nullptr), next_item_(0) {}
+
+  ~WeakClearingWork() { delete[] deferred_cells_; }
+
+  void AddWeakCell(WeakCell* weak_cell) { weak_cells_.Add(weak_cell); }
+
+  void AddTable(ObjectHashTable* table) { tables_.Add(table); }
+
+  // Must be called after all weak cells and tables have been added.
+  void Prepare() {
+    deferred_cells_ = new List<WeakCell*>[NumberOfWeakCellItems()];
+  }
+
+  int length() { return NumberOfWeakCellItems() + tables_.length(); }
+
+  // Processes work items until none are left.
+  void Process(Heap* heap) {
+    while (true) {
+      int index =
+          static_cast<int>(base::NoBarrier_AtomicIncrement(&next_item_, 1)) -
+          1;
+      if (index >= length()) break;
+      if (index < NumberOfWeakCellItems()) {
+        ProcessWeakCells(heap, index);
+      } else {
+        MarkCompactCollector::ClearDeadWeakCollectionEntries(
+            tables_[index - NumberOfWeakCellItems()]);
+      }
+    }
+  }
+
+  // Finishes the deferred weak cells on the main thread.
+  void ProcessDeferred(MarkCompactCollector* collector) {
+    for (int i = 0; i < NumberOfWeakCellItems(); i++) {
+      for (int j = 0; j < deferred_cells_[i].length(); j++) {
+        collector->ProcessWeakCell(deferred_cells_[i][j]);
+      }
+    }
+  }
+
+ private:
+  static const int kWeakCellsPerItem = 1024;
+
+  int NumberOfWeakCellItems() {
+    return (weak_cells_.length() + kWeakCellsPerItem - 1) / kWeakCellsPerItem;
+  }
+
+  void ProcessWeakCells(Heap* heap, int item) {
+    int start = item * kWeakCellsPerItem;
+    int end = Min(weak_cells_.length(), start + kWeakCellsPerItem);
+    for (int i = start; i < end; i++) {
+      WeakCell* weak_cell = weak_cells_[i];
+      HeapObject* value = HeapObject::cast(weak_cell->value());
+      if (MarkCompactCollector::IsMarked(value)) {
+        if (MarkCompactCollector::IsOnEvacuationCandidate(value)) {
+          deferred_cells_[item].Add(weak_cell);
+        }
+      } else if (value->IsCell()) {
+        deferred_cells_[item].Add(weak_cell);
+      } else {
+        weak_cell->clear();
+      }
+      weak_cell->clear_next(heap);
+    }
+  }
+
+  List<WeakCell*> weak_cells_;
+  List<ObjectHashTable*> tables_;
+  List<WeakCell*>* deferred_cells_;
+  base::AtomicWord next_item_;
+
+  DISALLOW_COPY_AND_ASSIGN(WeakClearingWork);
+};
+
+
+class MarkCompactCollector::WeakClearingTask : public v8::Task {
+ public:
+  WeakClearingTask(Heap* heap, WeakClearingWork* work)
+      : heap_(heap), work_(work) {}
+
+  virtual ~WeakClearingTask() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override {
+    work_->Process(heap_);
+    heap_->mark_compact_collector()->pending_compaction_tasks_semaphore_
+        .Signal();
+  }
+
+  Heap* heap_;
+  WeakClearingWork* work_;
+
+  DISALLOW_COPY_AND_ASSIGN(WeakClearingTask);
+};
+
+
+int MarkCompactCollector::NumberOfWeakProcessingTasks(int work_items) {
+  // We cap the number of parallel weak processing tasks by
+  // - (#cores - 1)
+  // - a value depending on the number of work items
+  // - a hard limit
+  const int kWorkItemsPerTask = 4;
+  const int kMaxWeakProcessingTasks = 8;
+  return Min(kMaxWeakProcessingTasks,
+             Min(1 + work_items / kWorkItemsPerTask,
+                 Max(1, base::SysInfo::NumberOfProcessors() - 1)));
+}
+
+
+void MarkCompactCollector::ClearWeakReferencesInParallel() {
+  GCTracer::Scope gc_scope(heap()->tracer(), GCTracer::Scope::MC_WEAKCELL);
+  WeakClearingWork work;
+  Object* weak_cell_obj = heap()->encountered_weak_cells();
+  while (weak_cell_obj != Smi::FromInt(0)) {
+    WeakCell* weak_cell = reinterpret_cast<WeakCell*>(weak_cell_obj);
+    work.AddWeakCell(weak_cell);
     weak_cell_obj = weak_cell->next();
-    weak_cell->clear_next(heap());
   }
   heap()->set_encountered_weak_cells(Smi::FromInt(0));
+  Object* weak_collection_obj = heap()->encountered_weak_collections();
+  while (weak_collection_obj != Smi::FromInt(0)) {
+    JSWeakCollection* weak_collection =
+        reinterpret_cast<JSWeakCollection*>(weak_collection_obj);
+    DCHECK(MarkCompactCollector::IsMarked(weak_collection));
+    if (weak_collection->table()->IsHashTable()) {
+      work.AddTable(ObjectHashTable::cast(weak_collection->table()));
+    }
+    weak_collection_obj = weak_collection->next();
+    weak_collection->set_next(heap()->undefined_value());
+  }
+  heap()->set_encountered_weak_collections(Smi::FromInt(0));
+  work.Prepare();
+
+  // Kick off parallel tasks and contribute in main thread.
+  const int num_tasks = NumberOfWeakProcessingTasks(work.length());
+  for (int i = 1; i < num_tasks; i++) {
+    concurrent_compaction_tasks_active_++;
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new WeakClearingTask(heap(), &work), v8::Platform::kShortRunningTask);
+  }
+  work.Process(heap());
+  WaitUntilCompactionCompleted();
+  work.ProcessDeferred(this);
 }
 
 
@@ -2741,21 +3245,54 @@ void MarkCompactCollector::MigrateObjectTagged(
 void MarkCompactCollector::MigrateObjectMixed(
     HeapObject* dst, HeapObject* src, int size,
     SlotsBuffer** evacuation_slots_buffer) {
-  if (src->IsFixedTypedArrayBase()) {
-    heap()->MoveBlock(dst->address(), src->address(), size);
+  heap()->MoveBlock(dst->address(), src->address(), size);
+  RecordMigratedSlotsInMixedObject(dst, size, evacuation_slots_buffer);
+}
+
+
+void MarkCompactCollector::RecordMigratedSlotsInObject(
+    HeapObject* dst, int size, SlotsBuffer** evacuation_slots_buffer) {
+  switch (dst->ContentType()) {
+    case HeapObjectContents::kTaggedValues: {
+      Address slot = dst->address();
+      for (int remaining = size / kPointerSize; remaining > 0; remaining--) {
+        RecordMigratedSlot(Memory::Object_at(slot), slot,
+                           evacuation_slots_buffer);
+        slot += kPointerSize;
+      }
+      break;
+    }
+
+    case HeapObjectContents::kMixedValues:
+      RecordMigratedSlotsInMixedObject(dst, size, evacuation_slots_buffer);
+      break;
+
+    case HeapObjectContents::kRawValues:
+      break;
+  }
+
+  if (compacting_ && dst->IsJSFunction()) {
+    Address code_entry_slot = dst->address() + JSFunction::kCodeEntryOffset;
+    Address code_entry = Memory::Address_at(code_entry_slot);
+    RecordMigratedCodeEntrySlot(code_entry, code_entry_slot,
+                                evacuation_slots_buffer);
+  }
+}
+
+
+void MarkCompactCollector::RecordMigratedSlotsInMixedObject(
+    HeapObject* dst, int size, SlotsBuffer** evacuation_slots_buffer) {
+  if (dst->IsFixedTypedArrayBase()) {
     Address base_pointer_slot =
         dst->address() + FixedTypedArrayBase::kBasePointerOffset;
     RecordMigratedSlot(Memory::Object_at(base_pointer_slot), base_pointer_slot,
                        evacuation_slots_buffer);
-  } else if (src->IsBytecodeArray()) {
-    heap()->MoveBlock(dst->address(), src->address(), size);
+  } else if (dst->IsBytecodeArray()) {
     Address constant_pool_slot =
         dst->address() + BytecodeArray::kConstantPoolOffset;
     RecordMigratedSlot(Memory::Object_at(constant_pool_slot),
                        constant_pool_slot, evacuation_slots_buffer);
-  } else if (src->IsJSArrayBuffer()) {
-    heap()->MoveBlock(dst->address(), src->address(), size);
-
+  } else if (dst->IsJSArrayBuffer()) {
     // Visit inherited JSObject properties and byte length of ArrayBuffer
     Address regular_slot =
         dst->address() + JSArrayBuffer::BodyDescriptor::kStartOffset;
@@ -2778,22 +3315,15 @@ void MarkCompactCollector::MigrateObjectMixed(
     }
   } else if (FLAG_unbox_double_fields) {
     Address dst_addr = dst->address();
-    Address src_addr = src->address();
-    Address src_slot = src_addr;
     Address dst_slot = dst_addr;
 
-    LayoutDescriptorHelper helper(src->map());
+    LayoutDescriptorHelper helper(dst->map());
     DCHECK(!helper.all_fields_tagged());
     for (int remaining = size / kPointerSize; remaining > 0; remaining--) {
-      Object* value = Memory::Object_at(src_slot);
-
-      Memory::Object_at(dst_slot) = value;
-
-      if (helper.IsTagged(static_cast<int>(src_slot - src_addr))) {
-        RecordMigratedSlot(value, dst_slot, evacuation_slots_buffer);
+      if (helper.IsTagged(static_cast<int>(dst_slot - dst_addr))) {
+        RecordMigratedSlot(Memory::Object_at(dst_slot), dst_slot,
+                           evacuation_slots_buffer);
       }
-
-      src_slot += kPointerSize;
       dst_slot += kPointerSize;
     }
   } else {
@@ -3061,14 +3591,6 @@ void MarkCompactCollector::UpdateSlots(SlotsBuffer* buffer) {
 }
 
 
-void MarkCompactCollector::UpdateSlotsRecordedIn(SlotsBuffer* buffer) {
-  while (buffer != NULL) {
-    UpdateSlots(buffer);
-    buffer = buffer->next();
-  }
-}
-
-
 static void UpdatePointer(HeapObject** address, HeapObject* object) {
   MapWord map_word = object->map_word();
   // The store buffer can still contain stale pointers in dead large objects.
@@ -3083,6 +3605,73 @@ static void UpdatePointer(HeapObject** address, HeapObject* object) {
 }
 
 
+void MarkCompactCollector::UpdatePointersInChunk(MemoryChunk* chunk) {
+  Heap* heap = heap_;
+  RememberedSet<OLD_TO_NEW>::IterateChunkWithWrapper(heap, chunk,
+                                                     UpdatePointer);
+  RememberedSet<OLD_TO_OLD>::IterateChunk(chunk, [heap](Address slot) {
+    PointersUpdatingVisitor::UpdateSlot(heap, reinterpret_cast<Object**>(slot));
+    return REMOVE_SLOT;
+  });
+}
+
+
+int MarkCompactCollector::NumberOfPointersUpdatingTasks(int work_items) {
+  if (!FLAG_parallel_pointer_update) return 1;
+  const int kMaxPointersUpdatingTasks = 8;
+  if (FLAG_pointer_update_tasks > 0) {
+    return Min(kMaxPointersUpdatingTasks, FLAG_pointer_update_tasks);
+  }
+  // We cap the number of parallel pointer updating tasks by
+  // - (#cores - 1)
+  // - a value depending on the number of work items
+  // - a hard limit
+  const int kWorkItemsPerTask = 8;
+  return Min(kMaxPointersUpdatingTasks,
+             Min(1 + work_items / kWorkItemsPerTask,
+                 Max(1, base::SysInfo::NumberOfProcessors() - 1)));
+}
+
+
+void MarkCompactCollector::UpdatePointersInParallel() {
+  PointersUpdatingWork work;
+  work.AddSlotsBufferChain(migration_slots_buffer_);
+  for (int i = 0; i < evacuation_slots_buffers_.length(); i++) {
+    work.AddSlotsBufferChain(evacuation_slots_buffers_[i]);
+  }
+  for (int i = 0; i < evacuation_candidates_.length(); i++) {
+    Page* p = evacuation_candidates_[i];
+    if (p->IsEvacuationCandidate()) {
+      work.AddSlotsBufferChain(p->slots_buffer());
+    }
+  }
+  // Old-to-new slots of promoted objects are recorded in the store buffer
+  // during evacuation. Flush it, so that the chunks holding them get work
+  // items.
+  heap()->store_buffer()->MoveEntriesToRememberedSet();
+  PointerChunkIterator it(heap());
+  MemoryChunk* chunk;
+  while ((chunk = it.next()) != nullptr) {
+    if (RememberedSet<OLD_TO_NEW>::HasSlots(chunk) ||
+        RememberedSet<OLD_TO_OLD>::HasSlots(chunk)) {
+      work.AddChunk(chunk);
+    }
+  }
+
+  // Kick off parallel tasks and contribute in main thread. Slots are updated
+  // with compare-and-swap, so slots recorded more than once are fine.
+  const int num_tasks = NumberOfPointersUpdatingTasks(work.length());
+  for (int i = 1; i < num_tasks; i++) {
+    concurrent_compaction_tasks_active_++;
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new PointersUpdatingTask(heap(), &work),
+        v8::Platform::kShortRunningTask);
+  }
+  work.Process(this);
+  WaitUntilCompactionCompleted();
+}
+
+
 static String* UpdateReferenceInExternalStringTableEntry(Heap* heap,
                                                          Object** p) {
   MapWord map_word = HeapObject::cast(*p)->map_word();
@@ -3302,6 +3891,109 @@ void MarkCompactCollector::VerifyIsSlotInLiveObject(Address slot,
 }
 
 
+bool MarkCompactCollector::ShouldPromotePage(NewSpacePage* p,
+                                             Address age_mark) {
+  // Only pages that are entirely below the age mark qualify: all objects on
+  // them would be promoted one by one otherwise.
+  return FLAG_page_promotion &&
+         p->IsFlagSet(MemoryChunk::NEW_SPACE_BELOW_AGE_MARK) &&
+         !p->ContainsLimit(age_mark) &&
+         p->LiveBytes() >
+             NewSpacePage::kAreaSize / 100 * FLAG_page_promotion_threshold;
+}
+
+
+bool MarkCompactCollector::TryPromotePage(NewSpacePage* p,
+                                          int* survivors_size) {
+  // First pass: find the range spanned by the live objects.
+  Address live_start = nullptr;
+  Address live_end = nullptr;
+  int live_size = 0;
+  for (MarkBitCellIterator it(p); !it.Done(); it.Advance()) {
+    Address cell_base = it.CurrentCellBase();
+    MarkBit::CellType current_cell = *it.CurrentCell();
+    int offset = 0;
+    while (current_cell != 0) {
+      int trailing_zeros = base::bits::CountTrailingZeros32(current_cell);
+      current_cell >>= trailing_zeros;
+      offset += trailing_zeros;
+      HeapObject* object =
+          HeapObject::FromAddress(cell_base + offset * kPointerSize);
+      int size = object->Size();
+      if (live_start == nullptr) live_start = object->address();
+      live_end = object->address() + size;
+      live_size += size;
+      offset += 2;
+      current_cell >>= 2;
+    }
+  }
+  if (live_start == nullptr) return false;
+
+  int range_size = static_cast<int>(live_end - live_start);
+
+  // Keep the double alignment of the objects in the range intact.
+  AllocationAlignment alignment =
+      IsAligned(OffsetFrom(live_start), kDoubleAlignment) ? kDoubleAligned
+                                                          : kDoubleUnaligned;
+  if (range_size + Heap::GetMaximumFillToAlign(alignment) >
+      Page::kAllocatableMemory) {
+    return false;
+  }
+  HeapObject* target = nullptr;
+  AllocationResult allocation =
+      heap()->old_space()->AllocateRawAligned(range_size, alignment);
+  if (!allocation.To(&target)) return false;
+
+  Address target_start = target->address();
+  Heap::CopyBlock(target_start, live_start, range_size);
+  intptr_t delta = target_start - live_start;
+
+  // Second pass: turn the gaps into fillers, record the slots of the copied
+  // objects and install forwarding addresses.
+  Address filler_start = target_start;
+  for (MarkBitCellIterator it(p); !it.Done(); it.Advance()) {
+    Address cell_base = it.CurrentCellBase();
+    MarkBit::CellType* cell = it.CurrentCell();
+    MarkBit::CellType current_cell = *cell;
+    if (current_cell == 0) continue;
+
+    int offset = 0;
+    while (current_cell != 0) {
+      int trailing_zeros = base::bits::CountTrailingZeros32(current_cell);
+      current_cell >>= trailing_zeros;
+      offset += trailing_zeros;
+      HeapObject* object =
+          HeapObject::FromAddress(cell_base + offset * kPointerSize);
+      HeapObject* copy = HeapObject::FromAddress(object->address() + delta);
+      int size = copy->Size();
+
+      if (copy->address() != filler_start) {
+        heap()->CreateFillerObjectAt(
+            filler_start, static_cast<int>(copy->address() - filler_start));
+      }
+      filler_start = copy->address() + size;
+
+      Heap::UpdateAllocationSiteFeedback(object, Heap::RECORD_SCRATCHPAD_SLOT);
+      RecordMigratedSlotsInObject(copy, size, &migration_slots_buffer_);
+      if (V8_UNLIKELY(copy->IsJSArrayBuffer())) {
+        heap()->array_buffer_tracker()->Promote(JSArrayBuffer::cast(copy));
+      }
+      heap()->OnMoveEvent(copy, object, size);
+      Memory::Address_at(object->address()) = copy->address();
+
+      offset += 2;
+      current_cell >>= 2;
+    }
+    *cell = 0;
+  }
+  DCHECK(filler_start == target_start + range_size);
+
+  heap()->IncrementPromotedObjectsSize(live_size);
+  *survivors_size += live_size;
+  return true;
+}
+
+
 void MarkCompactCollector::EvacuateNewSpace() {
   // There are soft limits in the allocation code, designed trigger a mark
   // sweep collection by failing allocations.  But since we are already in
@@ -3325,9 +4017,13 @@ void MarkCompactCollector::EvacuateNewSpace() {
   // migrate live objects and write forwarding addresses.  This stage puts
   // new entries in the store buffer and may cause some pages to be marked
   // scan-on-scavenge.
+  Address age_mark = new_space->age_mark();
   NewSpacePageIterator it(from_bottom, from_top);
   while (it.has_next()) {
     NewSpacePage* p = it.next();
+    if (ShouldPromotePage(p, age_mark) && TryPromotePage(p, &survivors_size)) {
+      continue;
+    }
     survivors_size += DiscoverAndEvacuateBlackObjectsOnPage(new_space, p);
   }
 
@@ -3344,7 +4040,8 @@ void MarkCompactCollector::AddEvacuationSlotsBufferSynchronized(
 
 
 bool MarkCompactCollector::EvacuateLiveObjectsFromPage(
-    Page* p, PagedSpace* target_space, SlotsBuffer** evacuation_slots_buffer) {
+    Page* p, PagedSpace* target_space, SlotsBuffer** evacuation_slots_buffer,
+    ObjectStats* object_stats) {
   AlwaysAllocateScope always_allocate(isolate());
   DCHECK(p->IsEvacuationCandidate() && !p->WasSwept());
 
@@ -3379,6 +4076,13 @@ bool MarkCompactCollector::EvacuateLiveObjectsFromPage(
       MigrateObject(target_object, object, size, target_space->identity(),
                     evacuation_slots_buffer);
       DCHECK(object->map_word().IsForwardingAddress());
+      if (object_stats != nullptr) {
+        object_stats->RecordObject(target_object, target_object->map(), size);
+      }
+      if (V8_UNLIKELY(target_object->IsJSArrayBuffer())) {
+        heap()->array_buffer_tracker()->Move(
+            object_addr, JSArrayBuffer::cast(target_object));
+      }
     }
 
     // Clear marking bits for current cell.
@@ -3406,6 +4110,12 @@ int MarkCompactCollector::NumberOfParallelCompactionTasks() {
 void MarkCompactCollector::EvacuatePagesInParallel() {
   if (evacuation_candidates_.length() == 0) return;
 
+  intptr_t live_bytes = 0;
+  for (int i = 0; i < evacuation_candidates_.length(); i++) {
+    live_bytes += evacuation_candidates_[i]->LiveBytes();
+  }
+  double start_time = heap()->MonotonicallyIncreasingTimeInMs();
+
   const int num_tasks = NumberOfParallelCompactionTasks();
 
   // Set up compaction spaces.
@@ -3434,6 +4144,9 @@ void MarkCompactCollector::EvacuatePagesInParallel() {
 
   WaitUntilCompactionCompleted();
 
+  heap()->tracer()->AddCompactionEvent(
+      heap()->MonotonicallyIncreasingTimeInMs() - start_time, live_bytes);
+
   // Merge back memory (compacted and unused) from compaction spaces.
   for (int i = 0; i < num_tasks; i++) {
     heap()->old_space()->MergeCompactionSpace(
@@ -3508,6 +4221,11 @@ void MarkCompactCollector::WaitUntilCompactionCompleted() {
 void MarkCompactCollector::EvacuatePages(
     CompactionSpaceCollection* compaction_spaces,
     SlotsBuffer** evacuation_slots_buffer) {
+  base::SmartPointer<ObjectStats> object_stats;
+  if (sampling_object_stats_) {
+    object_stats.Reset(new ObjectStats(heap(), true));
+    object_stats->ClearObjectStats(true);
+  }
   for (int i = 0; i < evacuation_candidates_.length(); i++) {
     Page* p = evacuation_candidates_[i];
     DCHECK(p->IsEvacuationCandidate() ||
@@ -3521,7 +4239,7 @@ void MarkCompactCollector::EvacuatePages(
                   MemoryChunk::kCompactingInProgress);
         if (EvacuateLiveObjectsFromPage(
                 p, compaction_spaces->Get(p->owner()->identity()),
-                evacuation_slots_buffer)) {
+                evacuation_slots_buffer, object_stats.get())) {
           p->parallel_compaction_state().SetValue(
               MemoryChunk::kCompactingFinalize);
         } else {
@@ -3535,6 +4253,9 @@ void MarkCompactCollector::EvacuatePages(
       }
     }
   }
+  if (!object_stats.is_empty()) {
+    heap()->object_stats_sample()->MergeSynchronized(object_stats.get());
+  }
 }
 
 
@@ -3574,6 +4295,34 @@ static intptr_t Free(PagedSpace* space, FreeList* free_list, Address start,
 }
 
 
+// Live objects are recorded while sweeping if object statistics are sampled.
+// One instance collects the objects of all pages swept by one sweeper and
+// merges them into the sample of the heap when it goes out of scope.
+class SweepingObjectStats {
+ public:
+  explicit SweepingObjectStats(Heap* heap) : heap_(heap) {
+    if (heap->mark_compact_collector()->sampling_object_stats()) {
+      object_stats_.Reset(new ObjectStats(heap, true));
+      object_stats_->ClearObjectStats(true);
+    }
+  }
+
+  ~SweepingObjectStats() {
+    if (!object_stats_.is_empty()) {
+      heap_->object_stats_sample()->MergeSynchronized(object_stats_.get());
+    }
+  }
+
+  ObjectStats* get() { return object_stats_.get(); }
+
+ private:
+  Heap* heap_;
+  base::SmartPointer<ObjectStats> object_stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(SweepingObjectStats);
+};
+
+
 // Sweeps a page. After sweeping the page can be iterated.
 // Slots in live objects pointing into evacuation candidates are updated
 // if requested.
@@ -3583,7 +4332,7 @@ template <SweepingMode sweeping_mode,
           SkipListRebuildingMode skip_list_mode,
           FreeSpaceTreatmentMode free_space_mode>
 static int Sweep(PagedSpace* space, FreeList* free_list, Page* p,
-                 ObjectVisitor* v) {
+                 ObjectVisitor* v, ObjectStats* object_stats) {
   DCHECK(!p->IsEvacuationCandidate() && !p->WasSwept());
   DCHECK_EQ(skip_list_mode == REBUILD_SKIP_LIST,
             space->identity() == CODE_SPACE);
@@ -3603,6 +4352,9 @@ static int Sweep(PagedSpace* space, FreeList* free_list, Page* p,
     skip_list->Clear();
   }
 
+  // Backing stores of unmarked ArrayBuffers on the page can be freed as well.
+  space->heap()->array_buffer_tracker()->FreeDeadOnPage(p);
+
   intptr_t freed_bytes = 0;
   intptr_t max_freed_bytes = 0;
   int curr_region = -1;
@@ -3629,6 +4381,9 @@ static int Sweep(PagedSpace* space, FreeList* free_list, Page* p,
       if (sweeping_mode == SWEEP_AND_VISIT_LIVE_OBJECTS) {
         live_object->IterateBody(map->instance_type(), size, v);
       }
+      if (object_stats != NULL) {
+        object_stats->RecordObject(live_object, map, size);
+      }
       if ((skip_list_mode == REBUILD_SKIP_LIST) && skip_list != NULL) {
         int new_region_start = SkipList::RegionNumber(free_end);
         int new_region_end =
@@ -3702,6 +4457,8 @@ void MarkCompactCollector::RemoveObjectSlots(Address start_slot,
                                      end_slot);
     }
   }
+  RememberedSet<OLD_TO_OLD>::RemoveRange(MemoryChunk::FromAddress(start_slot),
+                                         start_slot, end_slot);
 }
 
 
@@ -3725,7 +4482,10 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
   {
     GCTracer::Scope gc_scope(heap()->tracer(),
                              GCTracer::Scope::MC_UPDATE_POINTERS_TO_EVACUATED);
-    UpdateSlotsRecordedIn(migration_slots_buffer_);
+    // Updates the slots buffers of the evacuation candidates and the
+    // remembered sets as well. This has to be done after evacuation of all
+    // pages finishes.
+    UpdatePointersInParallel();
     if (FLAG_trace_fragmentation_verbose) {
       PrintF("  migration slots buffer: %d\n",
              SlotsBuffer::SizeOfChain(migration_slots_buffer_));
@@ -3733,12 +4493,9 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
     slots_buffer_allocator_->DeallocateChain(&migration_slots_buffer_);
     DCHECK(migration_slots_buffer_ == NULL);
 
-    // TODO(hpayer): Process the slots buffers in parallel. This has to be done
-    // after evacuation of all pages finishes.
     int buffers = evacuation_slots_buffers_.length();
     for (int i = 0; i < buffers; i++) {
       SlotsBuffer* buffer = evacuation_slots_buffers_[i];
-      UpdateSlotsRecordedIn(buffer);
       slots_buffer_allocator_->DeallocateChain(&buffer);
     }
     evacuation_slots_buffers_.Rewind(0);
@@ -3767,26 +4524,18 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
     heap_->IterateRoots(&updating_visitor, VISIT_ALL_IN_SWEEP_NEWSPACE);
   }
 
-  {
-    GCTracer::Scope gc_scope(heap()->tracer(),
-                             GCTracer::Scope::MC_UPDATE_OLD_TO_NEW_POINTERS);
-    StoreBufferRebuildScope scope(heap_, heap_->store_buffer(),
-                                  &Heap::ScavengeStoreBufferCallback);
-    heap_->store_buffer()->IteratePointersToNewSpace(&UpdatePointer);
-  }
-
   int npages = evacuation_candidates_.length();
   {
     GCTracer::Scope gc_scope(
         heap()->tracer(),
         GCTracer::Scope::MC_UPDATE_POINTERS_BETWEEN_EVACUATED);
+    SweepingObjectStats object_stats(heap());
     for (int i = 0; i < npages; i++) {
       Page* p = evacuation_candidates_[i];
       DCHECK(p->IsEvacuationCandidate() ||
              p->IsFlagSet(Page::RESCAN_ON_EVACUATION));
 
       if (p->IsEvacuationCandidate()) {
-        UpdateSlotsRecordedIn(p->slots_buffer());
         if (FLAG_trace_fragmentation_verbose) {
           PrintF("  page %p slots buffer: %d\n", reinterpret_cast<void*>(p),
                  SlotsBuffer::SizeOfChain(p->slots_buffer()));
@@ -3818,18 +4567,18 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
         switch (space->identity()) {
           case OLD_SPACE:
             Sweep<SWEEP_AND_VISIT_LIVE_OBJECTS, SWEEP_ON_MAIN_THREAD,
-                  IGNORE_SKIP_LIST, IGNORE_FREE_SPACE>(space, NULL, p,
-                                                       &updating_visitor);
+                  IGNORE_SKIP_LIST, IGNORE_FREE_SPACE>(
+                space, NULL, p, &updating_visitor, object_stats.get());
             break;
           case CODE_SPACE:
             if (FLAG_zap_code_space) {
               Sweep<SWEEP_AND_VISIT_LIVE_OBJECTS, SWEEP_ON_MAIN_THREAD,
-                    REBUILD_SKIP_LIST, ZAP_FREE_SPACE>(space, NULL, p,
-                                                       &updating_visitor);
+                    REBUILD_SKIP_LIST, ZAP_FREE_SPACE>(
+                  space, NULL, p, &updating_visitor, object_stats.get());
             } else {
               Sweep<SWEEP_AND_VISIT_LIVE_OBJECTS, SWEEP_ON_MAIN_THREAD,
-                    REBUILD_SKIP_LIST, IGNORE_FREE_SPACE>(space, NULL, p,
-                                                          &updating_visitor);
+                    REBUILD_SKIP_LIST, IGNORE_FREE_SPACE>(
+                  space, NULL, p, &updating_visitor, object_stats.get());
             }
             break;
           default:
@@ -3845,9 +4594,15 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
 
   heap_->string_table()->Iterate(&updating_visitor);
 
-  // Update pointers from external string table.
-  heap_->UpdateReferencesInExternalStringTable(
-      &UpdateReferenceInExternalStringTableEntry);
+  // Update pointers from external string table. Old space entries only
+  // need a look if old space objects were moved at all.
+  if (evacuation_candidates_.length() > 0) {
+    heap_->UpdateReferencesInExternalStringTable(
+        &UpdateReferenceInExternalStringTableEntry);
+  } else {
+    heap_->UpdateNewSpaceReferencesInExternalStringTable(
+        &UpdateReferenceInExternalStringTableEntry);
+  }
 
   EvacuationWeakObjectRetainer evacuation_object_retainer;
   heap()->ProcessAllWeakReferences(&evacuation_object_retainer);
@@ -3879,7 +4634,6 @@ void MarkCompactCollector::ReleaseEvacuationCandidates() {
     if (!p->IsEvacuationCandidate()) continue;
     PagedSpace* space = static_cast<PagedSpace*>(p->owner());
     space->Free(p->area_start(), p->area_size());
-    p->set_scan_on_scavenge(false);
     p->ResetLiveBytes();
     CHECK(p->WasSwept());
     space->ReleasePage(p);
@@ -4287,24 +5041,51 @@ static inline int MarkWordToObjectStarts(uint32_t mark_bits, int* starts) {
 
 int MarkCompactCollector::SweepInParallel(PagedSpace* space,
                                           int required_freed_bytes) {
+  // Swept pages go into a private free list, which is handed over to the
+  // shared free list every few pages. The main thread can then refill from
+  // it while this task is still sweeping.
+  static const int kPagesPerPublish = 4;
   int max_freed = 0;
   int max_freed_overall = 0;
+  int unpublished_pages = 0;
+  FreeList* private_free_list = new FreeList(space);
+  SweepingObjectStats object_stats(heap());
   PageIterator it(space);
   while (it.has_next()) {
     Page* p = it.next();
-    max_freed = SweepInParallel(p, space);
+    max_freed =
+        SweepInParallel(p, space, private_free_list, object_stats.get());
     DCHECK(max_freed >= 0);
+    if (max_freed > 0 && ++unpublished_pages == kPagesPerPublish) {
+      SharedFreeList(space)->Publish(private_free_list);
+      private_free_list = new FreeList(space);
+      unpublished_pages = 0;
+    }
     if (required_freed_bytes > 0 && max_freed >= required_freed_bytes) {
-      return max_freed;
+      max_freed_overall = max_freed;
+      break;
     }
     max_freed_overall = Max(max_freed, max_freed_overall);
     if (p == space->end_of_unswept_pages()) break;
   }
+  SharedFreeList(space)->Publish(private_free_list);
   return max_freed_overall;
 }
 
 
 int MarkCompactCollector::SweepInParallel(Page* page, PagedSpace* space) {
+  FreeList* private_free_list = new FreeList(space);
+  SweepingObjectStats object_stats(heap());
+  int max_freed =
+      SweepInParallel(page, space, private_free_list, object_stats.get());
+  SharedFreeList(space)->Publish(private_free_list);
+  return max_freed;
+}
+
+
+int MarkCompactCollector::SweepInParallel(Page* page, PagedSpace* space,
+                                          FreeList* free_list,
+                                          ObjectStats* object_stats) {
   int max_freed = 0;
   if (page->TryLock()) {
     // If this page was already swept in the meantime, we can return here.
@@ -4314,31 +5095,38 @@ int MarkCompactCollector::SweepInParallel(Page* page, PagedSpace* space) {
       return 0;
     }
     page->parallel_sweeping_state().SetValue(MemoryChunk::kSweepingInProgress);
-    FreeList* free_list;
-    FreeList private_free_list(space);
-    if (space->identity() == OLD_SPACE) {
-      free_list = free_list_old_space_.get();
-      max_freed =
-          Sweep<SWEEP_ONLY, SWEEP_IN_PARALLEL, IGNORE_SKIP_LIST,
-                IGNORE_FREE_SPACE>(space, &private_free_list, page, NULL);
-    } else if (space->identity() == CODE_SPACE) {
-      free_list = free_list_code_space_.get();
+    if (space->identity() == CODE_SPACE) {
       max_freed =
           Sweep<SWEEP_ONLY, SWEEP_IN_PARALLEL, REBUILD_SKIP_LIST,
-                IGNORE_FREE_SPACE>(space, &private_free_list, page, NULL);
+                IGNORE_FREE_SPACE>(
+                    space, free_list, page, NULL, object_stats);
     } else {
-      free_list = free_list_map_space_.get();
       max_freed =
           Sweep<SWEEP_ONLY, SWEEP_IN_PARALLEL, IGNORE_SKIP_LIST,
-                IGNORE_FREE_SPACE>(space, &private_free_list, page, NULL);
+                IGNORE_FREE_SPACE>(
+                    space, free_list, page, NULL, object_stats);
     }
-    free_list->Concatenate(&private_free_list);
     page->mutex()->Unlock();
   }
   return max_freed;
 }
 
 
+FreeList* MarkCompactCollector::SharedFreeList(PagedSpace* space) {
+  switch (space->identity()) {
+    case OLD_SPACE:
+      return free_list_old_space_.get();
+    case CODE_SPACE:
+      return free_list_code_space_.get();
+    case MAP_SPACE:
+      return free_list_map_space_.get();
+    default:
+      UNREACHABLE();
+  }
+  return NULL;
+}
+
+
 void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
   space->ClearStats();
 
@@ -4347,6 +5135,7 @@ void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
   space->set_end_of_unswept_pages(space->FirstPage());
 
   PageIterator it(space);
+  SweepingObjectStats object_stats(heap());
 
   int pages_swept = 0;
   bool unused_page_present = false;
@@ -4389,14 +5178,15 @@ void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
           if (space->identity() == CODE_SPACE) {
             if (FLAG_zap_code_space) {
               Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, REBUILD_SKIP_LIST,
-                    ZAP_FREE_SPACE>(space, NULL, p, NULL);
+                    ZAP_FREE_SPACE>(space, NULL, p, NULL, object_stats.get());
             } else {
               Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, REBUILD_SKIP_LIST,
-                    IGNORE_FREE_SPACE>(space, NULL, p, NULL);
+                    IGNORE_FREE_SPACE>(space, NULL, p, NULL,
+                                       object_stats.get());
             }
           } else {
             Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, IGNORE_SKIP_LIST,
-                  IGNORE_FREE_SPACE>(space, NULL, p, NULL);
+                  IGNORE_FREE_SPACE>(space, NULL, p, NULL, object_stats.get());
           }
           pages_swept++;
           parallel_sweeping_active = true;
@@ -4418,14 +5208,14 @@ void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
         if (space->identity() == CODE_SPACE) {
           if (FLAG_zap_code_space) {
             Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, REBUILD_SKIP_LIST,
-                  ZAP_FREE_SPACE>(space, NULL, p, NULL);
+                  ZAP_FREE_SPACE>(space, NULL, p, NULL, object_stats.get());
           } else {
             Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, REBUILD_SKIP_LIST,
-                  IGNORE_FREE_SPACE>(space, NULL, p, NULL);
+                  IGNORE_FREE_SPACE>(space, NULL, p, NULL, object_stats.get());
           }
         } else {
           Sweep<SWEEP_ONLY, SWEEP_ON_MAIN_THREAD, IGNORE_SKIP_LIST,
-                IGNORE_FREE_SPACE>(space, NULL, p, NULL);
+                IGNORE_FREE_SPACE>(space, NULL, p, NULL, object_stats.get());
         }
         pages_swept++;
         break;
@@ -4452,6 +5242,11 @@ void MarkCompactCollector::SweepSpaces() {
   state_ = SWEEP_SPACES;
 #endif
 
+  sampling_object_stats_ = heap()->object_stats_sampling();
+  if (sampling_object_stats_) {
+    heap()->object_stats_sample()->ClearObjectStats();
+  }
+
   MoveEvacuationCandidatesToEndOfPagesList();
 
   {
@@ -4485,17 +5280,18 @@ void MarkCompactCollector::SweepSpaces() {
 
   EvacuateNewSpaceAndCandidates();
 
-  // EvacuateNewSpaceAndCandidates iterates over new space objects and for
-  // ArrayBuffers either re-registers them as live or promotes them. This is
-  // needed to properly free them.
-  heap()->array_buffer_tracker()->FreeDead(false);
-
   // Clear the marking state of live large objects.
   heap_->lo_space()->ClearMarkingStateOfLiveObjects();
 
   // Deallocate evacuated candidate pages.
   ReleaseEvacuationCandidates();
 
+  // EvacuateNewSpaceAndCandidates iterates over new space objects and for
+  // ArrayBuffers either re-registers them as live or promotes them. This is
+  // needed to properly free them. Backing stores found dead on pages swept
+  // or released so far are freed along with them.
+  heap()->array_buffer_tracker()->FreeDeadInNewSpace();
+
   if (FLAG_print_cumulative_gc_stat) {
     heap_->tracer()->AddSweepingTime(base::OS::TimeCurrentMillis() -
                                      start_time);
@@ -4564,8 +5360,10 @@ Isolate* MarkCompactCollector::isolate() const { return heap_->isolate(); }
 
 
 void MarkCompactCollector::Initialize() {
-  MarkCompactMarkingVisitor::Initialize();
+  MarkCompactMarkingVisitor<MarkBit::NON_ATOMIC>::Initialize();
+  MarkCompactMarkingVisitor<MarkBit::ATOMIC>::Initialize();
   IncrementalMarking::Initialize();
+  ParallelMarking::Initialize();
 }
 
 
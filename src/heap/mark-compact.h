@@ -5,6 +5,8 @@
 #ifndef V8_HEAP_MARK_COMPACT_H_
 #define V8_HEAP_MARK_COMPACT_H_
 
+#include <vector>
+
 #include "src/base/bits.h"
 #include "src/heap/spaces.h"
 
@@ -23,6 +25,8 @@ typedef void (*MarkObjectFunction)(Heap* heap, HeapObject* object);
 class CodeFlusher;
 class MarkCompactCollector;
 class MarkingVisitor;
+class ObjectStats;
+class ParallelMarking;
 class RootMarkingVisitor;
 class SlotsBuffer;
 class SlotsBufferAllocator;
@@ -68,55 +72,82 @@ class Marking : public AllStatic {
   // objects.
   INLINE(static bool IsBlackOrGrey(MarkBit mark_bit)) { return mark_bit.Get(); }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void MarkBlack(MarkBit mark_bit)) {
-    mark_bit.Set();
-    mark_bit.Next().Clear();
+    mark_bit.Set<mode>();
+    mark_bit.Next().Clear<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void MarkWhite(MarkBit mark_bit)) {
-    mark_bit.Clear();
-    mark_bit.Next().Clear();
+    mark_bit.Clear<mode>();
+    mark_bit.Next().Clear<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void BlackToWhite(MarkBit markbit)) {
     DCHECK(IsBlack(markbit));
-    markbit.Clear();
+    markbit.Clear<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void GreyToWhite(MarkBit markbit)) {
     DCHECK(IsGrey(markbit));
-    markbit.Clear();
-    markbit.Next().Clear();
+    markbit.Clear<mode>();
+    markbit.Next().Clear<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void BlackToGrey(MarkBit markbit)) {
     DCHECK(IsBlack(markbit));
-    markbit.Next().Set();
+    markbit.Next().Set<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void WhiteToGrey(MarkBit markbit)) {
     DCHECK(IsWhite(markbit));
-    markbit.Set();
-    markbit.Next().Set();
+    markbit.Set<mode>();
+    markbit.Next().Set<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void WhiteToBlack(MarkBit markbit)) {
     DCHECK(IsWhite(markbit));
-    markbit.Set();
+    markbit.Set<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void GreyToBlack(MarkBit markbit)) {
     DCHECK(IsGrey(markbit));
-    markbit.Next().Clear();
+    markbit.Next().Clear<mode>();
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void BlackToGrey(HeapObject* obj)) {
-    BlackToGrey(MarkBitFrom(obj));
+    BlackToGrey<mode>(MarkBitFrom(obj));
   }
 
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(static void AnyToGrey(MarkBit markbit)) {
-    markbit.Set();
-    markbit.Next().Set();
+    markbit.Set<mode>();
+    markbit.Next().Set<mode>();
+  }
+
+  // The following transitions race with the concurrent marker. They claim
+  // the object by atomically updating a single mark bit and return false if
+  // the object was not in the expected color.
+  INLINE(static bool WhiteToGreyAtomic(MarkBit markbit)) {
+    if (!markbit.SetAtomic()) return false;
+    markbit.Next().SetAtomic();
+    return true;
+  }
+
+  INLINE(static bool WhiteToBlackAtomic(MarkBit markbit)) {
+    return markbit.SetAtomic();
+  }
+
+  INLINE(static bool GreyToBlackAtomic(MarkBit markbit)) {
+    return markbit.Next().ClearAtomic();
   }
 
   static void TransferMark(Heap* heap, Address old_start, Address new_start);
@@ -195,6 +226,8 @@ class MarkingDeque {
 
   inline bool IsEmpty() { return top_ == bottom_; }
 
+  inline int Size() { return (top_ - bottom_) & mask_; }
+
   bool overflowed() const { return overflowed_; }
 
   bool in_use() const { return in_use_; }
@@ -351,6 +384,18 @@ class MarkCompactCollector {
 
   void CollectEvacuationCandidates(PagedSpace* space);
 
+  typedef std::pair<int, Page*> LiveBytesPagePair;
+
+  // Selects the pages of |space| that free the most memory within the
+  // predicted evacuation time budget. Pages are scored by their free memory,
+  // weighted by how badly it is fragmented over the free list categories,
+  // per byte of live objects to move. The selected pages are moved to the
+  // front of |pages| and their number is returned.
+  int SelectEvacuationCandidatesByScore(PagedSpace* space,
+                                        std::vector<LiveBytesPagePair>* pages,
+                                        bool reduce_memory,
+                                        int* total_live_bytes);
+
   void AddEvacuationCandidate(Page* p);
 
   // Prepares for GC by resetting relocation info in old and map spaces and
@@ -424,7 +469,6 @@ class MarkCompactCollector {
                               Object* target));
 
   void UpdateSlots(SlotsBuffer* buffer);
-  void UpdateSlotsRecordedIn(SlotsBuffer* buffer);
 
   void MigrateObject(HeapObject* dst, HeapObject* src, int size,
                      AllocationSpace to_old_space,
@@ -438,6 +482,13 @@ class MarkCompactCollector {
 
   bool TryPromoteObject(HeapObject* object, int object_size);
 
+  // Records the slots of an object that has been copied to old space without
+  // going through MigrateObject.
+  void RecordMigratedSlotsInObject(HeapObject* dst, int size,
+                                   SlotsBuffer** evacuation_slots_buffer);
+  void RecordMigratedSlotsInMixedObject(HeapObject* dst, int size,
+                                        SlotsBuffer** evacuation_slots_buffer);
+
   void InvalidateCode(Code* code);
 
   void ClearMarkbits();
@@ -469,10 +520,18 @@ class MarkCompactCollector {
   // Checks if sweeping is in progress right now on any space.
   bool sweeping_in_progress() { return sweeping_in_progress_; }
 
+  bool sampling_object_stats() { return sampling_object_stats_; }
+
   void set_evacuation(bool evacuation) { evacuation_ = evacuation; }
 
   bool evacuation() const { return evacuation_; }
 
+  // Size of the objects marked by background parallel marking tasks in the
+  // current or last full GC.
+  intptr_t parallel_marking_background_bytes() const {
+    return parallel_marking_background_bytes_;
+  }
+
   // Special case for processing weak references in a full collection. We need
   // to artificially keep AllocationSites alive for a time.
   void MarkAllocationSite(AllocationSite* site);
@@ -526,11 +585,23 @@ class MarkCompactCollector {
 
  private:
   class CompactionTask;
+  class PointersUpdatingTask;
+  class PointersUpdatingWork;
+  class WeakClearingTask;
+  class WeakClearingWork;
   class SweeperTask;
 
   explicit MarkCompactCollector(Heap* heap);
   ~MarkCompactCollector();
 
+  // Sweeps a given page into {free_list} and records its live objects in
+  // {object_stats} unless it is NULL. Both are private to the caller.
+  int SweepInParallel(Page* page, PagedSpace* space, FreeList* free_list,
+                      ObjectStats* object_stats);
+
+  // Returns the free list that sweeping fills for {space}.
+  FreeList* SharedFreeList(PagedSpace* space);
+
   bool WillBeDeoptimized(Code* code);
   void EvictPopularEvacuationCandidate(Page* page);
   void ClearInvalidStoreAndSlotsBufferEntries();
@@ -575,11 +646,14 @@ class MarkCompactCollector {
   //   After: Live objects are marked and non-live objects are unmarked.
 
   friend class CodeMarkingVisitor;
+  template <MarkBit::AccessMode>
   friend class MarkCompactMarkingVisitor;
   friend class MarkingVisitor;
   friend class RootMarkingVisitor;
   friend class SharedFunctionInfoMarkingVisitor;
+  template <MarkBit::AccessMode>
   friend class IncrementalMarkingMarkingVisitor;
+  friend class ParallelMarking;
 
   // Mark code objects that are active on the stack to prevent them
   // from being flushed.
@@ -592,22 +666,41 @@ class MarkCompactCollector {
 
   void AfterMarking();
 
+  // The following marking operations take the mark bit access mode as a
+  // template parameter. Mark bits are only updated atomically while parallel
+  // marking tasks are running, see ParallelMarking.
+
   // Pushes a black object onto the marking stack and accounts for live bytes.
   // Note that this assumes live bytes have not yet been counted.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(void PushBlack(HeapObject* obj));
 
   // Unshifts a black object into the marking stack and accounts for live bytes.
   // Note that this assumes lives bytes have already been counted.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(void UnshiftBlack(HeapObject* obj));
 
   // Marks the object black and pushes it on the marking stack.
   // This is for non-incremental marking only.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(void MarkObject(HeapObject* obj, MarkBit mark_bit));
 
-  // Marks the object black assuming that it is not yet marked.
+  // Marks the object black assuming that it is not yet marked. Parallel
+  // marking tasks may have claimed it in the meantime though.
   // This is for non-incremental marking only.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
   INLINE(void SetMark(HeapObject* obj, MarkBit mark_bit));
 
+  // Returns true if the marking deque is emptied by parallel marking tasks.
+  bool UseParallelMarking() {
+    return FLAG_parallel_marking && !FLAG_track_gc_object_stats;
+  }
+
+  // Parallel marking tasks are only started once the marking deque holds
+  // at least this many objects. Smaller amounts of work are not worth the
+  // synchronization.
+  static const int kMinMarkingDequeSizeForParallelMarking = 1024;
+
   // Mark the heap roots and all objects reachable from them.
   void MarkRoots(RootMarkingVisitor* visitor);
 
@@ -643,6 +736,11 @@ class MarkCompactCollector {
   // overflow flag will be set.
   void EmptyMarkingDeque();
 
+  // Marks the map of a black object and visits its body, pushing the objects
+  // it references on the marking stack.
+  template <MarkBit::AccessMode mode = MarkBit::NON_ATOMIC>
+  void VisitObjectBody(HeapObject* object);
+
   // Refill the marking stack with overflowed objects from the heap.  This
   // function either leaves the marking stack full or clears the overflow
   // flag on the marking stack.
@@ -676,11 +774,21 @@ class MarkCompactCollector {
   // the marking stack.
   void ProcessWeakCollections();
 
+  // Like ProcessWeakCollections followed by ProcessMarkingDeque, but reaches
+  // the fixpoint in time linear in the number of entries: values of entries
+  // with unmarked keys are marked as soon as their key gets marked. Returns
+  // true if any object was marked.
+  bool ProcessWeakCollectionsLinear();
+
   // After all reachable objects have been marked those weak map entries
   // with an unreachable key are removed from all encountered weak maps.
   // The linked list of all encountered weak maps is destroyed.
   void ClearWeakCollections();
 
+  // Removes the entries with unmarked keys from the table of a weak
+  // collection.
+  static void ClearDeadWeakCollectionEntries(ObjectHashTable* table);
+
   // We have to remove all encountered weak maps from the list of weak
   // collections when incremental marking is aborted.
   void AbortWeakCollections();
@@ -689,6 +797,15 @@ class MarkCompactCollector {
   void ProcessAndClearWeakCells();
   void AbortWeakCells();
 
+  // Clears |weak_cell| if its value is dead, or records its slot otherwise.
+  void ProcessWeakCell(WeakCell* weak_cell);
+
+  // Does the work of ProcessAndClearWeakCells and ClearWeakCollections with
+  // parallel tasks. Only slots and resurrected cells are handled on the main
+  // thread.
+  void ClearWeakReferencesInParallel();
+  int NumberOfWeakProcessingTasks(int work_items);
+
   // -----------------------------------------------------------------------
   // Phase 2: Sweeping to clear mark bits and free non-live objects for
   // a non-compacting collection.
@@ -708,10 +825,24 @@ class MarkCompactCollector {
   int DiscoverAndEvacuateBlackObjectsOnPage(NewSpace* new_space,
                                             NewSpacePage* p);
 
+  // Returns true if the live objects of the new space page should be
+  // promoted to old space with a single copy instead of one by one. This is
+  // the only place that checks the live bytes threshold.
+  bool ShouldPromotePage(NewSpacePage* p, Address age_mark);
+
+  // Copies the range spanned by the live objects of the page to old space in
+  // one go and turns the dead objects in between into fillers. Returns false
+  // without moving anything if old space has no room for the range.
+  // Semispace pages are carved out of one contiguous reservation that
+  // InNewSpace checks by address, so they cannot be relinked into old space.
+  bool TryPromotePage(NewSpacePage* p, int* survivors_size);
+
   void EvacuateNewSpace();
 
+  // Live objects are recorded in |object_stats| unless it is null.
   bool EvacuateLiveObjectsFromPage(Page* p, PagedSpace* target_space,
-                                   SlotsBuffer** evacuation_slots_buffer);
+                                   SlotsBuffer** evacuation_slots_buffer,
+                                   ObjectStats* object_stats);
 
   void AddEvacuationSlotsBufferSynchronized(
       SlotsBuffer* evacuation_slots_buffer);
@@ -726,6 +857,17 @@ class MarkCompactCollector {
 
   void WaitUntilCompactionCompleted();
 
+  // Updates the slots recorded in slots buffers and remembered sets to point
+  // to the new locations of evacuated objects. The work is split into one
+  // item per slots buffer and per chunk and shared by the main thread and
+  // --pointer-update-tasks background tasks.
+  void UpdatePointersInParallel();
+
+  // The number of parallel pointer updating tasks, including the main thread.
+  int NumberOfPointersUpdatingTasks(int work_items);
+
+  void UpdatePointersInChunk(MemoryChunk* chunk);
+
   void EvacuateNewSpaceAndCandidates();
 
   void ReleaseEvacuationCandidates();
@@ -767,6 +909,10 @@ class MarkCompactCollector {
   size_t marking_deque_memory_committed_;
   MarkingDeque marking_deque_;
   CodeFlusher* code_flusher_;
+
+  // Set up once per GC in MarkLiveObjects if parallel marking is used.
+  base::SmartPointer<ParallelMarking> parallel_marking_;
+  intptr_t parallel_marking_background_bytes_;
   bool have_code_to_deoptimize_;
 
   List<Page*> evacuation_candidates_;
@@ -790,16 +936,20 @@ class MarkCompactCollector {
   // True if concurrent or parallel sweeping is currently in progress.
   bool sweeping_in_progress_;
 
+  // True if the sweeper samples object statistics for the current cycle.
+  bool sampling_object_stats_;
+
   // True if parallel compaction is currently in progress.
   bool compaction_in_progress_;
 
   // Semaphore used to synchronize sweeper tasks.
   base::Semaphore pending_sweeper_tasks_semaphore_;
 
-  // Semaphore used to synchronize compaction tasks.
+  // Semaphore used to synchronize compaction and pointer updating tasks.
   base::Semaphore pending_compaction_tasks_semaphore_;
 
-  // Number of active compaction tasks (including main thread).
+  // Number of active compaction or pointer updating tasks (including main
+  // thread).
   intptr_t concurrent_compaction_tasks_active_;
 
   friend class Heap;
@@ -135,113 +135,117 @@ void ObjectStats::CheckpointObjectStats() {
 Isolate* ObjectStats::isolate() { return heap()->isolate(); }
 
 
-void ObjectStatsVisitor::CountFixedArray(
-    FixedArrayBase* fixed_array, FixedArraySubInstanceType fast_type,
-    FixedArraySubInstanceType dictionary_type) {
-  Heap* heap = fixed_array->map()->GetHeap();
-  if (fixed_array->map() != heap->fixed_cow_array_map() &&
-      fixed_array->map() != heap->fixed_double_array_map() &&
-      fixed_array != heap->empty_fixed_array()) {
-    if (fixed_array->IsDictionary()) {
-      heap->object_stats_->RecordFixedArraySubTypeStats(dictionary_type,
-                                                        fixed_array->Size());
-    } else {
-      heap->object_stats_->RecordFixedArraySubTypeStats(fast_type,
-                                                        fixed_array->Size());
-    }
-  }
+void ObjectStats::CheckpointSample() {
+  base::LockGuard<base::Mutex> lock_guard(object_stats_mutex.Pointer());
+  MemCopy(object_counts_last_time_, object_counts_, sizeof(object_counts_));
+  MemCopy(object_sizes_last_time_, object_sizes_, sizeof(object_sizes_));
+  ClearObjectStats();
 }
 
 
-void ObjectStatsVisitor::VisitBase(VisitorId id, Map* map, HeapObject* obj) {
-  Heap* heap = map->GetHeap();
-  int object_size = obj->Size();
-  heap->object_stats_->RecordObjectStats(map->instance_type(), object_size);
-  table_.GetVisitorById(id)(map, obj);
-  if (obj->IsJSObject()) {
-    JSObject* object = JSObject::cast(obj);
-    CountFixedArray(object->elements(), DICTIONARY_ELEMENTS_SUB_TYPE,
-                    FAST_ELEMENTS_SUB_TYPE);
-    CountFixedArray(object->properties(), DICTIONARY_PROPERTIES_SUB_TYPE,
-                    FAST_PROPERTIES_SUB_TYPE);
+void ObjectStats::MergeSynchronized(ObjectStats* other) {
+  base::LockGuard<base::Mutex> lock_guard(object_stats_mutex.Pointer());
+  for (int i = 0; i < OBJECT_STATS_COUNT; i++) {
+    object_counts_[i] += other->object_counts_[i];
+    object_sizes_[i] += other->object_sizes_[i];
   }
 }
 
 
-template <ObjectStatsVisitor::VisitorId id>
-void ObjectStatsVisitor::Visit(Map* map, HeapObject* obj) {
-  VisitBase(id, map, obj);
+bool ObjectStats::CanInspect(Object* obj) {
+  return !sampling_ || !heap_->InNewSpace(obj);
+}
+
+
+void ObjectStats::RecordFixedArrayHelper(
+    FixedArrayBase* fixed_array, FixedArraySubInstanceType fast_type,
+    FixedArraySubInstanceType dictionary_type) {
+  if (!CanInspect(fixed_array)) return;
+  if (fixed_array->map() != heap_->fixed_cow_array_map() &&
+      fixed_array->map() != heap_->fixed_double_array_map() &&
+      fixed_array != heap_->empty_fixed_array()) {
+    if (fixed_array->IsDictionary()) {
+      RecordFixedArraySubTypeStats(dictionary_type, fixed_array->Size());
+    } else {
+      RecordFixedArraySubTypeStats(fast_type, fixed_array->Size());
+    }
+  }
 }
 
 
-template <>
-void ObjectStatsVisitor::Visit<ObjectStatsVisitor::kVisitMap>(Map* map,
-                                                              HeapObject* obj) {
-  Heap* heap = map->GetHeap();
-  Map* map_obj = Map::cast(obj);
-  DCHECK(map->instance_type() == MAP_TYPE);
+void ObjectStats::RecordMapDetails(Map* map_obj) {
+  // Each field is read once, as the mutator may change it while sampling.
   DescriptorArray* array = map_obj->instance_descriptors();
-  if (map_obj->owns_descriptors() && array != heap->empty_descriptor_array()) {
-    int fixed_array_size = array->Size();
-    heap->object_stats_->RecordFixedArraySubTypeStats(DESCRIPTOR_ARRAY_SUB_TYPE,
-                                                      fixed_array_size);
+  if (map_obj->owns_descriptors() && array != heap_->empty_descriptor_array() &&
+      CanInspect(array)) {
+    RecordFixedArraySubTypeStats(DESCRIPTOR_ARRAY_SUB_TYPE, array->Size());
   }
-  if (TransitionArray::IsFullTransitionArray(map_obj->raw_transitions())) {
-    int fixed_array_size =
-        TransitionArray::cast(map_obj->raw_transitions())->Size();
-    heap->object_stats_->RecordFixedArraySubTypeStats(TRANSITION_ARRAY_SUB_TYPE,
-                                                      fixed_array_size);
+  Object* transitions = map_obj->raw_transitions();
+  if (CanInspect(transitions) &&
+      TransitionArray::IsFullTransitionArray(transitions)) {
+    RecordFixedArraySubTypeStats(TRANSITION_ARRAY_SUB_TYPE,
+                                 TransitionArray::cast(transitions)->Size());
   }
-  if (map_obj->has_code_cache()) {
-    CodeCache* cache = CodeCache::cast(map_obj->code_cache());
-    heap->object_stats_->RecordFixedArraySubTypeStats(
-        MAP_CODE_CACHE_SUB_TYPE, cache->default_cache()->Size());
-    if (!cache->normal_type_cache()->IsUndefined()) {
-      heap->object_stats_->RecordFixedArraySubTypeStats(
+  Object* code_cache = map_obj->code_cache();
+  if (code_cache != heap_->empty_fixed_array() && CanInspect(code_cache)) {
+    CodeCache* cache = CodeCache::cast(code_cache);
+    FixedArray* default_cache = cache->default_cache();
+    if (CanInspect(default_cache)) {
+      RecordFixedArraySubTypeStats(MAP_CODE_CACHE_SUB_TYPE,
+                                   default_cache->Size());
+    }
+    Object* normal_type_cache = cache->normal_type_cache();
+    if (CanInspect(normal_type_cache) && !normal_type_cache->IsUndefined()) {
+      RecordFixedArraySubTypeStats(
           MAP_CODE_CACHE_SUB_TYPE,
-          FixedArray::cast(cache->normal_type_cache())->Size());
+          FixedArray::cast(normal_type_cache)->Size());
     }
   }
-  VisitBase(kVisitMap, map, obj);
-}
-
-
-template <>
-void ObjectStatsVisitor::Visit<ObjectStatsVisitor::kVisitCode>(
-    Map* map, HeapObject* obj) {
-  Heap* heap = map->GetHeap();
-  int object_size = obj->Size();
-  DCHECK(map->instance_type() == CODE_TYPE);
-  Code* code_obj = Code::cast(obj);
-  heap->object_stats_->RecordCodeSubTypeStats(code_obj->kind(),
-                                              code_obj->GetAge(), object_size);
-  VisitBase(kVisitCode, map, obj);
 }
 
 
-template <>
-void ObjectStatsVisitor::Visit<ObjectStatsVisitor::kVisitSharedFunctionInfo>(
-    Map* map, HeapObject* obj) {
-  Heap* heap = map->GetHeap();
-  SharedFunctionInfo* sfi = SharedFunctionInfo::cast(obj);
-  if (sfi->scope_info() != heap->empty_fixed_array()) {
-    heap->object_stats_->RecordFixedArraySubTypeStats(
-        SCOPE_INFO_SUB_TYPE, FixedArray::cast(sfi->scope_info())->Size());
+void ObjectStats::RecordObject(HeapObject* obj, Map* map, int size) {
+  InstanceType type = map->instance_type();
+  RecordObjectStats(type, size);
+  switch (type) {
+    case MAP_TYPE:
+      RecordMapDetails(Map::cast(obj));
+      break;
+    case CODE_TYPE: {
+      Code* code_obj = Code::cast(obj);
+      RecordCodeSubTypeStats(code_obj->kind(), code_obj->GetAge(), size);
+      break;
+    }
+    case SHARED_FUNCTION_INFO_TYPE: {
+      Object* scope_info = SharedFunctionInfo::cast(obj)->scope_info();
+      if (scope_info != heap_->empty_fixed_array() && CanInspect(scope_info)) {
+        RecordFixedArraySubTypeStats(SCOPE_INFO_SUB_TYPE,
+                                     FixedArray::cast(scope_info)->Size());
+      }
+      break;
+    }
+    case FIXED_ARRAY_TYPE:
+      if (obj == heap_->string_table()) {
+        RecordFixedArraySubTypeStats(STRING_TABLE_SUB_TYPE, size);
+      }
+      break;
+    default:
+      break;
+  }
+  if (obj->IsJSObject()) {
+    JSObject* object = JSObject::cast(obj);
+    RecordFixedArrayHelper(object->elements(), FAST_ELEMENTS_SUB_TYPE,
+                           DICTIONARY_ELEMENTS_SUB_TYPE);
+    RecordFixedArrayHelper(object->properties(), FAST_PROPERTIES_SUB_TYPE,
+                           DICTIONARY_PROPERTIES_SUB_TYPE);
   }
-  VisitBase(kVisitSharedFunctionInfo, map, obj);
 }
 
 
-template <>
-void ObjectStatsVisitor::Visit<ObjectStatsVisitor::kVisitFixedArray>(
-    Map* map, HeapObject* obj) {
-  Heap* heap = map->GetHeap();
-  FixedArray* fixed_array = FixedArray::cast(obj);
-  if (fixed_array == heap->string_table()) {
-    heap->object_stats_->RecordFixedArraySubTypeStats(STRING_TABLE_SUB_TYPE,
-                                                      fixed_array->Size());
-  }
-  VisitBase(kVisitFixedArray, map, obj);
+template <ObjectStatsVisitor::VisitorId id>
+void ObjectStatsVisitor::Visit(Map* map, HeapObject* obj) {
+  map->GetHeap()->object_stats_->RecordObject(obj, map, obj->Size());
+  table_.GetVisitorById(id)(map, obj);
 }
 
 
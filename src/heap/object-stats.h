@@ -14,7 +14,11 @@ namespace internal {
 
 class ObjectStats {
  public:
-  explicit ObjectStats(Heap* heap) : heap_(heap) {}
+  // Stats recorded concurrently with the mutator (|sampling| is true) skip
+  // sub type details held in new space, which a scavenge could move at any
+  // time.
+  explicit ObjectStats(Heap* heap, bool sampling = false)
+      : heap_(heap), sampling_(sampling) {}
 
   // ObjectStats are kept in two arrays, counts and sizes. Related stats are
   // stored in a contiguous linear buffer. Stats groups are stored one after
@@ -34,6 +38,18 @@ class ObjectStats {
   void TraceObjectStat(const char* name, int count, int size, double time);
   void CheckpointObjectStats();
 
+  // Makes the current stats the stats of the last GC without updating the
+  // counters. Used for the stats sampled while sweeping.
+  void CheckpointSample();
+
+  // Adds the current stats of |other| to the current stats. Can be called
+  // concurrently.
+  void MergeSynchronized(ObjectStats* other);
+
+  // Records a live object under its instance type and all sub types it
+  // accounts for.
+  void RecordObject(HeapObject* obj, Map* map, int size);
+
   void RecordObjectStats(InstanceType type, size_t size) {
     DCHECK(type <= LAST_TYPE);
     object_counts_[type]++;
@@ -72,7 +88,18 @@ class ObjectStats {
   Heap* heap() { return heap_; }
 
  private:
+  // Returns false for objects that must not be looked into, i.e. for new
+  // space objects while sampling.
+  bool CanInspect(Object* obj);
+
+  void RecordMapDetails(Map* map);
+
+  void RecordFixedArrayHelper(FixedArrayBase* fixed_array,
+                              FixedArraySubInstanceType fast_type,
+                              FixedArraySubInstanceType dictionary_type);
+
   Heap* heap_;
+  bool sampling_;
 
   // Object counts and used memory by InstanceType
   size_t object_counts_[OBJECT_STATS_COUNT];
@@ -86,12 +113,6 @@ class ObjectStatsVisitor : public StaticMarkingVisitor<ObjectStatsVisitor> {
  public:
   static void Initialize(VisitorDispatchTable<Callback>* original);
 
-  static void VisitBase(VisitorId id, Map* map, HeapObject* obj);
-
-  static void CountFixedArray(FixedArrayBase* fixed_array,
-                              FixedArraySubInstanceType fast_type,
-                              FixedArraySubInstanceType dictionary_type);
-
   template <VisitorId id>
   static inline void Visit(Map* map, HeapObject* obj);
 };
@@ -0,0 +1,520 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/heap/parallel-marking.h"
+
+#include <map>
+
+#include "src/base/sys-info.h"
+#include "src/heap/heap-inl.h"
+#include "src/heap/mark-compact-inl.h"
+#include "src/heap/objects-visiting-inl.h"
+#include "src/v8.h"
+
+namespace v8 {
+namespace internal {
+
+class ParallelMarking::Segment : public Malloced {
+ public:
+  static const int kCapacity = 64;
+
+  Segment() : next_(nullptr), size_(0) {}
+
+  bool IsEmpty() const { return size_ == 0; }
+  bool IsFull() const { return size_ == kCapacity; }
+  int size() const { return size_; }
+
+  void Push(HeapObject* object) {
+    DCHECK(!IsFull());
+    objects_[size_++] = object;
+  }
+
+  HeapObject* Pop() {
+    DCHECK(!IsEmpty());
+    return objects_[--size_];
+  }
+
+  Segment* next() const { return next_; }
+  void set_next(Segment* next) { next_ = next; }
+
+ private:
+  Segment* next_;
+  int size_;
+  HeapObject* objects_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(Segment);
+};
+
+
+// State of a single parallel marking task.
+class ParallelMarkingTaskState {
+ public:
+  ParallelMarkingTaskState(ParallelMarking* marking, bool is_main_thread)
+      : marking_(marking),
+        is_main_thread_(is_main_thread),
+        local_(new ParallelMarking::Segment()),
+        bailout_(new ParallelMarking::Segment()),
+        live_bytes_chunk_(nullptr),
+        live_bytes_in_chunk_(0),
+        bytes_marked_(0) {}
+
+  ~ParallelMarkingTaskState() {
+    DCHECK(local_->IsEmpty());
+    DCHECK(bailout_->IsEmpty());
+    delete local_;
+    delete bailout_;
+  }
+
+  // Adds a black object to the local segment. The segment is published when
+  // it is full, or earlier if other tasks are starving.
+  inline void Push(HeapObject* object);
+
+  // Pops an object from the local segment, stealing a published segment when
+  // the local one is empty. Returns false if no work was found.
+  inline bool Pop(HeapObject** object);
+
+  // Visits the body of a black object. Returns false if the object has to be
+  // visited on the main thread.
+  bool VisitObject(HeapObject* object);
+
+  // Hands an object over to the main thread.
+  void BailOut(HeapObject* object);
+
+  // Publishes pending bailouts. Must be called before the task goes idle.
+  void FlushBailouts();
+
+  inline void VisitPointers(HeapObject* host, Object** start, Object** end);
+
+  // Accounts live bytes and records slots on the main thread.
+  void PublishResults(Heap* heap);
+
+  bool is_main_thread() const { return is_main_thread_; }
+  intptr_t bytes_marked() const { return bytes_marked_; }
+
+  static inline ParallelMarkingTaskState* Current();
+  static inline void SetCurrent(ParallelMarkingTaskState* state);
+  static void Initialize();
+
+ private:
+  struct RecordedSlot {
+    HeapObject* host;
+    Object** slot;
+  };
+
+  // Objects are shared early if the local segment has at least this many
+  // objects and some task is idle.
+  static const int kMinSegmentSizeToShare = 8;
+
+  inline void MarkObject(HeapObject* object);
+
+  // Moves the live bytes counted for the current chunk into live_bytes_.
+  void FlushLiveBytes();
+
+  ParallelMarking* marking_;
+  bool is_main_thread_;
+  ParallelMarking::Segment* local_;
+  ParallelMarking::Segment* bailout_;
+  List<RecordedSlot> recorded_slots_;
+  std::map<MemoryChunk*, intptr_t> live_bytes_;
+  // Live bytes are counted for one chunk at a time, as marked objects tend to
+  // be close to each other, and only go into the map when the chunk changes.
+  MemoryChunk* live_bytes_chunk_;
+  intptr_t live_bytes_in_chunk_;
+  // Size of all objects marked by this task.
+  intptr_t bytes_marked_;
+
+  static base::Thread::LocalStorageKey current_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMarkingTaskState);
+};
+
+
+base::Thread::LocalStorageKey ParallelMarkingTaskState::current_key_;
+
+
+void ParallelMarkingTaskState::Initialize() {
+  current_key_ = base::Thread::CreateThreadLocalKey();
+}
+
+
+ParallelMarkingTaskState* ParallelMarkingTaskState::Current() {
+  return reinterpret_cast<ParallelMarkingTaskState*>(
+      base::Thread::GetThreadLocal(current_key_));
+}
+
+
+void ParallelMarkingTaskState::SetCurrent(ParallelMarkingTaskState* state) {
+  base::Thread::SetThreadLocal(current_key_, state);
+}
+
+
+// Static visitor used by parallel marking tasks. Pointer visits are routed to
+// the state of the task running on the current thread.
+class ParallelMarkingVisitor : public AllStatic {
+ public:
+  INLINE(static void VisitPointers(Heap* heap, HeapObject* object,
+                                   Object** start, Object** end)) {
+    ParallelMarkingTaskState::Current()->VisitPointers(object, start, end);
+  }
+};
+
+
+void ParallelMarkingTaskState::Push(HeapObject* object) {
+  if (local_->IsFull() || (local_->size() >= kMinSegmentSizeToShare &&
+                           marking_->HasIdleTasks())) {
+    marking_->PublishSegment(local_);
+    local_ = new ParallelMarking::Segment();
+  }
+  local_->Push(object);
+}
+
+
+bool ParallelMarkingTaskState::Pop(HeapObject** object) {
+  if (local_->IsEmpty()) {
+    ParallelMarking::Segment* segment = marking_->StealSegment();
+    if (segment == nullptr) return false;
+    delete local_;
+    local_ = segment;
+  }
+  *object = local_->Pop();
+  return true;
+}
+
+
+void ParallelMarkingTaskState::BailOut(HeapObject* object) {
+  DCHECK(!is_main_thread_);
+  if (bailout_->IsFull()) {
+    marking_->PublishMainThreadSegment(bailout_);
+    bailout_ = new ParallelMarking::Segment();
+  }
+  bailout_->Push(object);
+}
+
+
+void ParallelMarkingTaskState::FlushBailouts() {
+  if (bailout_->IsEmpty()) return;
+  marking_->PublishMainThreadSegment(bailout_);
+  bailout_ = new ParallelMarking::Segment();
+}
+
+
+bool ParallelMarkingTaskState::VisitObject(HeapObject* object) {
+  Map* map = object->map();
+  MarkObject(map);
+
+  // The objects below are traced the same way as by the mark-compact visitor,
+  // without side effects on global state. Everything else, e.g. maps, code,
+  // functions, contexts and objects with weak references, is traced on the
+  // main thread.
+  int id = map->visitor_id();
+  if (id >= StaticVisitorBase::kVisitDataObject &&
+      id <= StaticVisitorBase::kVisitDataObjectGeneric) {
+    return true;
+  }
+  if (id >= StaticVisitorBase::kVisitJSObject &&
+      id <= StaticVisitorBase::kVisitJSObjectGeneric) {
+    FlexibleBodyVisitor<ParallelMarkingVisitor, JSObject::BodyDescriptor,
+                        void>::Visit(map, object);
+    return true;
+  }
+  if (id >= StaticVisitorBase::kVisitStruct &&
+      id <= StaticVisitorBase::kVisitStructGeneric) {
+    FlexibleBodyVisitor<ParallelMarkingVisitor, StructBodyDescriptor,
+                        void>::Visit(map, object);
+    return true;
+  }
+  switch (id) {
+    case StaticVisitorBase::kVisitFixedArray:
+      FlexibleBodyVisitor<ParallelMarkingVisitor, FixedArray::BodyDescriptor,
+                          void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitShortcutCandidate:
+    case StaticVisitorBase::kVisitConsString:
+      FixedBodyVisitor<ParallelMarkingVisitor, ConsString::BodyDescriptor,
+                       void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitSlicedString:
+      FixedBodyVisitor<ParallelMarkingVisitor, SlicedString::BodyDescriptor,
+                       void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitSymbol:
+      FixedBodyVisitor<ParallelMarkingVisitor, Symbol::BodyDescriptor,
+                       void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitOddball:
+      FixedBodyVisitor<ParallelMarkingVisitor, Oddball::BodyDescriptor,
+                       void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitCell:
+      FixedBodyVisitor<ParallelMarkingVisitor, Cell::BodyDescriptor,
+                       void>::Visit(map, object);
+      return true;
+    case StaticVisitorBase::kVisitSeqOneByteString:
+    case StaticVisitorBase::kVisitSeqTwoByteString:
+    case StaticVisitorBase::kVisitByteArray:
+    case StaticVisitorBase::kVisitFixedDoubleArray:
+    case StaticVisitorBase::kVisitFixedTypedArray:
+    case StaticVisitorBase::kVisitFixedFloat64Array:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+void ParallelMarkingTaskState::VisitPointers(HeapObject* host, Object** start,
+                                             Object** end) {
+  for (Object** slot = start; slot < end; slot++) {
+    Object* target = *slot;
+    if (!target->IsHeapObject()) continue;
+    HeapObject* heap_object = HeapObject::cast(target);
+    if (Page::FromAddress(heap_object->address())->IsEvacuationCandidate()) {
+      RecordedSlot recorded = {host, slot};
+      recorded_slots_.Add(recorded);
+    }
+    MarkObject(heap_object);
+  }
+}
+
+
+void ParallelMarkingTaskState::MarkObject(HeapObject* object) {
+  MarkBit mark_bit = Marking::MarkBitFrom(object);
+  if (!Marking::IsWhite(mark_bit)) return;
+  if (!Marking::WhiteToBlackAtomic(mark_bit)) return;
+  MemoryChunk* chunk = MemoryChunk::FromAddress(object->address());
+  if (chunk != live_bytes_chunk_) {
+    FlushLiveBytes();
+    live_bytes_chunk_ = chunk;
+  }
+  int size = object->Size();
+  live_bytes_in_chunk_ += size;
+  bytes_marked_ += size;
+  Push(object);
+}
+
+
+void ParallelMarkingTaskState::FlushLiveBytes() {
+  if (live_bytes_chunk_ == nullptr) return;
+  live_bytes_[live_bytes_chunk_] += live_bytes_in_chunk_;
+  live_bytes_chunk_ = nullptr;
+  live_bytes_in_chunk_ = 0;
+}
+
+
+void ParallelMarkingTaskState::PublishResults(Heap* heap) {
+  FlushLiveBytes();
+  for (auto& entry : live_bytes_) {
+    entry.first->IncrementLiveBytes(static_cast<int>(entry.second));
+  }
+  live_bytes_.clear();
+
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+  for (int i = 0; i < recorded_slots_.length(); i++) {
+    RecordedSlot& recorded = recorded_slots_[i];
+    collector->RecordSlot(recorded.host, recorded.slot, *recorded.slot);
+  }
+  recorded_slots_.Rewind(0);
+}
+
+
+class ParallelMarking::Task : public v8::Task {
+ public:
+  Task(ParallelMarking* marking, ParallelMarkingTaskState* state)
+      : marking_(marking), state_(state) {}
+
+  virtual ~Task() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override {
+    marking_->ProcessOnBackgroundThread(state_);
+    marking_->pending_tasks_semaphore_.Signal();
+  }
+
+  ParallelMarking* marking_;
+  ParallelMarkingTaskState* state_;
+
+  DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+
+ParallelMarking::ParallelMarking(Heap* heap)
+    : heap_(heap),
+      pending_tasks_semaphore_(0),
+      shared_pool_(nullptr),
+      main_thread_pool_(nullptr),
+      active_tasks_(0),
+      idle_tasks_(0) {}
+
+
+ParallelMarking::~ParallelMarking() {
+  DCHECK_NULL(shared_pool_);
+  DCHECK_NULL(main_thread_pool_);
+}
+
+
+// static
+void ParallelMarking::Initialize() { ParallelMarkingTaskState::Initialize(); }
+
+
+// static
+int ParallelMarking::NumberOfTasks() {
+  const int kMaxMarkingTasks = 8;
+  if (FLAG_marking_tasks > 0) return Min(kMaxMarkingTasks, FLAG_marking_tasks);
+  // We cap the number of parallel marking tasks by
+  // - (#cores - 1)
+  // - a hard limit
+  return Min(kMaxMarkingTasks,
+             Max(1, base::SysInfo::NumberOfProcessors() - 1));
+}
+
+
+intptr_t ParallelMarking::ProcessMarkingDeque(MarkingDeque* marking_deque) {
+  const int num_tasks = NumberOfTasks();
+  ParallelMarkingTaskState** states = new ParallelMarkingTaskState*[num_tasks];
+  for (int i = 0; i < num_tasks; i++) {
+    states[i] = new ParallelMarkingTaskState(this, i == 0);
+  }
+  // Background tasks count themselves once they run. The platform may run
+  // them late, e.g. one after the other on a single worker thread.
+  active_tasks_ = 1;
+  DCHECK_EQ(0, base::NoBarrier_Load(&idle_tasks_));
+
+  // Kick off parallel tasks and contribute on the main thread.
+  for (int i = 1; i < num_tasks; i++) {
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new Task(this, states[i]), v8::Platform::kShortRunningTask);
+  }
+  ParallelMarkingTaskState::SetCurrent(states[0]);
+  ProcessOnMainThread(states[0], marking_deque);
+  ParallelMarkingTaskState::SetCurrent(nullptr);
+  for (int i = 1; i < num_tasks; i++) {
+    pending_tasks_semaphore_.Wait();
+  }
+
+  intptr_t background_bytes_marked = 0;
+  for (int i = 0; i < num_tasks; i++) {
+    states[i]->PublishResults(heap_);
+    if (!states[i]->is_main_thread()) {
+      background_bytes_marked += states[i]->bytes_marked();
+    }
+    delete states[i];
+  }
+  delete[] states;
+  return background_bytes_marked;
+}
+
+
+void ParallelMarking::ProcessOnMainThread(ParallelMarkingTaskState* state,
+                                          MarkingDeque* marking_deque) {
+  MarkCompactCollector* collector = heap_->mark_compact_collector();
+  Map* filler_map = heap_->one_pointer_filler_map();
+  while (true) {
+    // Objects marked by the mark-compact visitor end up on the marking deque.
+    while (!marking_deque->IsEmpty()) {
+      HeapObject* object = marking_deque->Pop();
+      // Explicitly skip one word fillers. Incremental markbit patterns are
+      // correct only for objects that occupy at least two words.
+      if (object->map() == filler_map) continue;
+      state->Push(object);
+    }
+
+    HeapObject* object;
+    if (state->Pop(&object)) {
+      if (!state->VisitObject(object)) {
+        collector->VisitObjectBody<MarkBit::ATOMIC>(object);
+      }
+      continue;
+    }
+
+    Segment* segment = TakeMainThreadSegment();
+    if (segment != nullptr) {
+      while (!segment->IsEmpty()) {
+        collector->VisitObjectBody<MarkBit::ATOMIC>(segment->Pop());
+      }
+      delete segment;
+      continue;
+    }
+
+    if (!WaitForWork(true)) break;
+  }
+}
+
+
+void ParallelMarking::ProcessOnBackgroundThread(
+    ParallelMarkingTaskState* state) {
+  {
+    base::LockGuard<base::Mutex> guard(&mutex_);
+    active_tasks_++;
+  }
+  ParallelMarkingTaskState::SetCurrent(state);
+  while (true) {
+    HeapObject* object;
+    while (state->Pop(&object)) {
+      if (!state->VisitObject(object)) state->BailOut(object);
+    }
+    state->FlushBailouts();
+    if (!WaitForWork(false)) break;
+  }
+  ParallelMarkingTaskState::SetCurrent(nullptr);
+}
+
+
+void ParallelMarking::PublishSegment(Segment* segment) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  segment->set_next(shared_pool_);
+  shared_pool_ = segment;
+  work_available_.NotifyAll();
+}
+
+
+void ParallelMarking::PublishMainThreadSegment(Segment* segment) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  segment->set_next(main_thread_pool_);
+  main_thread_pool_ = segment;
+  work_available_.NotifyAll();
+}
+
+
+ParallelMarking::Segment* ParallelMarking::StealSegment() {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  Segment* segment = shared_pool_;
+  if (segment != nullptr) shared_pool_ = segment->next();
+  return segment;
+}
+
+
+ParallelMarking::Segment* ParallelMarking::TakeMainThreadSegment() {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  Segment* segment = main_thread_pool_;
+  if (segment != nullptr) main_thread_pool_ = segment->next();
+  return segment;
+}
+
+
+bool ParallelMarking::WaitForWork(bool is_main_thread) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  active_tasks_--;
+  base::NoBarrier_Store(&idle_tasks_, base::NoBarrier_Load(&idle_tasks_) + 1);
+  while (true) {
+    if (shared_pool_ != nullptr ||
+        (is_main_thread && main_thread_pool_ != nullptr)) {
+      active_tasks_++;
+      base::NoBarrier_Store(&idle_tasks_,
+                            base::NoBarrier_Load(&idle_tasks_) - 1);
+      return true;
+    }
+    if (active_tasks_ == 0 && main_thread_pool_ == nullptr) {
+      // No task holds work that could produce new objects.
+      base::NoBarrier_Store(&idle_tasks_,
+                            base::NoBarrier_Load(&idle_tasks_) - 1);
+      work_available_.NotifyAll();
+      return false;
+    }
+    work_available_.Wait(&mutex_);
+  }
+}
+
+}  // namespace internal
+}  // namespace v8
@@ -0,0 +1,93 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_HEAP_PARALLEL_MARKING_H_
+#define V8_HEAP_PARALLEL_MARKING_H_
+
+#include "src/base/atomicops.h"
+#include "src/base/platform/condition-variable.h"
+#include "src/base/platform/mutex.h"
+#include "src/base/platform/platform.h"
+#include "src/base/platform/semaphore.h"
+#include "src/globals.h"
+
+namespace v8 {
+namespace internal {
+
+class Heap;
+class HeapObject;
+class MarkingDeque;
+class ParallelMarkingTaskState;
+
+// Parallel marking traces the transitive closure of the marking deque with
+// several tasks during the atomic pause of a full GC. The tasks share a
+// work-stealing worklist: every task pushes and pops objects on a local
+// segment and publishes segments to a global pool, from which idle tasks
+// steal. Objects that need special treatment (maps, code, functions,
+// contexts, weak objects, ...) are handed to the main thread, which visits
+// them with the regular mark-compact visitor and feeds the objects it marks
+// back into the worklist. Marking is done when all tasks are idle and both
+// pools are empty.
+//
+// Mark bits are claimed with atomic operations while the tasks are running,
+// also on the main thread. Live bytes and recorded slots of the background
+// tasks are accumulated locally and published on the main thread once all
+// tasks are done.
+class ParallelMarking {
+ public:
+  explicit ParallelMarking(Heap* heap);
+  ~ParallelMarking();
+
+  static void Initialize();
+
+  // Marks all objects reachable from the objects on the marking deque. The
+  // main thread participates. Afterwards the marking deque is empty, but it
+  // may have overflowed. Returns the size of the objects marked by background
+  // tasks.
+  intptr_t ProcessMarkingDeque(MarkingDeque* marking_deque);
+
+ private:
+  class Segment;
+  class Task;
+  friend class ParallelMarkingTaskState;
+
+  static int NumberOfTasks();
+
+  void ProcessOnMainThread(ParallelMarkingTaskState* state,
+                           MarkingDeque* marking_deque);
+  void ProcessOnBackgroundThread(ParallelMarkingTaskState* state);
+
+  void PublishSegment(Segment* segment);
+  void PublishMainThreadSegment(Segment* segment);
+  Segment* StealSegment();
+  Segment* TakeMainThreadSegment();
+
+  // Blocks an idle task until work is available. Returns false when marking
+  // is finished.
+  bool WaitForWork(bool is_main_thread);
+
+  bool HasIdleTasks() { return base::NoBarrier_Load(&idle_tasks_) > 0; }
+
+  Heap* heap_;
+  base::Mutex mutex_;
+  base::ConditionVariable work_available_;
+  base::Semaphore pending_tasks_semaphore_;
+
+  // The following fields are protected by mutex_.
+  Segment* shared_pool_;
+  Segment* main_thread_pool_;
+  // Tasks that are running and not waiting for work.
+  int active_tasks_;
+
+  // Tasks that are waiting for work. Written under mutex_, read without it as
+  // a hint for sharing work. Drops back to zero when marking is finished.
+  base::AtomicWord idle_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMarking);
+};
+
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_HEAP_PARALLEL_MARKING_H_
@@ -0,0 +1,75 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/heap/remembered-set.h"
+
+#include "src/heap/heap-inl.h"
+#include "src/heap/heap.h"
+#include "src/heap/mark-compact.h"
+#include "src/heap/slot-set.h"
+#include "src/heap/spaces.h"
+
+namespace v8 {
+namespace internal {
+
+template <PointerDirection direction>
+void RememberedSet<direction>::ClearInvalidSlots(Heap* heap) {
+  Iterate(heap, [heap](Address addr) {
+    return IsValidSlot(heap, reinterpret_cast<Object**>(addr)) ? KEEP_SLOT
+                                                               : REMOVE_SLOT;
+  });
+}
+
+
+template <PointerDirection direction>
+void RememberedSet<direction>::VerifyValidSlots(Heap* heap) {
+  Iterate(heap, [heap](Address addr) {
+    Object** slot = reinterpret_cast<Object**>(addr);
+    Object* object = *slot;
+    if (object->IsHeapObject()) {
+      if (direction == OLD_TO_NEW) {
+        CHECK(heap->InNewSpace(object));
+      } else {
+        CHECK(!heap->InNewSpace(object));
+      }
+      heap->mark_compact_collector()->VerifyIsSlotInLiveObject(
+          addr, HeapObject::cast(object));
+    }
+    return KEEP_SLOT;
+  });
+}
+
+
+template <PointerDirection direction>
+bool RememberedSet<direction>::IsValidSlot(Heap* heap, Object** slot) {
+  Object* object = *slot;
+  if (!object->IsHeapObject()) return false;
+  if (direction == OLD_TO_NEW) {
+    // If the target object is not black, the source slot must be part
+    // of a non-black (dead) object.
+    return heap->InNewSpace(object) &&
+           Marking::IsBlack(Marking::MarkBitFrom(HeapObject::cast(object))) &&
+           heap->mark_compact_collector()->IsSlotInLiveObject(
+               reinterpret_cast<Address>(slot));
+  } else {
+    // Slots are invalid when they currently:
+    // - point to a heap object in new space
+    // - are not within a live heap object on a valid pointer slot
+    // - point to a heap object not on an evacuation candidate
+    return !heap->InNewSpace(object) &&
+           heap->mark_compact_collector()->IsSlotInLiveObject(
+               reinterpret_cast<Address>(slot)) &&
+           Page::FromAddress(reinterpret_cast<Address>(object))
+               ->IsEvacuationCandidate();
+  }
+}
+
+
+template void RememberedSet<OLD_TO_NEW>::ClearInvalidSlots(Heap* heap);
+template void RememberedSet<OLD_TO_NEW>::VerifyValidSlots(Heap* heap);
+template void RememberedSet<OLD_TO_OLD>::ClearInvalidSlots(Heap* heap);
+template void RememberedSet<OLD_TO_OLD>::VerifyValidSlots(Heap* heap);
+
+}  // namespace internal
+}  // namespace v8
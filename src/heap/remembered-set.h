@@ -0,0 +1,212 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_HEAP_REMEMBERED_SET_H_
+#define V8_HEAP_REMEMBERED_SET_H_
+
+#include "src/heap/heap.h"
+#include "src/heap/slot-set.h"
+#include "src/heap/spaces.h"
+
+namespace v8 {
+namespace internal {
+
+enum PointerDirection { OLD_TO_OLD, OLD_TO_NEW };
+
+// A remembered set is a set of slots of a given pointer direction, kept in
+// per-chunk slot sets. Large chunks use one slot set per Page::kPageSize
+// region of the chunk.
+//   - OLD_TO_NEW slots point from the old generation into new space. They are
+//     the roots of a scavenge and replace the global store buffer.
+//   - OLD_TO_OLD slots point to objects on evacuation candidates. They are
+//     recorded during marking and updated after evacuation.
+template <PointerDirection direction>
+class RememberedSet {
+ public:
+  // Given a chunk and a slot in that chunk, this function adds the slot to
+  // the remembered set.
+  static void Insert(MemoryChunk* chunk, Address slot_addr) {
+    DCHECK(chunk->Contains(slot_addr));
+    SlotSet* slot_set = GetSlotSet(chunk);
+    if (slot_set == nullptr) {
+      slot_set = AllocateSlotSet(chunk);
+    }
+    uintptr_t offset = slot_addr - chunk->address();
+    slot_set[offset / Page::kPageSize].Insert(offset % Page::kPageSize);
+  }
+
+  // Given a chunk and a slot in that chunk, this function removes the slot
+  // from the remembered set. If the slot was never added, then the function
+  // does nothing.
+  static void Remove(MemoryChunk* chunk, Address slot_addr) {
+    DCHECK(chunk->Contains(slot_addr));
+    SlotSet* slot_set = GetSlotSet(chunk);
+    if (slot_set != nullptr) {
+      uintptr_t offset = slot_addr - chunk->address();
+      slot_set[offset / Page::kPageSize].Remove(offset % Page::kPageSize);
+    }
+  }
+
+  // Given a chunk and a slot in that chunk, this function returns true if the
+  // slot is in the remembered set.
+  static bool Contains(MemoryChunk* chunk, Address slot_addr) {
+    DCHECK(chunk->Contains(slot_addr));
+    SlotSet* slot_set = GetSlotSet(chunk);
+    if (slot_set == nullptr) {
+      return false;
+    }
+    uintptr_t offset = slot_addr - chunk->address();
+    return slot_set[offset / Page::kPageSize].Lookup(offset %
+                                                     Page::kPageSize);
+  }
+
+  // Given a chunk and a range of slots in that chunk, this function removes
+  // the slots from the remembered set.
+  static void RemoveRange(MemoryChunk* chunk, Address start, Address end) {
+    SlotSet* slot_set = GetSlotSet(chunk);
+    if (slot_set != nullptr) {
+      uintptr_t start_offset = start - chunk->address();
+      uintptr_t end_offset = end - chunk->address();
+      DCHECK_LE(start_offset, end_offset);
+      while (start_offset < end_offset) {
+        size_t index = start_offset / Page::kPageSize;
+        uintptr_t page_end_offset = (index + 1) * Page::kPageSize;
+        uintptr_t range_end =
+            end_offset < page_end_offset ? end_offset : page_end_offset;
+        slot_set[index].RemoveRange(
+            static_cast<int>(start_offset % Page::kPageSize),
+            static_cast<int>(range_end - index * Page::kPageSize));
+        start_offset = range_end;
+      }
+    }
+  }
+
+  // Iterates and filters the remembered set with the given callback.
+  // The callback should take (Address slot) and return SlotCallbackResult.
+  template <typename Callback>
+  static void Iterate(Heap* heap, Callback callback) {
+    PointerChunkIterator it(heap);
+    MemoryChunk* chunk;
+    while ((chunk = it.next()) != nullptr) {
+      IterateChunk(chunk, callback);
+    }
+  }
+
+  // Iterates and filters the remembered set of the given chunk. Chunks can be
+  // iterated concurrently as long as every chunk is iterated by one thread.
+  template <typename Callback>
+  static void IterateChunk(MemoryChunk* chunk, Callback callback) {
+    SlotSet* slots = GetSlotSet(chunk);
+    if (slots != nullptr) {
+      size_t pages = (chunk->size() + Page::kPageSize - 1) / Page::kPageSize;
+      int new_count = 0;
+      for (size_t page = 0; page < pages; page++) {
+        new_count += slots[page].Iterate(callback);
+      }
+      if (new_count == 0) {
+        ReleaseSlotSet(chunk);
+      }
+    }
+  }
+
+  // Returns true if the given chunk has a remembered set of this direction.
+  static bool HasSlots(MemoryChunk* chunk) {
+    return GetSlotSet(chunk) != nullptr;
+  }
+
+  // Iterates and filters the remembered set with the given callback.
+  // The callback should take (HeapObject** slot, HeapObject* target) and
+  // update the slot.
+  // A special wrapper takes care of filtering the slots based on their values.
+  // For OLD_TO_NEW case: slots that do not point to the ToSpace after
+  // callback invocation will be removed from the set.
+  template <typename Callback>
+  static void IterateWithWrapper(Heap* heap, Callback callback) {
+    Iterate(heap, [heap, callback](Address addr) {
+      return Wrapper(heap, addr, callback);
+    });
+  }
+
+  // Like IterateWithWrapper, but only for the remembered set of one chunk.
+  template <typename Callback>
+  static void IterateChunkWithWrapper(Heap* heap, MemoryChunk* chunk,
+                                      Callback callback) {
+    IterateChunk(chunk, [heap, callback](Address addr) {
+      return Wrapper(heap, addr, callback);
+    });
+  }
+
+  // Removes all slots of the given direction.
+  static void ClearAll(Heap* heap) {
+    PointerChunkIterator it(heap);
+    MemoryChunk* chunk;
+    while ((chunk = it.next()) != nullptr) {
+      ReleaseSlotSet(chunk);
+    }
+  }
+
+  // Eliminates all stale slots from the remembered set, i.e.
+  // slots that are not part of live objects anymore. This method must be
+  // called after marking, when the whole transitive closure is known and
+  // must be called before sweeping when mark bits are still intact.
+  static void ClearInvalidSlots(Heap* heap);
+
+  static void VerifyValidSlots(Heap* heap);
+
+ private:
+  static SlotSet* GetSlotSet(MemoryChunk* chunk) {
+    if (direction == OLD_TO_OLD) {
+      return chunk->old_to_old_slots();
+    } else {
+      return chunk->old_to_new_slots();
+    }
+  }
+
+  static void ReleaseSlotSet(MemoryChunk* chunk) {
+    if (direction == OLD_TO_OLD) {
+      chunk->ReleaseOldToOldSlots();
+    } else {
+      chunk->ReleaseOldToNewSlots();
+    }
+  }
+
+  static SlotSet* AllocateSlotSet(MemoryChunk* chunk) {
+    if (direction == OLD_TO_OLD) {
+      chunk->AllocateOldToOldSlots();
+      return chunk->old_to_old_slots();
+    } else {
+      chunk->AllocateOldToNewSlots();
+      return chunk->old_to_new_slots();
+    }
+  }
+
+  template <typename Callback>
+  static SlotCallbackResult Wrapper(Heap* heap, Address slot_address,
+                                    Callback slot_callback) {
+    STATIC_ASSERT(direction == OLD_TO_NEW);
+    Object** slot = reinterpret_cast<Object**>(slot_address);
+    Object* object = *slot;
+    if (heap->InFromSpace(object)) {
+      HeapObject* heap_object = reinterpret_cast<HeapObject*>(object);
+      DCHECK(heap_object->IsHeapObject());
+      slot_callback(reinterpret_cast<HeapObject**>(slot), heap_object);
+      object = *slot;
+      // If the object was in from space before and is after executing the
+      // callback in to space, the object is still live.
+      // Unfortunately, we do not know about the slot. It could be in a
+      // just freed free space object.
+      if (heap->InToSpace(object)) {
+        return KEEP_SLOT;
+      }
+    }
+    return REMOVE_SLOT;
+  }
+
+  static bool IsValidSlot(Heap* heap, Object** slot);
+};
+
+}  // namespace internal
+}  // namespace v8
+
+#endif  // V8_HEAP_REMEMBERED_SET_H_
@@ -4,13 +4,20 @@
 
 #include "src/heap/scavenger.h"
 
+#include "src/base/atomicops.h"
+#include "src/base/platform/platform.h"
+#include "src/base/sys-info.h"
 #include "src/contexts.h"
+#include "src/heap/array-buffer-tracker.h"
 #include "src/heap/heap.h"
 #include "src/heap/objects-visiting-inl.h"
+#include "src/heap/remembered-set.h"
 #include "src/heap/scavenger-inl.h"
+#include "src/heap/store-buffer-inl.h"
 #include "src/isolate.h"
 #include "src/log.h"
 #include "src/profiler/cpu-profiler.h"
+#include "src/v8.h"
 
 namespace v8 {
 namespace internal {
@@ -409,6 +416,368 @@ VisitorDispatchTable<ScavengingCallback>
     ScavengingVisitor<marks_handling, logging_and_profiling_mode>::table_;
 
 
+// A range of copied but not yet scanned objects that is processed by a single
+// parallel scavenging task. Ranges in to-space never cross page boundaries.
+struct ScavengeWorkItem {
+  ScavengeWorkItem(Address start, Address end) : start(start), end(end) {}
+
+  Address start;
+  Address end;
+};
+
+
+// State of a single parallel scavenging task. Objects are copied into a local
+// allocation buffer in to-space or promoted into a task-local compaction
+// space. Forwarding addresses are installed with a compare-and-swap on the
+// map word, so that exactly one task wins the race for every object. Updates
+// to global state (store buffer, pretenuring feedback, counters) are buffered
+// and published on the main thread once all tasks are done.
+class ParallelScavengeTaskState {
+ public:
+  ParallelScavengeTaskState(Heap* heap,
+                            CompactionSpaceCollection* compaction_spaces)
+      : heap_(heap),
+        compaction_spaces_(compaction_spaces),
+        lab_top_(nullptr),
+        lab_limit_(nullptr),
+        semi_space_copied_size_(0),
+        promoted_size_(0) {}
+
+  // Copies {object} unless another task already did so and updates {slot}.
+  void ScavengeObject(HeapObject** slot, HeapObject* object);
+
+  // Scavenges the target of {slot} if it resides in from-space. Slots in old
+  // objects that keep pointing into new space are recorded.
+  inline void VisitPointer(Object** slot);
+
+  // Scans all objects in [start, end) and everything copied by this task in
+  // the meantime.
+  void ProcessRange(Address start, Address end);
+
+  // Fills the unused part of the local allocation buffer. Must be called by
+  // the task itself before it signals completion.
+  void FinalizeLocalAllocationBuffer();
+
+  List<Address>* old_to_new_slots() { return &old_to_new_slots_; }
+  List<AllocationSite*>* allocation_sites() { return &allocation_sites_; }
+  intptr_t semi_space_copied_size() { return semi_space_copied_size_; }
+  intptr_t promoted_size() { return promoted_size_; }
+
+  static inline ParallelScavengeTaskState* Current();
+  static inline void SetCurrent(ParallelScavengeTaskState* state);
+  static void Initialize();
+
+ private:
+  static const int kLocalAllocationBufferSize = 8 * KB;
+  static const int kMaxLocalAllocationBufferObjectSize =
+      kLocalAllocationBufferSize / 2;
+
+  HeapObject* AllocateInToSpace(int size_in_bytes,
+                                AllocationAlignment alignment);
+  HeapObject* AllocateInOldSpace(int size_in_bytes,
+                                 AllocationAlignment alignment);
+  bool RefillLocalAllocationBuffer();
+  AllocationSite* FindAllocationSite(HeapObject* object, Map* map,
+                                     int object_size);
+
+  Heap* heap_;
+  CompactionSpaceCollection* compaction_spaces_;
+  Address lab_top_;
+  Address lab_limit_;
+  List<HeapObject*> marking_list_;
+  List<Address> old_to_new_slots_;
+  List<AllocationSite*> allocation_sites_;
+  intptr_t semi_space_copied_size_;
+  intptr_t promoted_size_;
+
+  static base::Thread::LocalStorageKey current_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengeTaskState);
+};
+
+
+base::Thread::LocalStorageKey ParallelScavengeTaskState::current_key_;
+
+
+void ParallelScavengeTaskState::Initialize() {
+  current_key_ = base::Thread::CreateThreadLocalKey();
+}
+
+
+ParallelScavengeTaskState* ParallelScavengeTaskState::Current() {
+  return reinterpret_cast<ParallelScavengeTaskState*>(
+      base::Thread::GetThreadLocal(current_key_));
+}
+
+
+void ParallelScavengeTaskState::SetCurrent(ParallelScavengeTaskState* state) {
+  base::Thread::SetThreadLocal(current_key_, state);
+}
+
+
+// Static visitor used by parallel scavenging tasks. Pointer visits are routed
+// to the state of the task running on the current thread.
+class ParallelScavengeVisitor
+    : public StaticNewSpaceVisitor<ParallelScavengeVisitor> {
+ public:
+  static inline void VisitPointer(Heap* heap, Object** p) {
+    ParallelScavengeTaskState::Current()->VisitPointer(p);
+  }
+};
+
+
+void ParallelScavengeTaskState::VisitPointer(Object** slot) {
+  Object* object = *slot;
+  if (!heap_->InFromSpace(object)) return;
+  ScavengeObject(reinterpret_cast<HeapObject**>(slot),
+                 reinterpret_cast<HeapObject*>(object));
+  Address slot_address = reinterpret_cast<Address>(slot);
+  if (!heap_->InNewSpace(slot_address) && heap_->InNewSpace(*slot)) {
+    old_to_new_slots_.Add(slot_address);
+  }
+}
+
+
+void ParallelScavengeTaskState::ScavengeObject(HeapObject** slot,
+                                               HeapObject* object) {
+  DCHECK(heap_->InFromSpace(object));
+  MapWord first_word = object->synchronized_map_word();
+  if (first_word.IsForwardingAddress()) {
+    *slot = first_word.ToForwardingAddress();
+    return;
+  }
+
+  Map* map = first_word.ToMap();
+  DCHECK(map != heap_->allocation_memento_map());
+  int object_size = object->SizeFromMap(map);
+  AllocationAlignment alignment = kWordAligned;
+#ifdef V8_HOST_ARCH_32_BIT
+  InstanceType instance_type = map->instance_type();
+  if ((instance_type == FIXED_DOUBLE_ARRAY_TYPE ||
+       instance_type == FIXED_FLOAT64_ARRAY_TYPE) &&
+      FixedArrayBase::cast(object)->length() != 0) {
+    alignment = kDoubleAligned;
+  } else if (instance_type == HEAP_NUMBER_TYPE ||
+             instance_type == MUTABLE_HEAP_NUMBER_TYPE) {
+    alignment = kDoubleUnaligned;
+  } else if (instance_type == SIMD128_VALUE_TYPE) {
+    alignment = kSimd128Unaligned;
+  }
+#endif  // V8_HOST_ARCH_32_BIT
+
+  // The memento has to be looked up before the forwarding address is
+  // installed since the lookup relies on the size of the object.
+  AllocationSite* site = FindAllocationSite(object, map, object_size);
+
+  HeapObject* target = nullptr;
+  bool promoted = false;
+  if (!heap_->ShouldBePromoted(object->address(), object_size)) {
+    target = AllocateInToSpace(object_size, alignment);
+  }
+  if (target == nullptr) {
+    target = AllocateInOldSpace(object_size, alignment);
+    promoted = target != nullptr;
+  }
+  if (target == nullptr) target = AllocateInToSpace(object_size, alignment);
+  if (target == nullptr) {
+    FatalProcessOutOfMemory("Scavenger: parallel semi-space copy\n");
+  }
+
+  Heap::CopyBlock(target->address(), object->address(), object_size);
+  // Another task may have installed a forwarding address while we were
+  // copying. Make sure our copy carries the actual map in any case.
+  target->set_map_word(MapWord::FromMap(map));
+  int visitor_id = map->visitor_id();
+  if (visitor_id == StaticVisitorBase::kVisitFixedTypedArray ||
+      visitor_id == StaticVisitorBase::kVisitFixedFloat64Array) {
+    FixedTypedArrayBase* typed_array =
+        reinterpret_cast<FixedTypedArrayBase*>(target);
+    if (typed_array->base_pointer() != Smi::FromInt(0)) {
+      typed_array->set_base_pointer(typed_array, SKIP_WRITE_BARRIER);
+    }
+  }
+
+  base::AtomicWord expected =
+      static_cast<base::AtomicWord>(first_word.ToRawValue());
+  base::AtomicWord forwarding = static_cast<base::AtomicWord>(
+      MapWord::FromForwardingAddress(target).ToRawValue());
+  base::AtomicWord* map_slot = reinterpret_cast<base::AtomicWord*>(
+      object->address() + HeapObject::kMapOffset);
+  if (base::Release_CompareAndSwap(map_slot, expected, forwarding) !=
+      expected) {
+    // Another task won the race. Turn our copy into a filler.
+    heap_->CreateFillerObjectAt(target->address(), object_size);
+    *slot = object->synchronized_map_word().ToForwardingAddress();
+    return;
+  }
+
+  *slot = target;
+  if (promoted) {
+    promoted_size_ += object_size;
+    if (visitor_id == StaticVisitorBase::kVisitJSArrayBuffer) {
+      heap_->array_buffer_tracker()->Promote(JSArrayBuffer::cast(target));
+    }
+  } else {
+    semi_space_copied_size_ += object_size;
+  }
+  if (site != nullptr) allocation_sites_.Add(site);
+  marking_list_.Add(target);
+}
+
+
+AllocationSite* ParallelScavengeTaskState::FindAllocationSite(
+    HeapObject* object, Map* map, int object_size) {
+  if (!FLAG_allocation_site_pretenuring ||
+      !AllocationSite::CanTrack(map->instance_type())) {
+    return nullptr;
+  }
+  // See Heap::FindAllocationMemento. From-space pages are filled above their
+  // top during a scavenge, so there is no need to check against the
+  // allocation top here.
+  Address memento_address = object->address() + object_size;
+  Address last_memento_word_address = memento_address + kPointerSize;
+  if (!NewSpacePage::OnSamePage(object->address(),
+                                last_memento_word_address)) {
+    return nullptr;
+  }
+  HeapObject* candidate = HeapObject::FromAddress(memento_address);
+  if (candidate->synchronized_map_word().ToRawValue() !=
+      MapWord::FromMap(heap_->allocation_memento_map()).ToRawValue()) {
+    return nullptr;
+  }
+  AllocationMemento* memento = AllocationMemento::cast(candidate);
+  if (!memento->IsValid()) return nullptr;
+  return memento->GetAllocationSite();
+}
+
+
+HeapObject* ParallelScavengeTaskState::AllocateInToSpace(
+    int size_in_bytes, AllocationAlignment alignment) {
+  int filler_size = Heap::GetFillToAlign(lab_top_, alignment);
+  if (lab_limit_ - lab_top_ < size_in_bytes + filler_size) {
+    if (size_in_bytes > kMaxLocalAllocationBufferObjectSize ||
+        !RefillLocalAllocationBuffer()) {
+      HeapObject* target = nullptr;
+      AllocationResult allocation =
+          heap_->new_space()->AllocateRawSynchronized(size_in_bytes, alignment);
+      return allocation.To(&target) ? target : nullptr;
+    }
+    filler_size = Heap::GetFillToAlign(lab_top_, alignment);
+  }
+  HeapObject* target = HeapObject::FromAddress(lab_top_);
+  lab_top_ += size_in_bytes + filler_size;
+  if (filler_size > 0) target = heap_->PrecedeWithFiller(target, filler_size);
+  return target;
+}
+
+
+bool ParallelScavengeTaskState::RefillLocalAllocationBuffer() {
+  FinalizeLocalAllocationBuffer();
+  HeapObject* buffer = nullptr;
+  AllocationResult allocation = heap_->new_space()->AllocateRawSynchronized(
+      kLocalAllocationBufferSize, kWordAligned);
+  if (!allocation.To(&buffer)) return false;
+  lab_top_ = buffer->address();
+  lab_limit_ = lab_top_ + kLocalAllocationBufferSize;
+  return true;
+}
+
+
+void ParallelScavengeTaskState::FinalizeLocalAllocationBuffer() {
+  if (lab_top_ != nullptr) {
+    heap_->CreateFillerObjectAt(lab_top_,
+                                static_cast<int>(lab_limit_ - lab_top_));
+  }
+  lab_top_ = lab_limit_ = nullptr;
+}
+
+
+HeapObject* ParallelScavengeTaskState::AllocateInOldSpace(
+    int size_in_bytes, AllocationAlignment alignment) {
+  HeapObject* target = nullptr;
+  AllocationResult allocation =
+      compaction_spaces_->Get(OLD_SPACE)->AllocateRaw(size_in_bytes,
+                                                      alignment);
+  return allocation.To(&target) ? target : nullptr;
+}
+
+
+void ParallelScavengeTaskState::ProcessRange(Address start, Address end) {
+  Address current = start;
+  while (current < end) {
+    HeapObject* object = HeapObject::FromAddress(current);
+    current += ParallelScavengeVisitor::IterateBody(object->map(), object);
+  }
+  while (!marking_list_.is_empty()) {
+    HeapObject* object = marking_list_.RemoveLast();
+    ParallelScavengeVisitor::IterateBody(object->map(), object);
+  }
+}
+
+
+// The work shared by all parallel scavenging tasks of a single scavenge.
+class ParallelScavengeWork {
+ public:
+  ParallelScavengeWork()
+      : next_item_(0), started_tasks_(0), pending_tasks_semaphore_(0) {}
+
+  List<ScavengeWorkItem>* items() { return &items_; }
+  base::Semaphore* pending_tasks_semaphore() {
+    return &pending_tasks_semaphore_;
+  }
+
+  // Number of tasks that have started processing work items.
+  int started_tasks() {
+    return static_cast<int>(base::NoBarrier_Load(&started_tasks_));
+  }
+
+  // Processes work items until none are left.
+  void Process(ParallelScavengeTaskState* state) {
+    base::NoBarrier_AtomicIncrement(&started_tasks_, 1);
+    ParallelScavengeTaskState::SetCurrent(state);
+    while (true) {
+      int index =
+          static_cast<int>(base::NoBarrier_AtomicIncrement(&next_item_, 1)) -
+          1;
+      if (index >= items_.length()) break;
+      state->ProcessRange(items_[index].start, items_[index].end);
+    }
+    state->FinalizeLocalAllocationBuffer();
+    ParallelScavengeTaskState::SetCurrent(nullptr);
+  }
+
+ private:
+  List<ScavengeWorkItem> items_;
+  base::AtomicWord next_item_;
+  base::AtomicWord started_tasks_;
+  base::Semaphore pending_tasks_semaphore_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengeWork);
+};
+
+
+class Scavenger::ParallelScavengeTask : public v8::Task {
+ public:
+  ParallelScavengeTask(ParallelScavengeWork* work,
+                       ParallelScavengeTaskState* state)
+      : work_(work), state_(state) {}
+
+  virtual ~ParallelScavengeTask() {}
+
+ private:
+  // v8::Task overrides.
+  void Run() override {
+    work_->Process(state_);
+    work_->pending_tasks_semaphore()->Signal();
+  }
+
+  ParallelScavengeWork* work_;
+  ParallelScavengeTaskState* state_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengeTask);
+};
+
+
 // static
 void Scavenger::Initialize() {
   ScavengingVisitor<TRANSFER_MARKS,
@@ -417,6 +786,8 @@ void Scavenger::Initialize() {
   ScavengingVisitor<TRANSFER_MARKS,
                     LOGGING_AND_PROFILING_ENABLED>::Initialize();
   ScavengingVisitor<IGNORE_MARKS, LOGGING_AND_PROFILING_ENABLED>::Initialize();
+  ParallelScavengeVisitor::Initialize();
+  ParallelScavengeTaskState::Initialize();
 }
 
 
@@ -438,6 +809,12 @@ void Scavenger::SelectScavengingVisitorsTable() {
       (isolate()->heap_profiler() != NULL &&
        isolate()->heap_profiler()->is_tracking_object_moves());
 
+  // Parallel tasks neither transfer mark bits nor report object moves.
+  parallel_scavenge_tasks_ = 0;
+  can_scavenge_in_parallel_ = FLAG_parallel_scavenge &&
+                              !logging_and_profiling &&
+                              !heap()->incremental_marking()->IsMarking();
+
   if (!heap()->incremental_marking()->IsMarking()) {
     if (!logging_and_profiling) {
       scavenging_visitors_table_.CopyFrom(
@@ -473,6 +850,133 @@ void Scavenger::SelectScavengingVisitorsTable() {
 }
 
 
+int Scavenger::NumberOfParallelScavengeTasks(int work_items) {
+  const int kMaxScavengeTasks = 8;
+  if (FLAG_scavenge_tasks > 0) {
+    return Min(kMaxScavengeTasks, FLAG_scavenge_tasks);
+  }
+  // We cap the number of parallel scavenge tasks by
+  // - (#cores - 1)
+  // - a value depending on the amount of work
+  // - a hard limit
+  const int kWorkItemsPerScavengeTask = 16;
+  return Min(kMaxScavengeTasks,
+             Min(1 + work_items / kWorkItemsPerScavengeTask,
+                 Max(1, base::SysInfo::NumberOfProcessors() - 1)));
+}
+
+
+Address Scavenger::ScavengeInParallel(Address new_space_front) {
+  DCHECK(can_scavenge_in_parallel_);
+  const int kWorkItemSize = 16 * KB;
+  ParallelScavengeWork work;
+  List<ScavengeWorkItem>* items = work.items();
+
+  // Split the unscanned part of to-space into work items. Items end at object
+  // boundaries and never cross pages.
+  NewSpace* new_space = heap()->new_space();
+  Address current = new_space_front;
+  Address item_start = current;
+  while (current != new_space->top()) {
+    if (NewSpacePage::IsAtEnd(current)) {
+      if (item_start != current) {
+        items->Add(ScavengeWorkItem(item_start, current));
+      }
+      current = NewSpacePage::FromLimit(current)->next_page()->area_start();
+      item_start = current;
+      continue;
+    }
+    current += HeapObject::FromAddress(current)->Size();
+    if (current - item_start >= kWorkItemSize) {
+      items->Add(ScavengeWorkItem(item_start, current));
+      item_start = current;
+    }
+  }
+  if (item_start != current) items->Add(ScavengeWorkItem(item_start, current));
+
+  // Promoted objects that have not been scanned yet become work items of
+  // their own. This empties the promotion queue, allowing the tasks to
+  // allocate in the space it used to occupy.
+  PromotionQueue* promotion_queue = heap()->promotion_queue();
+  while (!promotion_queue->is_empty()) {
+    HeapObject* target;
+    int size;
+    promotion_queue->remove(&target, &size);
+    items->Add(ScavengeWorkItem(target->address(), target->address() + size));
+  }
+
+  const int num_tasks = NumberOfParallelScavengeTasks(items->length());
+  CompactionSpaceCollection** compaction_spaces =
+      new CompactionSpaceCollection*[num_tasks];
+  ParallelScavengeTaskState** states =
+      new ParallelScavengeTaskState*[num_tasks];
+  for (int i = 0; i < num_tasks; i++) {
+    compaction_spaces[i] = new CompactionSpaceCollection(heap());
+    states[i] = new ParallelScavengeTaskState(heap(), compaction_spaces[i]);
+  }
+  heap()->old_space()->DivideUponCompactionSpaces(compaction_spaces,
+                                                  num_tasks);
+
+  // Kick off parallel tasks and contribute on the main thread.
+  for (int i = 1; i < num_tasks; i++) {
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new ParallelScavengeTask(&work, states[i]),
+        v8::Platform::kShortRunningTask);
+  }
+  work.Process(states[0]);
+  for (int i = 1; i < num_tasks; i++) {
+    work.pending_tasks_semaphore()->Wait();
+  }
+  parallel_scavenge_tasks_ = work.started_tasks();
+
+  // Publish the buffered results sequentially.
+  for (int i = 0; i < num_tasks; i++) {
+    ParallelScavengeTaskState* state = states[i];
+    heap()->old_space()->MergeCompactionSpace(
+        compaction_spaces[i]->Get(OLD_SPACE));
+    // Tasks that did not get any work item have nothing to account.
+    if (state->semi_space_copied_size() > 0) {
+      heap()->IncrementSemiSpaceCopiedObjectSize(
+          static_cast<int>(state->semi_space_copied_size()));
+    }
+    if (state->promoted_size() > 0) {
+      heap()->IncrementPromotedObjectsSize(
+          static_cast<int>(state->promoted_size()));
+    }
+    List<AllocationSite*>* sites = state->allocation_sites();
+    for (int j = 0; j < sites->length(); j++) {
+      AllocationSite* site = sites->at(j);
+      if (site->IncrementMementoFoundCount()) {
+        heap()->AddAllocationSiteToScratchpad(site,
+                                              Heap::IGNORE_SCRATCHPAD_SLOT);
+      }
+    }
+    List<Address>* slots = state->old_to_new_slots();
+    for (int j = 0; j < slots->length(); j++) {
+      Address slot = slots->at(j);
+      RememberedSet<OLD_TO_NEW>::Insert(
+          MemoryChunk::FromAnyPointerAddress(heap(), slot), slot);
+    }
+    delete state;
+    delete compaction_spaces[i];
+  }
+  delete[] states;
+  delete[] compaction_spaces;
+
+  // The promotion queue may have been overwritten by the tasks. Start over
+  // with a fresh one below the current allocation top.
+  promotion_queue->Destroy();
+  promotion_queue->Initialize();
+  promotion_queue->SetNewLimit(new_space->top());
+
+  if (FLAG_trace_gc_verbose) {
+    PrintIsolate(isolate(), "Parallel scavenge: %d tasks, %d work items\n",
+                 num_tasks, items->length());
+  }
+  return new_space->top();
+}
+
+
 Isolate* Scavenger::isolate() { return heap()->isolate(); }
 
 
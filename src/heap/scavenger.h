@@ -15,7 +15,10 @@ typedef void (*ScavengingCallback)(Map* map, HeapObject** slot,
 
 class Scavenger {
  public:
-  explicit Scavenger(Heap* heap) : heap_(heap) {}
+  explicit Scavenger(Heap* heap)
+      : heap_(heap),
+        can_scavenge_in_parallel_(false),
+        parallel_scavenge_tasks_(0) {}
 
   // Initializes static visitor dispatch tables.
   static void Initialize();
@@ -33,12 +36,33 @@ class Scavenger {
   // of the heap (i.e. incremental marking, logging and profiling).
   void SelectScavengingVisitorsTable();
 
+  // Whether the transitive closure of the current scavenge may be computed by
+  // several tasks in parallel. Only valid after the scavenging visitors table
+  // has been selected.
+  bool CanScavengeInParallel() { return can_scavenge_in_parallel_; }
+
+  // Processes all copied but not yet scanned objects, i.e., objects between
+  // {new_space_front} and the to-space allocation top as well as all entries
+  // of the promotion queue, and everything transitively reachable from them
+  // using parallel tasks. Returns the new front of the to-space queue.
+  Address ScavengeInParallel(Address new_space_front);
+
+  // Number of tasks, including the main thread, that took part in the
+  // current or last scavenge. Zero if it was not done in parallel.
+  int parallel_scavenge_tasks() { return parallel_scavenge_tasks_; }
+
   Isolate* isolate();
   Heap* heap() { return heap_; }
 
  private:
+  class ParallelScavengeTask;
+
+  int NumberOfParallelScavengeTasks(int work_items);
+
   Heap* heap_;
   VisitorDispatchTable<ScavengingCallback> scavenging_visitors_table_;
+  bool can_scavenge_in_parallel_;
+  int parallel_scavenge_tasks_;
 };
 
 
@@ -214,18 +214,6 @@ bool PagedSpace::Contains(Address addr) {
 bool PagedSpace::Contains(HeapObject* o) { return Contains(o->address()); }
 
 
-void MemoryChunk::set_scan_on_scavenge(bool scan) {
-  if (scan) {
-    if (!scan_on_scavenge()) heap_->increment_scan_on_scavenge_pages();
-    SetFlag(SCAN_ON_SCAVENGE);
-  } else {
-    if (scan_on_scavenge()) heap_->decrement_scan_on_scavenge_pages();
-    ClearFlag(SCAN_ON_SCAVENGE);
-  }
-  heap_->incremental_marking()->SetOldSpacePageFlags(this);
-}
-
-
 MemoryChunk* MemoryChunk::FromAnyPointerAddress(Heap* heap, Address addr) {
   MemoryChunk* maybe = reinterpret_cast<MemoryChunk*>(
       OffsetFrom(addr) & ~Page::kPageAlignmentMask);
@@ -250,6 +238,7 @@ PointerChunkIterator::PointerChunkIterator(Heap* heap)
     : state_(kOldSpaceState),
       old_iterator_(heap->old_space()),
       map_iterator_(heap->map_space()),
+      code_iterator_(heap->code_space()),
       lo_iterator_(heap->lo_space()) {}
 
 
@@ -266,20 +255,22 @@ MemoryChunk* PointerChunkIterator::next() {
       if (map_iterator_.has_next()) {
         return map_iterator_.next();
       }
+      state_ = kCodeState;
+      // Fall through.
+    }
+    case kCodeState: {
+      if (code_iterator_.has_next()) {
+        return code_iterator_.next();
+      }
       state_ = kLargeObjectState;
       // Fall through.
     }
     case kLargeObjectState: {
-      HeapObject* heap_object;
-      do {
-        heap_object = lo_iterator_.Next();
-        if (heap_object == NULL) {
-          state_ = kFinishedState;
-          return NULL;
-        }
-        // Fixed arrays are the only pointer-containing objects in large
-        // object space.
-      } while (!heap_object->IsFixedArray());
+      HeapObject* heap_object = lo_iterator_.Next();
+      if (heap_object == NULL) {
+        state_ = kFinishedState;
+        return NULL;
+      }
       MemoryChunk* answer = MemoryChunk::FromAddress(heap_object->address());
       return answer;
     }
@@ -7,6 +7,8 @@
 #include "src/base/bits.h"
 #include "src/base/platform/platform.h"
 #include "src/full-codegen/full-codegen.h"
+#include "src/heap/array-buffer-tracker.h"
+#include "src/heap/slot-set.h"
 #include "src/heap/slots-buffer.h"
 #include "src/macro-assembler.h"
 #include "src/msan.h"
@@ -285,7 +287,8 @@ MemoryAllocator::MemoryAllocator(Isolate* isolate)
       size_(0),
       size_executable_(0),
       lowest_ever_allocated_(reinterpret_cast<void*>(-1)),
-      highest_ever_allocated_(reinterpret_cast<void*>(0)) {}
+      highest_ever_allocated_(reinterpret_cast<void*>(0)),
+      large_page_pool_size_(0) {}
 
 
 bool MemoryAllocator::SetUp(intptr_t capacity, intptr_t capacity_executable) {
@@ -301,6 +304,11 @@ bool MemoryAllocator::SetUp(intptr_t capacity, intptr_t capacity_executable) {
 
 
 void MemoryAllocator::TearDown() {
+  ReleaseDecayedLargePages(0);
+  if (huge_page_spare_.IsReserved()) {
+    size_.Increment(-static_cast<intptr_t>(huge_page_spare_.size()));
+    FreeMemory(&huge_page_spare_, NOT_EXECUTABLE);
+  }
   // Check that spaces were torn down before MemoryAllocator.
   DCHECK(size_.Value() == 0);
   // TODO(gc) this will be true again when we fix FreeMemory.
@@ -428,7 +436,7 @@ NewSpacePage* NewSpacePage::Initialize(Heap* heap, Address start,
   MemoryChunk* chunk =
       MemoryChunk::Initialize(heap, start, Page::kPageSize, area_start,
                               area_end, NOT_EXECUTABLE, semi_space);
-  chunk->initialize_scan_on_scavenge(true);
+  chunk->SetFlag(MemoryChunk::SCAN_ON_SCAVENGE);
   bool in_to_space = (semi_space->id() != kFromSpace);
   chunk->SetFlag(in_to_space ? MemoryChunk::IN_TO_SPACE
                              : MemoryChunk::IN_FROM_SPACE);
@@ -464,8 +472,11 @@ MemoryChunk* MemoryChunk::Initialize(Heap* heap, Address base, size_t size,
   chunk->flags_ = 0;
   chunk->set_owner(owner);
   chunk->InitializeReservedMemory();
+  chunk->old_to_new_slots_ = nullptr;
+  chunk->old_to_old_slots_ = nullptr;
   chunk->slots_buffer_ = NULL;
   chunk->skip_list_ = NULL;
+  chunk->local_tracker_ = nullptr;
   chunk->write_barrier_counter_ = kWriteBarrierCounterGranularity;
   chunk->progress_bar_ = 0;
   chunk->high_water_mark_.SetValue(static_cast<intptr_t>(area_start - base));
@@ -479,7 +490,6 @@ MemoryChunk* MemoryChunk::Initialize(Heap* heap, Address base, size_t size,
   chunk->non_available_small_blocks_ = 0;
   chunk->ResetLiveBytes();
   Bitmap::Clear(chunk);
-  chunk->initialize_scan_on_scavenge(false);
   chunk->SetFlag(WAS_SWEPT);
   chunk->set_next_chunk(nullptr);
   chunk->set_prev_chunk(nullptr);
@@ -710,7 +720,13 @@ void Page::ResetFreeListStatistics() {
 
 Page* MemoryAllocator::AllocatePage(intptr_t size, PagedSpace* owner,
                                     Executability executable) {
-  MemoryChunk* chunk = AllocateChunk(size, size, executable, owner);
+  MemoryChunk* chunk = NULL;
+  if (executable == NOT_EXECUTABLE) {
+    chunk = AllocateChunkFromHugePageRegion(size, owner);
+  }
+  if (chunk == NULL) {
+    chunk = AllocateChunk(size, size, executable, owner);
+  }
   if (chunk == NULL) return NULL;
   return Page::Initialize(isolate_->heap(), chunk, executable, owner);
 }
@@ -719,13 +735,181 @@ Page* MemoryAllocator::AllocatePage(intptr_t size, PagedSpace* owner,
 LargePage* MemoryAllocator::AllocateLargePage(intptr_t object_size,
                                               Space* owner,
                                               Executability executable) {
-  MemoryChunk* chunk =
-      AllocateChunk(object_size, object_size, executable, owner);
+  MemoryChunk* chunk = NULL;
+  if (executable == NOT_EXECUTABLE) {
+    chunk = AllocateChunkFromLargePagePool(object_size, owner);
+  }
+  if (chunk == NULL) {
+    chunk = AllocateChunk(object_size, object_size, executable, owner);
+  }
   if (chunk == NULL) return NULL;
   return LargePage::Initialize(isolate_->heap(), chunk);
 }
 
 
+MemoryChunk* MemoryAllocator::AllocateChunkFromLargePagePool(
+    intptr_t object_size, Space* owner) {
+  if (!FLAG_large_page_pool) return NULL;
+  size_t chunk_size = RoundUp(MemoryChunk::kObjectStartOffset + object_size,
+                              base::OS::CommitPageSize());
+  MemoryChunk* pooled = TakeFromLargePagePool(chunk_size);
+  if (pooled == NULL) return NULL;
+
+  // The whole chunk of a large page is committed, so the pooled memory can be
+  // used as is. Its header is rebuilt from scratch below.
+  base::VirtualMemory reservation;
+  reservation.TakeControl(pooled->reserved_memory());
+  Address base = pooled->address();
+  chunk_size = pooled->size();
+  size_.Increment(static_cast<intptr_t>(reservation.size()));
+  isolate_->counters()->memory_allocated()->Increment(
+      static_cast<int>(chunk_size));
+
+  LOG(isolate_, NewEvent("MemoryChunk", base, chunk_size));
+  if (owner != NULL) {
+    ObjectSpace space = static_cast<ObjectSpace>(1 << owner->identity());
+    PerformAllocationCallback(space, kAllocationActionAllocate, chunk_size);
+  }
+
+  if (Heap::ShouldZapGarbage()) {
+    ZapBlock(base, MemoryChunk::kObjectStartOffset + object_size);
+  }
+
+  Address area_start = base + MemoryChunk::kObjectStartOffset;
+  MemoryChunk* result =
+      MemoryChunk::Initialize(isolate_->heap(), base, chunk_size, area_start,
+                              area_start + object_size, NOT_EXECUTABLE, owner);
+  result->set_reserved_memory(&reservation);
+  return result;
+}
+
+
+MemoryChunk* MemoryAllocator::AllocateChunkFromHugePageRegion(
+    intptr_t area_size, Space* owner) {
+#if V8_OS_LINUX
+  STATIC_ASSERT(kHugePageRegionSize == 2 * Page::kPageSize);
+  if (!FLAG_heap_huge_pages) return NULL;
+  size_t chunk_size = RoundUp(MemoryChunk::kObjectStartOffset + area_size,
+                              base::OS::CommitPageSize());
+  if (chunk_size != Page::kPageSize) return NULL;
+
+  base::VirtualMemory reservation;
+  Address base = NULL;
+  {
+    base::LockGuard<base::Mutex> guard(&huge_page_region_mutex_);
+    if (huge_page_spare_.IsReserved()) {
+      // The spare was committed and accounted for together with its region.
+      reservation.TakeControl(&huge_page_spare_);
+      base = static_cast<Address>(reservation.address());
+    } else {
+      base::VirtualMemory region;
+      base = AllocateAlignedMemory(kHugePageRegionSize, kHugePageRegionSize,
+                                   kHugePageRegionSize, NOT_EXECUTABLE,
+                                   &region);
+      if (base == NULL) return NULL;
+      DCHECK_EQ(base, region.address());
+      base::VirtualMemory::AdviseHugePages(base, kHugePageRegionSize);
+      region.Split(chunk_size, &huge_page_spare_);
+      reservation.TakeControl(&region);
+    }
+  }
+
+  isolate_->counters()->memory_allocated()->Increment(
+      static_cast<int>(chunk_size));
+
+  LOG(isolate_, NewEvent("MemoryChunk", base, chunk_size));
+  if (owner != NULL) {
+    ObjectSpace space = static_cast<ObjectSpace>(1 << owner->identity());
+    PerformAllocationCallback(space, kAllocationActionAllocate, chunk_size);
+  }
+
+  if (Heap::ShouldZapGarbage()) {
+    ZapBlock(base, MemoryChunk::kObjectStartOffset + area_size);
+  }
+
+  Address area_start = base + MemoryChunk::kObjectStartOffset;
+  MemoryChunk* result =
+      MemoryChunk::Initialize(isolate_->heap(), base, chunk_size, area_start,
+                              area_start + area_size, NOT_EXECUTABLE, owner);
+  result->set_reserved_memory(&reservation);
+  return result;
+#else
+  return NULL;
+#endif
+}
+
+
+bool MemoryAllocator::AddToLargePagePool(MemoryChunk* chunk) {
+  if (!FLAG_large_page_pool) return false;
+  if (chunk->owner() == NULL || chunk->owner()->identity() != LO_SPACE ||
+      chunk->executable() == EXECUTABLE ||
+      !chunk->reserved_memory()->IsReserved() ||
+      chunk->size() > kLargePagePoolMaxChunkSize) {
+    return false;
+  }
+  base::LockGuard<base::Mutex> guard(&large_page_pool_mutex_);
+  // Pooled pages are accounted with the size of their reservation, which is
+  // what PreFreeMemory took off size_.
+  intptr_t size = static_cast<intptr_t>(chunk->reserved_memory()->size());
+  if (large_page_pool_size_.Value() + size >
+      static_cast<intptr_t>(FLAG_large_page_pool_size) * MB) {
+    return false;
+  }
+  PooledLargePage entry = {chunk,
+                           isolate_->heap()->MonotonicallyIncreasingTimeInMs()};
+  large_page_pool_[LargePagePoolBucket(chunk->size())].Add(entry);
+  large_page_pool_size_.Increment(size);
+  return true;
+}
+
+
+MemoryChunk* MemoryAllocator::TakeFromLargePagePool(size_t chunk_size) {
+  if (chunk_size > kLargePagePoolMaxChunkSize) return NULL;
+  base::LockGuard<base::Mutex> guard(&large_page_pool_mutex_);
+  List<PooledLargePage>& bucket =
+      large_page_pool_[LargePagePoolBucket(chunk_size)];
+  // Prefer the most recently pooled pages, they are the most likely to still
+  // be resident.
+  for (int i = bucket.length() - 1; i >= 0; i--) {
+    MemoryChunk* chunk = bucket[i].chunk;
+    if (chunk->size() < chunk_size) continue;
+    bucket.Remove(i);
+    large_page_pool_size_.Increment(
+        -static_cast<intptr_t>(chunk->reserved_memory()->size()));
+    return chunk;
+  }
+  return NULL;
+}
+
+
+void MemoryAllocator::ReleaseDecayedLargePages(double min_age_in_ms) {
+  List<MemoryChunk*> decayed;
+  {
+    base::LockGuard<base::Mutex> guard(&large_page_pool_mutex_);
+    if (large_page_pool_size_.Value() == 0) return;
+    double now = isolate_->heap()->MonotonicallyIncreasingTimeInMs();
+    for (int i = 0; i < kLargePagePoolBuckets; i++) {
+      List<PooledLargePage>& bucket = large_page_pool_[i];
+      int j = 0;
+      while (j < bucket.length()) {
+        if (now - bucket[j].pooled_at_in_ms >= min_age_in_ms) {
+          MemoryChunk* chunk = bucket.Remove(j).chunk;
+          large_page_pool_size_.Increment(
+              -static_cast<intptr_t>(chunk->reserved_memory()->size()));
+          decayed.Add(chunk);
+        } else {
+          j++;
+        }
+      }
+    }
+  }
+  // Unmapping does not need the lock.
+  for (int i = 0; i < decayed.length(); i++) {
+    FreeMemory(decayed[i]->reserved_memory(), NOT_EXECUTABLE);
+  }
+}
+
+
 void MemoryAllocator::PreFreeMemory(MemoryChunk* chunk) {
   DCHECK(!chunk->IsFlagSet(MemoryChunk::PRE_FREED));
   LOG(isolate_, DeleteEvent("MemoryChunk", chunk));
@@ -761,6 +945,7 @@ void MemoryAllocator::PreFreeMemory(MemoryChunk* chunk) {
 void MemoryAllocator::PerformFreeMemory(MemoryChunk* chunk) {
   DCHECK(chunk->IsFlagSet(MemoryChunk::PRE_FREED));
   chunk->ReleaseAllocatedMemory();
+  if (AddToLargePagePool(chunk)) return;
 
   base::VirtualMemory* reservation = chunk->reserved_memory();
   if (reservation->IsReserved()) {
@@ -895,14 +1080,18 @@ bool MemoryAllocator::CommitExecutableMemory(base::VirtualMemory* vm,
   // Commit page header (not executable).
   Address header = start;
   size_t header_size = CodePageGuardStartOffset();
+  StatsCounter* protection_changes =
+      isolate_->counters()->memory_protection_changes();
   if (vm->Commit(header, header_size, false)) {
     // Create guard page after the header.
+    protection_changes->Increment();
     if (vm->Guard(start + CodePageGuardStartOffset())) {
       // Commit page body (executable).
       Address body = start + CodePageAreaStartOffset();
       size_t body_size = commit_size - CodePageGuardStartOffset();
       if (vm->Commit(body, body_size, true)) {
         // Create guard page before the end.
+        protection_changes->Increment();
         if (vm->Guard(start + reserved_size - CodePageGuardSize())) {
           UpdateAllocatedSpaceLimits(start, start + CodePageAreaStartOffset() +
                                                 commit_size -
@@ -933,7 +1122,45 @@ void MemoryChunk::IncrementLiveBytesFromMutator(HeapObject* object, int by) {
 void MemoryChunk::ReleaseAllocatedMemory() {
   delete slots_buffer_;
   delete skip_list_;
+  delete local_tracker_;
   delete mutex_;
+  ReleaseOldToNewSlots();
+  ReleaseOldToOldSlots();
+}
+
+
+static SlotSet* AllocateSlotSet(size_t size, Address page_start) {
+  size_t pages = (size + Page::kPageSize - 1) / Page::kPageSize;
+  DCHECK(pages > 0);
+  SlotSet* slot_set = new SlotSet[pages];
+  for (size_t i = 0; i < pages; i++) {
+    slot_set[i].SetPageStart(page_start + i * Page::kPageSize);
+  }
+  return slot_set;
+}
+
+
+void MemoryChunk::AllocateOldToNewSlots() {
+  DCHECK(nullptr == old_to_new_slots_);
+  old_to_new_slots_ = AllocateSlotSet(size_, address());
+}
+
+
+void MemoryChunk::ReleaseOldToNewSlots() {
+  delete[] old_to_new_slots_;
+  old_to_new_slots_ = nullptr;
+}
+
+
+void MemoryChunk::AllocateOldToOldSlots() {
+  DCHECK(nullptr == old_to_old_slots_);
+  old_to_old_slots_ = AllocateSlotSet(size_, address());
+}
+
+
+void MemoryChunk::ReleaseOldToOldSlots() {
+  delete[] old_to_old_slots_;
+  old_to_old_slots_ = nullptr;
 }
 
 
@@ -1240,11 +1467,6 @@ void PagedSpace::ReleasePage(Page* page) {
     DCHECK_EQ(AreaSize(), static_cast<int>(size));
   }
 
-  if (page->IsFlagSet(MemoryChunk::SCAN_ON_SCAVENGE)) {
-    heap()->decrement_scan_on_scavenge_pages();
-    page->ClearFlag(MemoryChunk::SCAN_ON_SCAVENGE);
-  }
-
   DCHECK(!free_list_.ContainsPageFreeListItems(page));
 
   if (Page::FromAllocationTop(allocation_info_.top()) == page) {
@@ -1258,6 +1480,9 @@ void PagedSpace::ReleasePage(Page* page) {
     page->Unlink();
   }
 
+  // All ArrayBuffers left on a released page are dead.
+  heap()->array_buffer_tracker()->FreeAllOnPage(page);
+
   AccountUncommitted(static_cast<intptr_t>(page->size()));
   heap()->QueueMemoryChunkForFree(page);
 
@@ -1413,6 +1638,11 @@ void NewSpace::Grow() {
   int new_capacity =
       Min(MaximumCapacity(),
           FLAG_semi_space_growth_factor * static_cast<int>(TotalCapacity()));
+  GrowTo(new_capacity);
+}
+
+
+void NewSpace::GrowTo(int new_capacity) {
   if (to_space_.GrowTo(new_capacity)) {
     // Only grow from space if we managed to grow to-space.
     if (!from_space_.GrowTo(new_capacity)) {
@@ -1460,7 +1690,23 @@ bool NewSpace::GrowOnePage() {
 
 
 void NewSpace::Shrink() {
-  int new_capacity = Max(InitialTotalCapacity(), 2 * SizeAsInt());
+  ShrinkTo(Max(InitialTotalCapacity(), 2 * SizeAsInt()));
+}
+
+
+void NewSpace::Resize(int target_capacity) {
+  int new_capacity = RoundUp(
+      Max(InitialTotalCapacity(), Min(MaximumCapacity(), target_capacity)),
+      Page::kPageSize);
+  if (new_capacity > TotalCapacity()) {
+    GrowTo(new_capacity);
+  } else if (new_capacity < TotalCapacity()) {
+    ShrinkTo(Max(new_capacity, 2 * SizeAsInt()));
+  }
+}
+
+
+void NewSpace::ShrinkTo(int new_capacity) {
   int rounded_new_capacity = RoundUp(new_capacity, Page::kPageSize);
   if (rounded_new_capacity < TotalCapacity() &&
       to_space_.ShrinkTo(rounded_new_capacity)) {
@@ -1601,6 +1847,17 @@ bool NewSpace::EnsureAllocation(int size_in_bytes,
 }
 
 
+AllocationResult NewSpace::AllocateRawSynchronized(
+    int size_in_bytes, AllocationAlignment alignment) {
+  base::LockGuard<base::Mutex> guard(&mutex_);
+  Address top_on_previous_step = top_on_previous_step_;
+  top_on_previous_step_ = 0;
+  AllocationResult result = AllocateRaw(size_in_bytes, alignment);
+  top_on_previous_step_ = top_on_previous_step;
+  return result;
+}
+
+
 void NewSpace::InlineAllocationStep(Address top, Address new_top) {
   if (top_on_previous_step_) {
     int bytes_allocated = static_cast<int>(top - top_on_previous_step_);
@@ -2335,15 +2592,26 @@ FreeList::FreeList(PagedSpace* owner)
       small_list_(this, kSmall),
       medium_list_(this, kMedium),
       large_list_(this, kLarge),
-      huge_list_(this, kHuge) {
+      huge_list_(this, kHuge),
+      published_(nullptr),
+      next_published_(nullptr) {
   Reset();
 }
 
 
-intptr_t FreeList::Concatenate(FreeList* other) {
-  intptr_t usable_bytes = 0;
-  intptr_t wasted_bytes = 0;
+FreeList::~FreeList() {
+  // The blocks of published free lists belong to pages that are released
+  // together with the owning space; only the list objects are freed here.
+  FreeList* published = published_.Value();
+  while (published != nullptr) {
+    FreeList* next = published->next_published_;
+    delete published;
+    published = next;
+  }
+}
 
+
+intptr_t FreeList::Concatenate(FreeList* other) {
   // This is safe (not going to deadlock) since Concatenate operations
   // are never performed on the same free lists at the same time in
   // reverse order. Furthermore, we only lock if the PagedSpace containing
@@ -2351,7 +2619,18 @@ intptr_t FreeList::Concatenate(FreeList* other) {
   if (!owner()->is_local()) mutex_.Lock();
   if (!other->owner()->is_local()) other->mutex()->Lock();
 
-  wasted_bytes = other->wasted_bytes_;
+  other->MergePublished();
+  intptr_t added_bytes = ConcatenateUnlocked(other);
+
+  if (!other->owner()->is_local()) other->mutex()->Unlock();
+  if (!owner()->is_local()) mutex_.Unlock();
+  return added_bytes;
+}
+
+
+intptr_t FreeList::ConcatenateUnlocked(FreeList* other) {
+  intptr_t usable_bytes = 0;
+  intptr_t wasted_bytes = other->wasted_bytes_;
   wasted_bytes_ += wasted_bytes;
   other->wasted_bytes_ = 0;
 
@@ -2359,13 +2638,36 @@ intptr_t FreeList::Concatenate(FreeList* other) {
   usable_bytes += medium_list_.Concatenate(other->GetFreeListCategory(kMedium));
   usable_bytes += large_list_.Concatenate(other->GetFreeListCategory(kLarge));
   usable_bytes += huge_list_.Concatenate(other->GetFreeListCategory(kHuge));
-
-  if (!other->owner()->is_local()) other->mutex()->Unlock();
-  if (!owner()->is_local()) mutex_.Unlock();
   return usable_bytes + wasted_bytes;
 }
 
 
+void FreeList::Publish(FreeList* other) {
+  DCHECK(other->published_.Value() == nullptr);
+  // Pushing is safe against ABA because the stack is only ever emptied as a
+  // whole by MergePublished.
+  FreeList* top;
+  do {
+    top = published_.Value();
+    other->next_published_ = top;
+  } while (!published_.TrySetValue(top, other));
+}
+
+
+void FreeList::MergePublished() {
+  FreeList* published = published_.Value();
+  while (published != nullptr && !published_.TrySetValue(published, nullptr)) {
+    published = published_.Value();
+  }
+  while (published != nullptr) {
+    FreeList* next = published->next_published_;
+    ConcatenateUnlocked(published);
+    delete published;
+    published = next;
+  }
+}
+
+
 void FreeList::Reset() {
   small_list_.Reset();
   medium_list_.Reset();
@@ -2480,6 +2782,7 @@ FreeSpace* FreeList::FindNodeFor(int size_in_bytes, int* node_size) {
 FreeSpace* FreeList::TryRemoveMemory(intptr_t hint_size_in_bytes) {
   hint_size_in_bytes = RoundDown(hint_size_in_bytes, kPointerSize);
   base::LockGuard<base::Mutex> guard(&mutex_);
+  MergePublished();
   FreeSpace* node = nullptr;
   int node_size = 0;
   // Try to find a node that fits exactly.
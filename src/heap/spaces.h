@@ -108,6 +108,11 @@ class MarkBit {
  public:
   typedef uint32_t CellType;
 
+  // Mark bits that other threads may update at the same time, i.e. while
+  // concurrent or parallel marking tasks are running, have to be accessed
+  // atomically. Markers choose the access mode statically.
+  enum AccessMode { NON_ATOMIC, ATOMIC };
+
   inline MarkBit(CellType* cell, CellType mask) : cell_(cell), mask_(mask) {}
 
 #ifdef DEBUG
@@ -129,9 +134,52 @@ class MarkBit {
     }
   }
 
-  inline void Set() { *cell_ |= mask_; }
+  template <AccessMode mode = NON_ATOMIC>
+  inline void Set() {
+    if (mode == ATOMIC) {
+      SetAtomic();
+    } else {
+      *cell_ |= mask_;
+    }
+  }
   inline bool Get() { return (*cell_ & mask_) != 0; }
-  inline void Clear() { *cell_ &= ~mask_; }
+  template <AccessMode mode = NON_ATOMIC>
+  inline void Clear() {
+    if (mode == ATOMIC) {
+      ClearAtomic();
+    } else {
+      *cell_ &= ~mask_;
+    }
+  }
+
+  // Atomically sets the bit. Returns false if it was already set.
+  inline bool SetAtomic() {
+    base::Atomic32* cell = reinterpret_cast<base::Atomic32*>(cell_);
+    base::Atomic32 old_value = base::NoBarrier_Load(cell);
+    do {
+      if (old_value & mask_) return false;
+      base::Atomic32 new_value = old_value | static_cast<base::Atomic32>(mask_);
+      base::Atomic32 seen =
+          base::Release_CompareAndSwap(cell, old_value, new_value);
+      if (seen == old_value) return true;
+      old_value = seen;
+    } while (true);
+  }
+
+  // Atomically clears the bit. Returns false if it was already clear.
+  inline bool ClearAtomic() {
+    base::Atomic32* cell = reinterpret_cast<base::Atomic32*>(cell_);
+    base::Atomic32 old_value = base::NoBarrier_Load(cell);
+    do {
+      if (!(old_value & mask_)) return false;
+      base::Atomic32 new_value =
+          old_value & ~static_cast<base::Atomic32>(mask_);
+      base::Atomic32 seen =
+          base::Release_CompareAndSwap(cell, old_value, new_value);
+      if (seen == old_value) return true;
+      old_value = seen;
+    } while (true);
+  }
 
   CellType* cell_;
   CellType mask_;
@@ -284,7 +332,9 @@ class Bitmap {
 };
 
 
+class LocalArrayBufferTracker;
 class SkipList;
+class SlotSet;
 class SlotsBuffer;
 
 // MemoryChunk represents a memory region owned by a specific space.
@@ -298,6 +348,7 @@ class MemoryChunk {
     ABOUT_TO_BE_FREED,
     POINTERS_TO_HERE_ARE_INTERESTING,
     POINTERS_FROM_HERE_ARE_INTERESTING,
+    // Set on new-space pages, whose slots are not remembered.
     SCAN_ON_SCAVENGE,
     IN_FROM_SPACE,  // Mutually exclusive with IN_TO_SPACE.
     IN_TO_SPACE,    // All pages in new space has one of these two set.
@@ -389,19 +440,21 @@ class MemoryChunk {
       + 2 * kPointerSize          // base::VirtualMemory reservation_
       + kPointerSize              // Address owner_
       + kPointerSize              // Heap* heap_
-      + kIntSize;                 // int store_buffer_counter_
+      + kIntSize;                 // int progress_bar_
 
-  static const size_t kSlotsBufferOffset =
+  static const size_t kOldToNewSlotsOffset =
       kLiveBytesOffset + kIntSize;  // int live_byte_count_
 
   static const size_t kWriteBarrierCounterOffset =
-      kSlotsBufferOffset + kPointerSize  // SlotsBuffer* slots_buffer_;
-      + kPointerSize;                    // SkipList* skip_list_;
+      kOldToNewSlotsOffset + kPointerSize  // SlotSet* old_to_new_slots_;
+      + kPointerSize                       // SlotSet* old_to_old_slots_;
+      + kPointerSize                       // SlotsBuffer* slots_buffer_;
+      + kPointerSize                       // SkipList* skip_list_;
+      + kPointerSize;                      // LocalArrayBufferTracker*
 
   static const size_t kMinHeaderSize =
       kWriteBarrierCounterOffset +
       kIntptrSize         // intptr_t write_barrier_counter_
-      + kIntSize          // int progress_bar_
       + kPointerSize      // AtomicValue high_water_mark_
       + kPointerSize      // base::Mutex* mutex_
       + kPointerSize      // base::AtomicWord parallel_sweeping_
@@ -503,19 +556,6 @@ class MemoryChunk {
   }
 
   bool scan_on_scavenge() { return IsFlagSet(SCAN_ON_SCAVENGE); }
-  void initialize_scan_on_scavenge(bool scan) {
-    if (scan) {
-      SetFlag(SCAN_ON_SCAVENGE);
-    } else {
-      ClearFlag(SCAN_ON_SCAVENGE);
-    }
-  }
-  inline void set_scan_on_scavenge(bool scan);
-
-  int store_buffer_counter() { return store_buffer_counter_; }
-  void set_store_buffer_counter(int counter) {
-    store_buffer_counter_ = counter;
-  }
 
   bool Contains(Address addr) {
     return addr >= area_start() && addr < area_end();
@@ -693,8 +733,22 @@ class MemoryChunk {
 
   inline void set_skip_list(SkipList* skip_list) { skip_list_ = skip_list; }
 
+  inline LocalArrayBufferTracker* local_tracker() { return local_tracker_; }
+
+  inline void set_local_tracker(LocalArrayBufferTracker* local_tracker) {
+    local_tracker_ = local_tracker;
+  }
+
   inline SlotsBuffer* slots_buffer() { return slots_buffer_; }
 
+  inline SlotSet* old_to_new_slots() { return old_to_new_slots_; }
+  inline SlotSet* old_to_old_slots() { return old_to_old_slots_; }
+
+  void AllocateOldToNewSlots();
+  void ReleaseOldToNewSlots();
+  void AllocateOldToOldSlots();
+  void ReleaseOldToOldSlots();
+
   inline SlotsBuffer** slots_buffer_address() { return &slots_buffer_; }
 
   void MarkEvacuationCandidate() {
@@ -738,17 +792,21 @@ class MemoryChunk {
   // in a fixed array.
   Address owner_;
   Heap* heap_;
-  // Used by the store buffer to keep track of which pages to mark scan-on-
-  // scavenge.
-  int store_buffer_counter_;
+  // Used by the incremental marker to keep track of the scanning progress in
+  // large objects that have a progress bar and are scanned in increments.
+  int progress_bar_;
   // Count of bytes marked black on page.
   int live_byte_count_;
+  // A single slot set for small pages (of size kPageSize) or an array of slot
+  // set for large pages. In the latter case the number of entries in the array
+  // is ceil(size() / kPageSize).
+  SlotSet* old_to_new_slots_;
+  SlotSet* old_to_old_slots_;
   SlotsBuffer* slots_buffer_;
   SkipList* skip_list_;
+  // Backing stores of the ArrayBuffers on this page; allocated lazily.
+  LocalArrayBufferTracker* local_tracker_;
   intptr_t write_barrier_counter_;
-  // Used by the incremental marker to keep track of the scanning progress in
-  // large objects that have a progress bar and are scanned in increments.
-  int progress_bar_;
   // Assuming the initial allocation on a page is sequential,
   // count highest number of bytes ever allocated on the page.
   AtomicValue<intptr_t> high_water_mark_;
@@ -1030,8 +1088,8 @@ class MemoryChunkValidator {
   STATIC_ASSERT(MemoryChunk::kSizeOffset == offsetof(MemoryChunk, size_));
   STATIC_ASSERT(MemoryChunk::kLiveBytesOffset ==
                 offsetof(MemoryChunk, live_byte_count_));
-  STATIC_ASSERT(MemoryChunk::kSlotsBufferOffset ==
-                offsetof(MemoryChunk, slots_buffer_));
+  STATIC_ASSERT(MemoryChunk::kOldToNewSlotsOffset ==
+                offsetof(MemoryChunk, old_to_new_slots_));
   STATIC_ASSERT(MemoryChunk::kWriteBarrierCounterOffset ==
                 offsetof(MemoryChunk, write_barrier_counter_));
 
@@ -1221,8 +1279,19 @@ class MemoryAllocator {
   // together.
   void Free(MemoryChunk* chunk);
 
-  // Returns allocated spaces in bytes.
-  intptr_t Size() { return size_.Value(); }
+  // Non-executable large pages are not unmapped right away when they are
+  // freed but kept in a pool, bucketed by size, from which AllocateLargePage
+  // serves later allocations of a similar size. Returns the number of bytes
+  // currently held by the pool. These bytes stay mapped and are included in
+  // Size().
+  intptr_t LargePagePoolSize() { return large_page_pool_size_.Value(); }
+
+  // Unmaps the pooled large pages that have been in the pool for at least
+  // |min_age_in_ms|. Can be called concurrently.
+  void ReleaseDecayedLargePages(double min_age_in_ms);
+
+  // Returns allocated spaces in bytes, including the large page pool.
+  intptr_t Size() { return size_.Value() + LargePagePoolSize(); }
 
   // Returns allocated executable spaces in bytes.
   intptr_t SizeExecutable() { return size_executable_.Value(); }
@@ -1359,6 +1428,48 @@ class MemoryAllocator {
   // A List of callback that are triggered when memory is allocated or free'd
   List<MemoryAllocationCallbackRegistration> memory_allocation_callbacks_;
 
+  // Pooled chunks of one bucket have sizes within kLargePagePoolGranularity
+  // of each other, which bounds the memory wasted by a reuse.
+  static const int kLargePagePoolGranularity = 256 * KB;
+  static const int kLargePagePoolBuckets = 32;
+  static const size_t kLargePagePoolMaxChunkSize =
+      kLargePagePoolBuckets * kLargePagePoolGranularity;
+
+  struct PooledLargePage {
+    MemoryChunk* chunk;
+    double pooled_at_in_ms;
+  };
+
+  static int LargePagePoolBucket(size_t chunk_size) {
+    DCHECK(chunk_size <= kLargePagePoolMaxChunkSize);
+    return static_cast<int>((chunk_size - 1) / kLargePagePoolGranularity);
+  }
+
+  // Returns true if the pool took ownership of the pre-freed |chunk|.
+  bool AddToLargePagePool(MemoryChunk* chunk);
+
+  // Returns a pooled chunk of at least |chunk_size| bytes or NULL.
+  MemoryChunk* TakeFromLargePagePool(size_t chunk_size);
+
+  MemoryChunk* AllocateChunkFromLargePagePool(intptr_t object_size,
+                                              Space* owner);
+
+  // With --heap-huge-pages, regular pages are carved out of committed
+  // regions of kHugePageRegionSize bytes that are aligned to their size and
+  // advised to be backed by transparent huge pages. The second page of a
+  // region is kept as a spare for the next allocation.
+  static const size_t kHugePageRegionSize = 2 * MB;
+
+  MemoryChunk* AllocateChunkFromHugePageRegion(intptr_t area_size,
+                                               Space* owner);
+
+  base::Mutex huge_page_region_mutex_;
+  base::VirtualMemory huge_page_spare_;
+
+  base::Mutex large_page_pool_mutex_;
+  List<PooledLargePage> large_page_pool_[kLargePagePoolBuckets];
+  AtomicNumber<intptr_t> large_page_pool_size_;
+
   // Initializes pages in a chunk. Returns the first page address.
   // This function and GetChunkId() are provided for the mark-compact
   // collector to rebuild page headers in the from space, which is
@@ -1718,6 +1829,7 @@ class FreeList {
   }
 
   explicit FreeList(PagedSpace* owner);
+  ~FreeList();
 
   // The method concatenates {other} into {this} and returns the added bytes,
   // including waste.
@@ -1725,6 +1837,16 @@ class FreeList {
   // Note: Thread-safe.
   intptr_t Concatenate(FreeList* other);
 
+  // Hands {other} over to this free list without taking the mutex. {other}
+  // has to be heap allocated; this free list takes ownership of it. Published
+  // free lists are merged in O(1) per list by the next Concatenate or
+  // TryRemoveMemory that takes memory out of this free list. Sweeper tasks
+  // collect the pages they sweep in a private free list and publish it every
+  // few pages, without blocking the allocating threads.
+  //
+  // Note: Thread-safe and lock-free.
+  void Publish(FreeList* other);
+
   // Adds a node on the free list. The block of size {size_in_bytes} starting
   // at {start} is placed on the free list. The return value is the number of
   // bytes that were not added to the free list, because they freed memory block
@@ -1759,7 +1881,8 @@ class FreeList {
 
   bool IsEmpty() {
     return small_list_.IsEmpty() && medium_list_.IsEmpty() &&
-           large_list_.IsEmpty() && huge_list_.IsEmpty();
+           large_list_.IsEmpty() && huge_list_.IsEmpty() &&
+           published_.Value() == nullptr;
   }
 
   // Used after booting the VM.
@@ -1794,6 +1917,14 @@ class FreeList {
   FreeSpace* FindNodeFor(int size_in_bytes, int* node_size);
   FreeSpace* FindNodeIn(FreeListCategoryType category, int* node_size);
 
+  // Moves the blocks of {other} into this free list. Callers have to hold
+  // the mutexes of shared free lists.
+  intptr_t ConcatenateUnlocked(FreeList* other);
+
+  // Merges the free lists pushed by Publish. Requires the mutex unless the
+  // free list is local.
+  void MergePublished();
+
   FreeListCategory* GetFreeListCategory(FreeListCategoryType category) {
     switch (category) {
       case kSmall:
@@ -1819,6 +1950,11 @@ class FreeList {
   FreeListCategory large_list_;
   FreeListCategory huge_list_;
 
+  // Lock-free stack of free lists handed over with Publish, linked through
+  // their next_published_ fields.
+  AtomicValue<FreeList*> published_;
+  FreeList* next_published_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(FreeList);
 };
 
@@ -2548,6 +2684,11 @@ class NewSpace : public Space {
   // Shrink the capacity of the semispaces.
   void Shrink();
 
+  // Grows or shrinks the capacity of the semispaces towards
+  // |target_capacity|, bounded by the initial and maximum capacity. The new
+  // space is not shrunk below twice its current size.
+  void Resize(int target_capacity);
+
   // True if the address or object lies in the address range of either
   // semispace (not necessarily below the allocation pointer).
   bool Contains(Address a) {
@@ -2690,6 +2831,13 @@ class NewSpace : public Space {
   MUST_USE_RESULT INLINE(AllocationResult AllocateRaw(
       int size_in_bytes, AllocationAlignment alignment));
 
+  // Allocates in to-space while holding the space lock. This is used by
+  // parallel scavenging tasks to obtain their local allocation buffers.
+  // Inline allocation steps are not performed since they must only ever
+  // happen on the main thread.
+  MUST_USE_RESULT AllocationResult
+  AllocateRawSynchronized(int size_in_bytes, AllocationAlignment alignment);
+
   // Reset the allocation pointer to the beginning of the active semispace.
   void ResetAllocationInfo();
 
@@ -2773,6 +2921,11 @@ class NewSpace : public Space {
   // Update allocation info to match the current to-space page.
   void UpdateAllocationInfo();
 
+  // Set the capacity of both semispaces, which must be larger respectively
+  // smaller than the current one.
+  void GrowTo(int new_capacity);
+  void ShrinkTo(int new_capacity);
+
   Address chunk_base_;
   uintptr_t chunk_size_;
 
@@ -2800,6 +2953,9 @@ class NewSpace : public Space {
 
   Address top_on_previous_step_;
 
+  // Guards concurrent allocation through AllocateRawSynchronized.
+  base::Mutex mutex_;
+
   HistogramInfo* allocated_histogram_;
   HistogramInfo* promoted_histogram_;
 
@@ -3037,10 +3193,17 @@ class PointerChunkIterator BASE_EMBEDDED {
   inline MemoryChunk* next();
 
  private:
-  enum State { kOldSpaceState, kMapState, kLargeObjectState, kFinishedState };
+  enum State {
+    kOldSpaceState,
+    kMapState,
+    kCodeState,
+    kLargeObjectState,
+    kFinishedState
+  };
   State state_;
   PageIterator old_iterator_;
   PageIterator map_iterator_;
+  PageIterator code_iterator_;
   LargeObjectIterator lo_iterator_;
 };
 
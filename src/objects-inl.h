@@ -1702,6 +1702,7 @@ void AllocationSite::Initialize() {
   set_nested_site(Smi::FromInt(0));
   set_pretenure_data(0);
   set_pretenure_create_count(0);
+  set_pretenure_history(0);
   set_dependent_code(DependentCode::cast(GetHeap()->empty_fixed_array()),
                      SKIP_WRITE_BARRIER);
 }
@@ -1845,6 +1846,38 @@ void AllocationSite::set_memento_create_count(int count) {
 }
 
 
+void AllocationSite::RecordSurvivalSample(double ratio) {
+  int bucket = static_cast<int>(ratio * kSurvivalBuckets);
+  bucket = Max(0, Min(kSurvivalBuckets - 1, bucket));
+  int value = pretenure_history();
+  int samples = SurvivalSamplesBits::decode(value);
+  samples = ((samples << kSurvivalBucketBits) | bucket) &
+            SurvivalSamplesBits::kMax;
+  int count = Min(kSurvivalSamples, SurvivalSampleCountBits::decode(value) + 1);
+  value = SurvivalSamplesBits::update(value, samples);
+  set_pretenure_history(SurvivalSampleCountBits::update(value, count));
+}
+
+
+int AllocationSite::survival_sample_count() {
+  return SurvivalSampleCountBits::decode(pretenure_history());
+}
+
+
+int AllocationSite::UpdateDecisionStreak(bool above_threshold) {
+  int value = pretenure_history();
+  int streak = DecisionStreakBits::decode(value);
+  if (streak > 0 && DecisionStreakHighBit::decode(value) == above_threshold) {
+    streak = Min(streak + 1, static_cast<int>(DecisionStreakBits::kMax));
+  } else {
+    streak = 1;
+  }
+  value = DecisionStreakBits::update(value, streak);
+  set_pretenure_history(DecisionStreakHighBit::update(value, above_threshold));
+  return streak;
+}
+
+
 inline bool AllocationSite::IncrementMementoFoundCount() {
   if (IsZombie()) return false;
 
@@ -1865,10 +1898,18 @@ inline bool AllocationSite::MakePretenureDecision(
     PretenureDecision current_decision,
     double ratio,
     bool maximum_size_scavenge) {
+  bool above_threshold = ratio * 100 >= FLAG_pretenuring_tenure_threshold;
+  // A decision is only made once the survival rate stayed on the same side of
+  // the threshold for the configured number of GCs in a row.
+  int streak = UpdateDecisionStreak(above_threshold);
+  if (streak < Min(FLAG_pretenuring_hysteresis,
+                   static_cast<int>(DecisionStreakBits::kMax))) {
+    return false;
+  }
   // Here we just allow state transitions from undecided or maybe tenure
   // to don't tenure, maybe tenure, or tenure.
   if ((current_decision == kUndecided || current_decision == kMaybeTenure)) {
-    if (ratio >= kPretenureRatio) {
+    if (above_threshold) {
       // We just transition into tenure state when the semi-space was at
       // maximum capacity.
       if (maximum_size_scavenge) {
@@ -1899,14 +1940,17 @@ inline bool AllocationSite::DigestPretenuringFeedback(
   PretenureDecision current_decision = pretenure_decision();
 
   if (minimum_mementos_created) {
+    RecordSurvivalSample(ratio);
     deopt = MakePretenureDecision(
         current_decision, ratio, maximum_size_scavenge);
   }
 
   if (FLAG_trace_pretenuring_statistics) {
     PrintF(
-        "AllocationSite(%p): (created, found, ratio) (%d, %d, %f) %s => %s\n",
+        "AllocationSite(%p): (created, found, ratio, streak) (%d, %d, %f, %d) "
+        "%s => %s\n",
          static_cast<void*>(this), create_count, found_count, ratio,
+         DecisionStreakBits::decode(pretenure_history()),
          PretenureDecisionName(current_decision),
          PretenureDecisionName(pretenure_decision()));
   }
@@ -5719,6 +5763,7 @@ ACCESSORS(AllocationSite, nested_site, Object, kNestedSiteOffset)
 SMI_ACCESSORS(AllocationSite, pretenure_data, kPretenureDataOffset)
 SMI_ACCESSORS(AllocationSite, pretenure_create_count,
               kPretenureCreateCountOffset)
+SMI_ACCESSORS(AllocationSite, pretenure_history, kPretenureHistoryOffset)
 ACCESSORS(AllocationSite, dependent_code, DependentCode,
           kDependentCodeOffset)
 ACCESSORS(AllocationSite, weak_next, Object, kWeakNextOffset)
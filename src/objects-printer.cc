@@ -1093,6 +1093,7 @@ void AllocationSite::AllocationSitePrint(std::ostream& os) {  // NOLINT
      << Brief(Smi::FromInt(memento_create_count()));
   os << "\n - pretenure decision: "
      << Brief(Smi::FromInt(pretenure_decision()));
+  os << "\n - survival samples: " << survival_sample_count();
   os << "\n - transition_info: ";
   if (transition_info()->IsSmi()) {
     ElementsKind kind = GetElementsKind();
@@ -14232,13 +14232,28 @@ bool JSArray::SetLengthWouldNormalize(uint32_t new_length) {
 }
 
 
-const double AllocationSite::kPretenureRatio = 0.85;
-
-
 void AllocationSite::ResetPretenureDecision() {
   set_pretenure_decision(kUndecided);
   set_memento_found_count(0);
   set_memento_create_count(0);
+  // Keep the survival samples for reporting, but start a new streak.
+  set_pretenure_history(
+      DecisionStreakBits::update(pretenure_history(), 0));
+}
+
+
+int AllocationSite::SurvivalSamplesInBucket(int bucket) {
+  int value = pretenure_history();
+  int samples = SurvivalSamplesBits::decode(value);
+  int count = SurvivalSampleCountBits::decode(value);
+  int result = 0;
+  for (int i = 0; i < count; i++) {
+    if (((samples >> (i * kSurvivalBucketBits)) & (kSurvivalBuckets - 1)) ==
+        bucket) {
+      result++;
+    }
+  }
+  return result;
 }
 
 
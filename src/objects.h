@@ -8061,9 +8061,13 @@ enum AllocationSiteMode {
 class AllocationSite: public Struct {
  public:
   static const uint32_t kMaximumArrayBytesToPretransition = 8 * 1024;
-  static const double kPretenureRatio;
   static const int kPretenureMinimumCreated = 100;
 
+  // The survival rates of the last kSurvivalSamples GCs are recorded in
+  // kSurvivalBuckets buckets of equal width.
+  static const int kSurvivalBuckets = 8;
+  static const int kSurvivalSamples = 6;
+
   // Values for pretenure decision field.
   enum PretenureDecision {
     kUndecided = 0,
@@ -8083,6 +8087,7 @@ class AllocationSite: public Struct {
   DECL_ACCESSORS(nested_site, Object)
   DECL_INT_ACCESSORS(pretenure_data)
   DECL_INT_ACCESSORS(pretenure_create_count)
+  DECL_INT_ACCESSORS(pretenure_history)
   DECL_ACCESSORS(dependent_code, DependentCode)
   DECL_ACCESSORS(weak_next, Object)
 
@@ -8102,6 +8107,20 @@ class AllocationSite: public Struct {
   class DeoptDependentCodeBit:  public BitField<bool,              29, 1> {};
   STATIC_ASSERT(PretenureDecisionBits::kMax >= kLastPretenureDecisionValue);
 
+  // Bitfields for pretenure_history. The survival samples form a shift
+  // register of bucket indices, the most recent sample in the lowest bits.
+  // The decision streak counts the consecutive samples that were on the
+  // same side of the tenuring threshold.
+  class SurvivalSamplesBits:     public BitField<int,   0, 18> {};
+  class SurvivalSampleCountBits: public BitField<int,  18,  3> {};
+  class DecisionStreakBits:      public BitField<int,  21,  4> {};
+  class DecisionStreakHighBit:   public BitField<bool, 25,  1> {};
+  static const int kSurvivalBucketBits = 3;
+  STATIC_ASSERT((1 << kSurvivalBucketBits) == kSurvivalBuckets);
+  STATIC_ASSERT(kSurvivalSamples * kSurvivalBucketBits ==
+                SurvivalSamplesBits::kSize);
+  STATIC_ASSERT(SurvivalSampleCountBits::kMax >= kSurvivalSamples);
+
   // Increments the mementos found counter and returns true when the first
   // memento was found for a given allocation site.
   inline bool IncrementMementoFoundCount();
@@ -8124,6 +8143,15 @@ class AllocationSite: public Struct {
   inline int memento_create_count();
   inline void set_memento_create_count(int count);
 
+  // Records the survival rate of the last GC in the pretenuring history.
+  inline void RecordSurvivalSample(double ratio);
+
+  // Number of survival samples in the history, at most kSurvivalSamples.
+  inline int survival_sample_count();
+
+  // Number of recorded survival samples that fall into the given bucket.
+  int SurvivalSamplesInBucket(int bucket);
+
   // The pretenuring decision is made during gc, and the zombie state allows
   // us to recognize when an allocation site is just being kept alive because
   // a later traversal of new space may discover AllocationMementos that point
@@ -8165,8 +8193,10 @@ class AllocationSite: public Struct {
   static const int kPretenureDataOffset = kNestedSiteOffset + kPointerSize;
   static const int kPretenureCreateCountOffset =
       kPretenureDataOffset + kPointerSize;
-  static const int kDependentCodeOffset =
+  static const int kPretenureHistoryOffset =
       kPretenureCreateCountOffset + kPointerSize;
+  static const int kDependentCodeOffset =
+      kPretenureHistoryOffset + kPointerSize;
   static const int kWeakNextOffset = kDependentCodeOffset + kPointerSize;
   static const int kSize = kWeakNextOffset + kPointerSize;
 
@@ -8183,6 +8213,10 @@ class AllocationSite: public Struct {
  private:
   inline bool PretenuringDecisionMade();
 
+  // Extends the streak of samples on one side of the tenuring threshold and
+  // returns its length.
+  inline int UpdateDecisionStreak(bool above_threshold);
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(AllocationSite);
 };
 
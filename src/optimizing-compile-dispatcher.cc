@@ -65,7 +65,11 @@ class OptimizingCompileDispatcher::CompileTask : public v8::Task {
             dispatcher->recompilation_delay_));
       }
 
-      dispatcher->CompileNext(dispatcher->NextInput(true));
+      if (dispatcher->max_tasks_ > 0) {
+        dispatcher->CompileBatch();
+      } else {
+        dispatcher->CompileNext(dispatcher->NextInput(true));
+      }
     }
     {
       base::LockGuard<base::Mutex> lock_guard(&dispatcher->ref_count_mutex_);
@@ -89,6 +93,7 @@ OptimizingCompileDispatcher::~OptimizingCompileDispatcher() {
   }
 #endif
   DCHECK_EQ(0, input_queue_length_);
+  DCHECK_EQ(0, running_tasks_);
   DeleteArray(input_queue_);
   if (FLAG_concurrent_osr) {
 #ifdef DEBUG
@@ -139,6 +144,34 @@ void OptimizingCompileDispatcher::CompileNext(OptimizedCompileJob* job) {
 }
 
 
+void OptimizingCompileDispatcher::CompileBatch() {
+  for (;;) {
+    {
+      // Give up the slot only once the input queue is empty, so that a job
+      // queued while all tasks were running is not left behind.
+      base::LockGuard<base::Mutex> access_input_queue_(&input_queue_mutex_);
+      if (input_queue_length_ == 0) {
+        running_tasks_--;
+        return;
+      }
+    }
+    CompileNext(NextInput(true));
+  }
+}
+
+
+void OptimizingCompileDispatcher::StartCompileTask() {
+  if (max_tasks_ > 0) {
+    base::LockGuard<base::Mutex> access_input_queue_(&input_queue_mutex_);
+    // One of the running tasks picks up the job when it is done.
+    if (running_tasks_ >= max_tasks_) return;
+    running_tasks_++;
+  }
+  V8::GetCurrentPlatform()->CallOnBackgroundThread(
+      new CompileTask(isolate_), v8::Platform::kShortRunningTask);
+}
+
+
 void OptimizingCompileDispatcher::FlushOutputQueue(bool restore_function_code) {
   for (;;) {
     OptimizedCompileJob* job = NULL;
@@ -277,16 +310,14 @@ void OptimizingCompileDispatcher::QueueForOptimization(
   if (FLAG_block_concurrent_recompilation) {
     blocked_jobs_++;
   } else {
-    V8::GetCurrentPlatform()->CallOnBackgroundThread(
-        new CompileTask(isolate_), v8::Platform::kShortRunningTask);
+    StartCompileTask();
   }
 }
 
 
 void OptimizingCompileDispatcher::Unblock() {
   while (blocked_jobs_ > 0) {
-    V8::GetCurrentPlatform()->CallOnBackgroundThread(
-        new CompileTask(isolate_), v8::Platform::kShortRunningTask);
+    StartCompileTask();
     blocked_jobs_--;
   }
 }
@@ -34,6 +34,8 @@ class OptimizingCompileDispatcher {
         osr_attempts_(0),
         blocked_jobs_(0),
         ref_count_(0),
+        max_tasks_(FLAG_concurrent_recompilation_tasks),
+        running_tasks_(0),
         recompilation_delay_(FLAG_concurrent_recompilation_delay) {
     base::NoBarrier_Store(&mode_, static_cast<base::AtomicWord>(COMPILE));
     input_queue_ = NewArray<OptimizedCompileJob*>(input_queue_capacity_);
@@ -80,6 +82,8 @@ class OptimizingCompileDispatcher {
   void FlushOutputQueue(bool restore_function_code);
   void FlushOsrBuffer(bool restore_function_code);
   void CompileNext(OptimizedCompileJob* job);
+  void CompileBatch();
+  void StartCompileTask();
   OptimizedCompileJob* NextInput(bool check_if_flushing = false);
 
   // Add a recompilation task for OSR to the cyclic buffer, awaiting OSR entry.
@@ -124,6 +128,13 @@ class OptimizingCompileDispatcher {
   base::Mutex ref_count_mutex_;
   base::ConditionVariable ref_count_zero_;
 
+  // Copy of FLAG_concurrent_recompilation_tasks. If non-zero, at most this
+  // many tasks run at the same time, each taking jobs off the input queue
+  // until it is empty. The number of running tasks is guarded by
+  // {input_queue_mutex_}.
+  int max_tasks_;
+  int running_tasks_;
+
   // Copy of FLAG_concurrent_recompilation_delay that will be used from the
   // background thread.
   //
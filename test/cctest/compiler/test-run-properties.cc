@@ -137,3 +137,36 @@ TEST(TypedArrayStore) {
   TypedArrayStoreHelper<double>("Float64");
   // TODO(mstarzinger): Add tests for ClampedUint8.
 }
+
+
+static int bounds_checks_eliminated = 0;
+
+static int* LookupCounter(const char* name) {
+  return strcmp(name, "c:V8.TurboBoundsChecksEliminated") == 0
+             ? &bounds_checks_eliminated
+             : nullptr;
+}
+
+
+TEST(TypedArrayLoadInLoopWithoutBoundsCheck) {
+  FLAG_turbo_bounds_check_elimination = true;
+  reinterpret_cast<v8::Isolate*>(CcTest::InitIsolateOnce())
+      ->SetCounterFunction(LookupCounter);
+  // The induction variable {j} stays within the array, so the checked load
+  // of x[j] becomes an unchecked one.
+  const char* source =
+      "(function() {"
+      "  var x = new Float64Array(64);"
+      "  for (var i = 0; i < 64; i++) x[i] = i;"
+      "  function f() {"
+      "    var s = 0;"
+      "    for (var j = 0; j < 64; j++) s += x[j];"
+      "    return s;"
+      "  }"
+      "  return f;"
+      "})()";
+  FunctionTester T(source, CompilationInfo::kFunctionContextSpecializing |
+                               CompilationInfo::kTypingEnabled);
+  CHECK_EQ(1, bounds_checks_eliminated);
+  T.CheckCall(T.Val(64 * 63 / 2));
+}
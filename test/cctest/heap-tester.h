@@ -18,6 +18,7 @@
   V(NoPromotion)                        \
   V(NumberStringCacheSize)              \
   V(ObjectGroups)                       \
+  V(ParallelScavenge)                   \
   V(Promotion)                          \
   V(Regression39128)                    \
   V(ResetWeakHandle)                    \
@@ -34,7 +34,9 @@
 #include "src/execution.h"
 #include "src/factory.h"
 #include "src/global-handles.h"
+#include "src/heap/concurrent-marking.h"
 #include "src/heap/gc-tracer.h"
+#include "src/heap/scavenger.h"
 #include "src/ic/ic.h"
 #include "src/macro-assembler.h"
 #include "src/snapshot/snapshot.h"
@@ -6321,5 +6323,773 @@ TEST(Regress519319) {
 }
 
 
+// The parallel and concurrent GC tests below share root.list, an array of
+// objects that each reference a few other objects.
+static void CreateObjectList(int length) {
+  i::EmbeddedVector<char, 256> source;
+  i::SNPrintF(source,
+              "var root = { list: [] };"
+              "for (var i = 0; i < %d; i++) {"
+              "  root.list.push({ a: i, b: [i, 'str' + i], c: { d: i * 2 } });"
+              "}",
+              length);
+  CompileRun(source.start());
+}
+
+
+// Replaces the objects referenced by every {step}-th element of root.list
+// with new ones.
+static void RefreshObjectList(int step) {
+  i::EmbeddedVector<char, 256> source;
+  i::SNPrintF(source,
+              "for (var i = 0; i < root.list.length; i += %d) {"
+              "  var o = root.list[i];"
+              "  o.b = [o.a, 'str' + o.a];"
+              "  o.c = { d: o.a * 2 };"
+              "}",
+              step);
+  CompileRun(source.start());
+}
+
+
+// Checks that the elements of root.list are intact. Their order may have
+// changed.
+static void CheckObjectList() {
+  CHECK(CompileRun(
+            "(function() {"
+            "  for (var i = 0; i < root.list.length; i++) {"
+            "    var o = root.list[i];"
+            "    if (o.b[0] !== o.a || o.b[1] !== 'str' + o.a ||"
+            "        o.c.d !== o.a * 2) {"
+            "      return false;"
+            "    }"
+            "  }"
+            "  return true;"
+            "})()")->BooleanValue(CcTest::isolate()->GetCurrentContext())
+            .FromJust());
+}
+
+
+HEAP_TEST(ParallelScavenge) {
+  i::FLAG_parallel_scavenge = true;
+  i::FLAG_scavenge_tasks = 4;
+  // Scavenges are sequential while incremental marking is on.
+  i::FLAG_incremental_marking = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Heap* heap = CcTest::heap();
+  Scavenger* scavenger = heap->scavenge_collector_;
+
+  // Promote the list so that the new objects below are reachable only
+  // through old-to-new slots.
+  CreateObjectList(10000);
+  heap->CollectGarbage(NEW_SPACE);
+  heap->CollectGarbage(NEW_SPACE);
+  CompileRun(
+      "var ta = new Float64Array(16);"
+      "for (var i = 0; i < 16; i++) ta[i] = i / 2;"
+      "root.ta = ta;");
+  RefreshObjectList(1);
+  heap->CollectGarbage(NEW_SPACE);
+  // Every task ran, and the new objects were copied or promoted through the
+  // buffers of the tasks that picked them up.
+  CHECK_EQ(i::FLAG_scavenge_tasks, scavenger->parallel_scavenge_tasks());
+  CHECK_LT(10000 * kPointerSize, heap->SurvivedNewSpaceObjectSize());
+  for (int i = 0; i < 3; i++) heap->CollectGarbage(NEW_SPACE);
+
+  CheckObjectList();
+  CHECK(CompileRun(
+            "(function() {"
+            "  for (var i = 0; i < 16; i++) {"
+            "    if (root.ta[i] !== i / 2) return false;"
+            "  }"
+            "  return true;"
+            "})()")->BooleanValue(CcTest::isolate()->GetCurrentContext())
+            .FromJust());
+}
+
+
+TEST(ConcurrentMarking) {
+  i::FLAG_concurrent_marking = true;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Heap* heap = CcTest::heap();
+  ConcurrentMarking* concurrent_marking = heap->concurrent_marking();
+
+  CreateObjectList(10000);
+  heap->CollectAllGarbage();
+  SimulateIncrementalMarking(heap, false);
+  heap->incremental_marking()->Step(i::MB,
+                                    IncrementalMarking::NO_GC_VIA_STACK_GUARD);
+  CHECK(concurrent_marking->IsTaskPending());
+  // Move objects around while the background task may be tracing them.
+  CompileRun(
+      "for (var i = 0; i < 5000; i++) {"
+      "  var o = root.list[i];"
+      "  root.list[i] = root.list[9999 - i];"
+      "  root.list[9999 - i] = o;"
+      "}");
+  RefreshObjectList(1);
+  // Let the task run to completion instead of preempting it.
+  while (!concurrent_marking->TryFinishTask()) {
+    base::OS::Sleep(base::TimeDelta::FromMilliseconds(1));
+  }
+  CHECK_LT(0, concurrent_marking->total_bytes_marked());
+  SimulateIncrementalMarking(heap);
+  heap->CollectAllGarbage();
+
+  CheckObjectList();
+}
+
+
+TEST(ParallelMarking) {
+  i::FLAG_parallel_marking = true;
+  i::FLAG_marking_tasks = 4;
+  i::FLAG_always_compact = true;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Heap* heap = CcTest::heap();
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+
+  CreateObjectList(10000);
+  CompileRun(
+      "root.fns = [];"
+      "for (var i = 0; i < 100; i++) {"
+      "  root.fns.push(function() { return i; });"
+      "}"
+      "var weak = new WeakMap();"
+      "for (var i = 0; i < 100; i++) weak.set(root.list[i], { v: i });");
+  heap->CollectAllGarbage();
+  RefreshObjectList(2);
+  heap->CollectAllGarbage();
+  // Background tasks may start late on a loaded machine, in which case the
+  // main thread does all the work. Give them a few GCs.
+  for (int i = 0;
+       i < 10 && collector->parallel_marking_background_bytes() == 0; i++) {
+    heap->CollectAllGarbage();
+  }
+  CHECK_LT(0, collector->parallel_marking_background_bytes());
+
+  CheckObjectList();
+  CHECK(CompileRun(
+            "(function() {"
+            "  for (var i = 0; i < 100; i++) {"
+            "    if (weak.get(root.list[i]).v !== i) return false;"
+            "  }"
+            "  return root.fns.length == 100;"
+            "})()")->BooleanValue(CcTest::isolate()->GetCurrentContext())
+            .FromJust());
+}
+
+
+UNINITIALIZED_TEST(PagePromotion) {
+  i::FLAG_page_promotion = true;
+  i::FLAG_page_promotion_threshold = 50;
+  i::FLAG_max_semi_space_size = 8 * (Page::kPageSize / MB);
+  i::FLAG_min_semi_space_size = i::FLAG_max_semi_space_size;
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = CcTest::array_buffer_allocator();
+  v8::Isolate* isolate = v8::Isolate::New(create_params);
+  i::Isolate* i_isolate = reinterpret_cast<i::Isolate*>(isolate);
+  {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Context::New(isolate)->Enter();
+    Heap* heap = i_isolate->heap();
+    Factory* factory = i_isolate->factory();
+
+    // Start with an empty new space.
+    heap->CollectGarbage(NEW_SPACE);
+    heap->CollectGarbage(NEW_SPACE);
+
+    // Fill a few new space pages with arrays and let them survive a
+    // scavenge, so that they end up below the age mark.
+    const int kArrayLength = 30;
+    const int kArraySize = FixedArray::SizeFor(kArrayLength);
+    const int kNumberOfArrays = 3 * NewSpacePage::kAreaSize / kArraySize;
+    Handle<FixedArray> holder =
+        factory->NewFixedArray(kNumberOfArrays, TENURED);
+    for (int i = 0; i < kNumberOfArrays; i++) {
+      Handle<FixedArray> array = factory->NewFixedArray(kArrayLength);
+      array->set(0, Smi::FromInt(i));
+      holder->set(i, *array);
+    }
+    heap->CollectGarbage(NEW_SPACE);
+
+    // Let every fourth array die and remember the distances between the
+    // neighbours of the dead arrays.
+    List<int> distances(kNumberOfArrays / 4);
+    for (int i = 1; i + 1 < kNumberOfArrays; i += 4) {
+      Address before = HeapObject::cast(holder->get(i - 1))->address();
+      Address after = HeapObject::cast(holder->get(i + 1))->address();
+      distances.Add(static_cast<int>(after - before));
+      holder->set_undefined(i);
+    }
+
+    heap->CollectAllGarbage();
+
+    // Pages that are promoted as a whole keep the dead arrays as fillers, so
+    // the distance between their neighbours does not change.
+    int preserved_distances = 0;
+    for (int i = 1; i + 1 < kNumberOfArrays; i += 4) {
+      HeapObject* before = HeapObject::cast(holder->get(i - 1));
+      HeapObject* after = HeapObject::cast(holder->get(i + 1));
+      CHECK(heap->InOldSpace(before));
+      CHECK(heap->InOldSpace(after));
+      if (after->address() - before->address() == distances[i / 4] &&
+          distances[i / 4] == 2 * kArraySize) {
+        preserved_distances++;
+      }
+    }
+    CHECK_LT(0, preserved_distances);
+
+    for (int i = 0; i < kNumberOfArrays; i++) {
+      if (i % 4 == 1) continue;
+      FixedArray* array = FixedArray::cast(holder->get(i));
+      CHECK_EQ(i, Smi::cast(array->get(0))->value());
+    }
+  }
+  isolate->Dispose();
+}
+
+
+static int CountAllocationSitesWithHighSurvival(v8::Isolate* isolate,
+                                                const char* decision) {
+  const size_t kMaxSites = 64;
+  v8::AllocationSiteStatistics statistics[kMaxSites];
+  size_t count = isolate->GetAllocationSiteStatistics(statistics, kMaxSites);
+  int result = 0;
+  for (size_t i = 0; i < Min(count, kMaxSites); i++) {
+    size_t high_survival = statistics[i].survival_histogram(
+        v8::AllocationSiteStatistics::kSurvivalHistogramBuckets - 1);
+    if (high_survival > 0 &&
+        strcmp(statistics[i].pretenure_decision(), decision) == 0) {
+      result++;
+    }
+  }
+  return result;
+}
+
+
+TEST(AllocationSiteStatistics) {
+  i::FLAG_expose_gc = true;
+  i::FLAG_pretenuring_hysteresis = 2;
+  CcTest::InitializeVM();
+  if (!i::FLAG_allocation_site_pretenuring) return;
+  if (i::FLAG_gc_global || i::FLAG_stress_compaction) return;
+  v8::Isolate* isolate = CcTest::isolate();
+  v8::HandleScope scope(isolate);
+
+  i::ScopedVector<char> source(1024);
+  i::SNPrintF(source,
+              "var number_elements = %d;"
+              "var elements = new Array(number_elements);"
+              "function f() {"
+              "  for (var i = 0; i < number_elements; i++) {"
+              "    elements[i] = [i, i];"
+              "  }"
+              "};"
+              "f(); gc();",
+              AllocationSite::kPretenureMinimumCreated);
+  CompileRun(source.start());
+
+  // One GC with a high survival rate is not enough to make a decision.
+  CHECK_LT(0, CountAllocationSitesWithHighSurvival(isolate, "undecided"));
+  CHECK_EQ(0, CountAllocationSitesWithHighSurvival(isolate, "maybe tenure"));
+  CHECK_EQ(0, CountAllocationSitesWithHighSurvival(isolate, "tenure"));
+
+  CompileRun("f(); gc();");
+  CHECK_LT(0, CountAllocationSitesWithHighSurvival(isolate, "maybe tenure") +
+                  CountAllocationSitesWithHighSurvival(isolate, "tenure"));
+
+  isolate->ResetAllocationSitePretenuring();
+  const size_t kMaxSites = 64;
+  v8::AllocationSiteStatistics statistics[kMaxSites];
+  size_t count = isolate->GetAllocationSiteStatistics(statistics, kMaxSites);
+  for (size_t i = 0; i < Min(count, kMaxSites); i++) {
+    CHECK(!statistics[i].is_tenured());
+  }
+}
+
+
+TEST(ArrayBufferTrackingOnEvacuatedPage) {
+  i::FLAG_concurrent_array_buffer_freeing = false;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  Heap* heap = isolate->heap();
+  v8::HandleScope scope(CcTest::isolate());
+
+  const int kBuffers = 8;
+  const int kLength = 64 * KB;
+  Handle<FixedArray> live = factory->NewFixedArray(kBuffers / 2, TENURED);
+  int64_t external_memory = heap->amount_of_external_allocated_memory();
+
+  Page* evac_page;
+  {
+    HandleScope inner_scope(isolate);
+    AlwaysAllocateScope always_allocate(isolate);
+    // Place the buffers on a fresh old space page.
+    SimulateFullSpace(heap->old_space());
+    for (int i = 0; i < kBuffers; i++) {
+      Handle<JSArrayBuffer> buffer =
+          factory->NewJSArrayBuffer(SharedFlag::kNotShared, TENURED);
+      CHECK(JSArrayBuffer::SetupAllocatingData(buffer, isolate, kLength));
+      CHECK(Page::FromAddress(buffer->address())->local_tracker() != nullptr);
+      if (i % 2 == 0) live->set(i / 2, *buffer);
+    }
+    evac_page = Page::FromAddress(HeapObject::cast(live->get(0))->address());
+  }
+  CHECK_EQ(external_memory + kBuffers * kLength,
+           heap->amount_of_external_allocated_memory());
+
+  // Dead buffers are freed when their page is swept or released; live buffers
+  // move with their page.
+  FLAG_manual_evacuation_candidates_selection = true;
+  evac_page->SetFlag(MemoryChunk::FORCE_EVACUATION_CANDIDATE_FOR_TESTING);
+  heap->CollectAllGarbage();
+  if (heap->mark_compact_collector()->sweeping_in_progress()) {
+    heap->mark_compact_collector()->EnsureSweepingCompleted();
+  }
+  FLAG_manual_evacuation_candidates_selection = false;
+
+  CHECK_EQ(external_memory + kBuffers / 2 * kLength,
+           heap->amount_of_external_allocated_memory());
+  for (int i = 0; i < kBuffers / 2; i++) {
+    JSArrayBuffer* buffer = JSArrayBuffer::cast(live->get(i));
+    CHECK(buffer->backing_store() != nullptr);
+    CHECK(Page::FromAddress(buffer->address())->local_tracker() != nullptr);
+  }
+}
+
+
+// Counts the backing stores freed, and those freed off the main thread.
+class FreeCountingArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
+ public:
+  FreeCountingArrayBufferAllocator()
+      : main_thread_id_(base::OS::GetCurrentThreadId()),
+        frees_(0),
+        background_frees_(0) {}
+
+  void* Allocate(size_t length) override { return calloc(length, 1); }
+  void* AllocateUninitialized(size_t length) override {
+    return malloc(length);
+  }
+  void Free(void* data, size_t length) override {
+    base::NoBarrier_AtomicIncrement(&frees_, 1);
+    if (base::OS::GetCurrentThreadId() != main_thread_id_) {
+      base::NoBarrier_AtomicIncrement(&background_frees_, 1);
+    }
+    free(data);
+  }
+
+  int frees() { return static_cast<int>(base::NoBarrier_Load(&frees_)); }
+  int background_frees() {
+    return static_cast<int>(base::NoBarrier_Load(&background_frees_));
+  }
+
+ private:
+  int main_thread_id_;
+  base::AtomicWord frees_;
+  base::AtomicWord background_frees_;
+};
+
+
+UNINITIALIZED_TEST(ConcurrentArrayBufferFreeing) {
+  i::FLAG_concurrent_array_buffer_freeing = true;
+  FreeCountingArrayBufferAllocator allocator;
+  v8::Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator = &allocator;
+  v8::Isolate* isolate = v8::Isolate::New(create_params);
+  Isolate* i_isolate = reinterpret_cast<Isolate*>(isolate);
+  const int kBuffers = 8;
+  const int kLength = 64 * KB;
+  {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Context::New(isolate)->Enter();
+    Heap* heap = i_isolate->heap();
+    int64_t external_memory = heap->amount_of_external_allocated_memory();
+    {
+      v8::HandleScope inner_scope(isolate);
+      v8::Local<v8::ArrayBuffer> buffers[kBuffers];
+      for (int i = 0; i < kBuffers; i++) {
+        buffers[i] = v8::ArrayBuffer::New(isolate, kLength);
+      }
+      // Promote the buffers so that they are tracked by their pages.
+      heap->CollectAllGarbage();
+      heap->CollectAllGarbage();
+      for (int i = 0; i < kBuffers; i++) {
+        CHECK(!heap->InNewSpace(*v8::Utils::OpenHandle(*buffers[i])));
+      }
+    }
+    CHECK_EQ(external_memory + kBuffers * kLength,
+             heap->amount_of_external_allocated_memory());
+    // The dead backing stores are accounted for once their pages are swept,
+    // and freed on a background thread.
+    heap->CollectAllGarbage();
+    if (heap->mark_compact_collector()->sweeping_in_progress()) {
+      heap->mark_compact_collector()->EnsureSweepingCompleted();
+    }
+    CHECK_EQ(external_memory, heap->amount_of_external_allocated_memory());
+    // The same goes for backing stores of buffers that die in new space.
+    {
+      v8::HandleScope inner_scope(isolate);
+      for (int i = 0; i < kBuffers; i++) v8::ArrayBuffer::New(isolate, kLength);
+    }
+    heap->CollectGarbage(NEW_SPACE);
+    CHECK_EQ(external_memory, heap->amount_of_external_allocated_memory());
+  }
+  // Disposing the isolate waits for pending freeing tasks and frees the
+  // backing stores that are still alive on the main thread.
+  isolate->Dispose();
+  CHECK_LE(2 * kBuffers, allocator.frees());
+  CHECK_EQ(2 * kBuffers, allocator.background_frees());
+}
+
+
+static int pause_budget_violations = 0;
+
+
+static void OnPauseBudgetViolation(v8::Isolate* isolate, v8::GCType type,
+                                   double pause_ms, double budget_ms) {
+  CHECK(type == v8::kGCTypeScavenge || type == v8::kGCTypeMarkSweepCompact);
+  CHECK_GT(pause_ms, budget_ms);
+  pause_budget_violations++;
+}
+
+
+TEST(GCPauseBudgetViolation) {
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Heap* heap = CcTest::heap();
+  v8::HandleScope scope(isolate);
+
+  // No full garbage collection finishes within a nanosecond.
+  isolate->SetGCPauseBudget(1e-6, OnPauseBudgetViolation);
+  CHECK(heap->HasPauseBudget());
+  pause_budget_violations = 0;
+  heap->CollectAllGarbage();
+  CHECK_LT(0, pause_budget_violations);
+
+  isolate->SetGCPauseBudget(0);
+  CHECK(!heap->HasPauseBudget());
+  int violations = pause_budget_violations;
+  heap->CollectAllGarbage();
+  CHECK_EQ(violations, pause_budget_violations);
+}
+
+
+TEST(SemiSpaceSizingController) {
+  if (FLAG_predictable) return;
+  // The controller is switched on through the pause target below.
+  FLAG_semi_space_sizing_controller = false;
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Isolate* i_isolate = CcTest::i_isolate();
+  Heap* heap = CcTest::heap();
+  Factory* factory = i_isolate->factory();
+  NewSpace* new_space = heap->new_space();
+  v8::HandleScope scope(isolate);
+
+  CHECK(!heap->UsesSemiSpaceSizingController());
+  isolate->SetScavengePauseTarget(1000);
+  CHECK(heap->UsesSemiSpaceSizingController());
+
+  // Hardly anything survives, so the default heuristics would keep the new
+  // space at its initial size. The controller grows it to make scavenges
+  // less frequent.
+  Handle<FixedArray> survivors = factory->NewFixedArray(10);
+  for (int i = 0; i < 10; i++) {
+    HandleScope inner_scope(i_isolate);
+    for (int j = 0; j < 1000; j++) factory->NewFixedArray(100);
+    for (int j = 0; j < survivors->length(); j++) {
+      Handle<FixedArray> survivor = factory->NewFixedArray(100);
+      survivors->set(j, *survivor);
+    }
+    heap->CollectGarbage(NEW_SPACE);
+  }
+  CHECK_LT(new_space->InitialTotalCapacity(), new_space->TotalCapacity());
+
+  // The survivors of a larger new space cannot be scavenged within a tiny
+  // pause target, so the controller shrinks it back.
+  isolate->SetScavengePauseTarget(1e-6);
+  heap->CollectGarbage(NEW_SPACE);
+  CHECK_EQ(new_space->InitialTotalCapacity(), new_space->TotalCapacity());
+
+  // The new space is not shrunk below twice its size, so empty it first.
+  for (int j = 0; j < survivors->length(); j++) {
+    survivors->set(j, Smi::FromInt(0));
+  }
+  heap->CollectGarbage(NEW_SPACE);
+  heap->CollectGarbage(NEW_SPACE);
+  new_space->Resize(new_space->MaximumCapacity());
+  CHECK_EQ(new_space->MaximumCapacity(), new_space->TotalCapacity());
+  new_space->Resize(0);
+  CHECK_EQ(new_space->InitialTotalCapacity(), new_space->TotalCapacity());
+
+  isolate->SetScavengePauseTarget(0);
+  CHECK(!heap->UsesSemiSpaceSizingController());
+}
+
+
+TEST(MemoryPressureNotification) {
+  i::FLAG_incremental_marking = true;
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Heap* heap = CcTest::heap();
+  v8::HandleScope scope(isolate);
+  heap->CollectAllGarbage();
+
+  // Moderate pressure starts incremental marking.
+  isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kModerate);
+  CHECK(heap->HighMemoryPressure());
+  CHECK(heap->ShouldOptimizeForMemoryUsage());
+  CHECK(!heap->incremental_marking()->IsStopped());
+
+  // Critical pressure performs a full garbage collection right away when
+  // sent from the thread holding the isolate.
+  int ms_count = heap->ms_count();
+  isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kCritical);
+  CHECK_LT(ms_count, heap->ms_count());
+
+  // Repeated notifications at the same level are not escalations.
+  ms_count = heap->ms_count();
+  isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kCritical);
+  CHECK_EQ(ms_count, heap->ms_count());
+
+  isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kNone);
+  CHECK(!heap->HighMemoryPressure());
+}
+
+
+TEST(ParallelPointerUpdate) {
+  i::FLAG_manual_evacuation_candidates_selection = true;
+  i::FLAG_parallel_pointer_update = true;
+  i::FLAG_pointer_update_tasks = 3;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  Factory* factory = isolate->factory();
+  HandleScope scope(isolate);
+
+  const int kLength = 256;
+  SimulateFullSpace(heap->old_space());
+  Handle<FixedArray> old_holder = factory->NewFixedArray(kLength, TENURED);
+  Handle<FixedArray> new_holder = factory->NewFixedArray(kLength);
+  for (int i = 0; i < kLength; i++) {
+    Handle<Object> number = factory->NewHeapNumber(i, MUTABLE, TENURED);
+    old_holder->set(i, *number);
+    new_holder->set(i, *number);
+  }
+  // Old to new pointers.
+  Handle<FixedArray> young = factory->NewFixedArray(kLength);
+  Handle<FixedArray> young_holder = factory->NewFixedArray(1, TENURED);
+  young_holder->set(0, *young);
+
+  Page* evac_page = Page::FromAddress(old_holder->address());
+  evac_page->SetFlag(MemoryChunk::FORCE_EVACUATION_CANDIDATE_FOR_TESTING);
+  FixedArray* old_address = *old_holder;
+  heap->CollectAllGarbage();
+
+  CHECK_NE(*old_holder, old_address);
+  CHECK_EQ(young_holder->get(0), *young);
+  for (int i = 0; i < kLength; i++) {
+    CHECK_EQ(old_holder->get(i), new_holder->get(i));
+    CHECK(!Page::FromAddress(HeapObject::cast(old_holder->get(i))->address())
+               ->IsEvacuationCandidate());
+    CHECK_EQ(static_cast<double>(i),
+             HeapNumber::cast(old_holder->get(i))->value());
+  }
+}
+
+
+TEST(PromotedObjectWithPointerToNewSpace) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  Factory* factory = isolate->factory();
+  HandleScope scope(isolate);
+
+  // Let the holder survive a scavenge, so that it ends up below the age mark
+  // and is promoted by the next full GC.
+  heap->CollectGarbage(NEW_SPACE);
+  heap->CollectGarbage(NEW_SPACE);
+  Handle<FixedArray> holder = factory->NewFixedArray(1);
+  heap->CollectGarbage(NEW_SPACE);
+  CHECK(heap->InNewSpace(*holder));
+
+  // The value is allocated above the age mark and stays in new space, so
+  // promoting the holder records an old-to-new slot.
+  Handle<HeapNumber> value = factory->NewHeapNumber(42.0, MUTABLE);
+  holder->set(0, *value);
+  heap->CollectAllGarbage();
+
+  CHECK(heap->InOldSpace(*holder));
+  CHECK(heap->new_space()->ToSpaceContains(*value));
+  CHECK_EQ(*value, holder->get(0));
+
+  // The slot has to be in the remembered set for the next scavenge as well.
+  heap->CollectGarbage(NEW_SPACE);
+  CHECK_EQ(*value, holder->get(0));
+  CHECK_EQ(42.0, HeapNumber::cast(holder->get(0))->value());
+}
+
+
+static int disposed_external_strings = 0;
+
+
+class CountingResource : public v8::String::ExternalOneByteStringResource {
+ public:
+  CountingResource() {}
+
+  void Dispose() override {
+    disposed_external_strings++;
+    delete this;
+  }
+
+  const char* data() const override { return "external string"; }
+
+  size_t length() const override { return 15; }
+};
+
+
+// Creates |count| unreachable external strings.
+static void CreateDeadExternalStrings(v8::Isolate* isolate, int count) {
+  v8::HandleScope scope(isolate);
+  for (int i = 0; i < count; i++) {
+    v8::String::NewExternal(isolate, new CountingResource());
+  }
+}
+
+
+TEST(IncrementalExternalStringFinalization) {
+  FLAG_incremental_external_string_finalization = true;
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Heap* heap = CcTest::heap();
+  const int kStrings = 100;
+
+  disposed_external_strings = 0;
+  CreateDeadExternalStrings(isolate, kStrings);
+  heap->CollectAllGarbage();
+  CHECK_EQ(0, disposed_external_strings);
+  heap->DisposeQueuedExternalStrings();
+  CHECK_EQ(kStrings, disposed_external_strings);
+
+  // Strings that die in old space are deferred as well.
+  disposed_external_strings = 0;
+  {
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::String> string =
+        v8::String::NewExternal(isolate, new CountingResource());
+    heap->CollectAllGarbage();
+    heap->CollectAllGarbage();
+    CHECK(!heap->InNewSpace(*v8::Utils::OpenHandle(*string)));
+  }
+  heap->CollectAllGarbage();
+  CHECK_EQ(0, disposed_external_strings);
+  heap->CollectAllAvailableGarbage();
+  CHECK_EQ(1, disposed_external_strings);
+}
+
+
+TEST(ExternalStringFinalizationBenchmark) {
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Heap* heap = CcTest::heap();
+  const int kStrings = 50000;
+
+  double pause[2];
+  for (int deferred = 0; deferred < 2; deferred++) {
+    FLAG_incremental_external_string_finalization = deferred == 1;
+    disposed_external_strings = 0;
+    CreateDeadExternalStrings(isolate, kStrings);
+    double start = heap->MonotonicallyIncreasingTimeInMs();
+    heap->CollectAllGarbage();
+    pause[deferred] = heap->MonotonicallyIncreasingTimeInMs() - start;
+    heap->DisposeQueuedExternalStrings();
+    CHECK_EQ(kStrings, disposed_external_strings);
+  }
+  PrintF("Finalizing %d external strings: %.3f ms pause, %.3f ms deferred\n",
+         kStrings, pause[0], pause[1]);
+  FLAG_incremental_external_string_finalization = false;
+}
+
+
+static void HeapObjectStatisticsCallback(v8::Isolate* isolate) {}
+
+
+TEST(HeapObjectStatisticsSampling) {
+  if (FLAG_track_gc_object_stats) return;
+  CcTest::InitializeVM();
+  v8::Isolate* isolate = CcTest::isolate();
+  Heap* heap = CcTest::heap();
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+
+  v8::HeapObjectStatistics stats;
+  CHECK(!isolate->GetHeapObjectStatisticsAtLastGC(&stats, MAP_TYPE));
+
+  isolate->SetHeapObjectStatisticsSampling(true, HeapObjectStatisticsCallback);
+  heap->CollectAllGarbage();
+  if (collector->sweeping_in_progress()) {
+    collector->EnsureSweepingCompleted();
+  }
+  CHECK(!collector->sampling_object_stats());
+  CHECK(isolate->GetHeapObjectStatisticsAtLastGC(&stats, MAP_TYPE));
+  CHECK_LT(0u, stats.object_count());
+  CHECK_LT(0u, stats.object_size());
+  CHECK(isolate->GetHeapObjectStatisticsAtLastGC(&stats, CODE_TYPE));
+  CHECK_LT(0u, stats.object_count());
+
+  isolate->SetHeapObjectStatisticsSampling(false);
+  CHECK(!isolate->GetHeapObjectStatisticsAtLastGC(&stats, MAP_TYPE));
+}
+
+
+TEST(CompactionScoringSelectsFragmentedPages) {
+  if (FLAG_never_compact) return;
+  FLAG_compaction_scoring = true;
+  FLAG_compaction_min_fragmentation = 30;
+  FLAG_compaction_time_budget = 100;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Factory* factory = isolate->factory();
+  Heap* heap = isolate->heap();
+  HandleScope scope(isolate);
+
+  // Fill a few pages with arrays and drop every third one, which leaves the
+  // pages about a third free. This is below the fragmentation the default
+  // heuristic compacts.
+  const int kArrayLength = 128;
+  const int kArrays = 4 * Page::kPageSize / FixedArray::SizeFor(kArrayLength);
+  Handle<FixedArray> holder = factory->NewFixedArray(kArrays, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    HandleScope inner_scope(isolate);
+    Handle<FixedArray> array = factory->NewFixedArray(kArrayLength, TENURED);
+    holder->set(i, *array);
+  }
+  Address* addresses = new Address[kArrays];
+  for (int i = 0; i < kArrays; i++) {
+    addresses[i] = HeapObject::cast(holder->get(i))->address();
+    if (i % 3 == 0) holder->set(i, Smi::FromInt(0));
+  }
+
+  MarkCompactCollector* collector = heap->mark_compact_collector();
+  heap->CollectAllGarbage();
+  if (collector->sweeping_in_progress()) {
+    collector->EnsureSweepingCompleted();
+  }
+  heap->CollectAllGarbage();
+
+  int moved = 0;
+  for (int i = 0; i < kArrays; i++) {
+    if (i % 3 == 0) continue;
+    if (HeapObject::cast(holder->get(i))->address() != addresses[i]) moved++;
+  }
+  CHECK_LT(0, moved);
+  delete[] addresses;
+}
+
 }  // namespace internal
 }  // namespace v8
@@ -682,6 +682,81 @@ HEAP_TEST(CompactionSpaceDivideMultiplePages) {
 }
 
 
+class FreeListPublishingThread : public v8::base::Thread {
+ public:
+  FreeListPublishingThread(FreeList* target, PagedSpace* owner, Address start,
+                           int block_size, int blocks)
+      : Thread(Options("FreeListPublishingThread")),
+        target_(target),
+        owner_(owner),
+        start_(start),
+        block_size_(block_size),
+        blocks_(blocks) {}
+
+  virtual void Run() {
+    for (int i = 0; i < blocks_; i++) {
+      FreeList* free_list = new FreeList(owner_);
+      free_list->Free(start_ + i * block_size_, block_size_);
+      target_->Publish(free_list);
+    }
+  }
+
+ private:
+  FreeList* target_;
+  PagedSpace* owner_;
+  Address start_;
+  int block_size_;
+  int blocks_;
+};
+
+
+TEST(FreeListPublish) {
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+  OldSpace* old_space = heap->old_space();
+
+  const int kThreads = 4;
+  const int kBlocksPerThread = 16;
+  const int kBlockSize = 2 * KB;
+  const int kChunkSize = kBlocksPerThread * kBlockSize;
+
+  Address chunks[kThreads];
+  {
+    AlwaysAllocateScope always_allocate(isolate);
+    for (int i = 0; i < kThreads; i++) {
+      chunks[i] = HeapObject::cast(old_space->AllocateRawUnaligned(kChunkSize)
+                                       .ToObjectChecked())
+                      ->address();
+      heap->CreateFillerObjectAt(chunks[i], kChunkSize);
+    }
+  }
+
+  FreeList shared(old_space);
+  FreeListPublishingThread* threads[kThreads];
+  for (int i = 0; i < kThreads; i++) {
+    threads[i] = new FreeListPublishingThread(&shared, old_space, chunks[i],
+                                              kBlockSize, kBlocksPerThread);
+    threads[i]->Start();
+  }
+  for (int i = 0; i < kThreads; i++) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  // Published blocks only become visible once they are taken out of the
+  // shared free list.
+  CHECK(!shared.IsEmpty());
+  CHECK_EQ(0, shared.Available());
+
+  FreeList local(old_space);
+  intptr_t added = local.Concatenate(&shared);
+  CHECK_EQ(kThreads * kChunkSize, added);
+  CHECK_EQ(kThreads * kChunkSize, local.Available());
+  CHECK(shared.IsEmpty());
+}
+
+
 TEST(LargeObjectSpace) {
   v8::V8::Initialize();
 
@@ -717,6 +792,83 @@ TEST(LargeObjectSpace) {
 }
 
 
+TEST(LargePagePool) {
+  FLAG_large_page_pool = true;
+  CcTest::InitializeVM();
+  Isolate* isolate = CcTest::i_isolate();
+  MemoryAllocator* allocator = isolate->memory_allocator();
+  LargeObjectSpace* lo = CcTest::heap()->lo_space();
+  allocator->ReleaseDecayedLargePages(0);
+  CHECK_EQ(0, allocator->LargePagePoolSize());
+
+  intptr_t size = allocator->Size();
+  LargePage* page = allocator->AllocateLargePage(2 * MB, lo, NOT_EXECUTABLE);
+  CHECK(page != NULL);
+  Address address = page->address();
+  intptr_t page_size = static_cast<intptr_t>(page->size());
+  allocator->Free(page);
+  // Pooled pages stay mapped and are accounted as allocated.
+  CHECK_EQ(page_size, allocator->LargePagePoolSize());
+  CHECK_EQ(size + page_size, allocator->Size());
+
+  // A slightly smaller allocation reuses the pooled page.
+  page = allocator->AllocateLargePage(2 * MB - 4 * KB, lo, NOT_EXECUTABLE);
+  CHECK(page != NULL);
+  CHECK_EQ(address, page->address());
+  CHECK_EQ(0, allocator->LargePagePoolSize());
+  CHECK_EQ(2 * MB - 4 * KB, page->area_size());
+  allocator->Free(page);
+
+  // Allocations of a different size bucket do not.
+  page = allocator->AllocateLargePage(4 * MB, lo, NOT_EXECUTABLE);
+  CHECK(page != NULL);
+  CHECK_NE(address, page->address());
+  allocator->Free(page);
+  CHECK_LT(page_size, allocator->LargePagePoolSize());
+
+  allocator->ReleaseDecayedLargePages(0);
+  CHECK_EQ(0, allocator->LargePagePoolSize());
+  CHECK_EQ(size, allocator->Size());
+}
+
+
+#if V8_OS_LINUX
+TEST(HugePageRegions) {
+  FLAG_heap_huge_pages = true;
+  Isolate* isolate = CcTest::i_isolate();
+  Heap* heap = isolate->heap();
+
+  MemoryAllocator* memory_allocator = new MemoryAllocator(isolate);
+  CHECK(memory_allocator->SetUp(heap->MaxReserved(),
+                                heap->MaxExecutableSize()));
+  TestMemoryAllocatorScope test_scope(isolate, memory_allocator);
+
+  {
+    OldSpace faked_space(heap, OLD_SPACE, NOT_EXECUTABLE);
+    Page* first_page = memory_allocator->AllocatePage(
+        faked_space.AreaSize(), &faked_space, NOT_EXECUTABLE);
+    CHECK(first_page->is_valid());
+    first_page->InsertAfter(faked_space.anchor()->prev_page());
+    CHECK(IsAligned(reinterpret_cast<intptr_t>(first_page->address()),
+                    2 * Page::kPageSize));
+    // The whole region stays accounted for while only one page is in use.
+    CHECK_EQ(2 * Page::kPageSize, memory_allocator->Size());
+
+    // The next page is the second half of the same region.
+    Page* second_page = memory_allocator->AllocatePage(
+        faked_space.AreaSize(), &faked_space, NOT_EXECUTABLE);
+    CHECK(second_page->is_valid());
+    second_page->InsertAfter(first_page);
+    CHECK_EQ(first_page->address() + Page::kPageSize, second_page->address());
+    CHECK_EQ(2 * Page::kPageSize, memory_allocator->Size());
+  }
+  memory_allocator->TearDown();
+  delete memory_allocator;
+  FLAG_heap_huge_pages = false;
+}
+#endif  // V8_OS_LINUX
+
+
 TEST(SizeOfFirstPageIsLargeEnough) {
   if (i::FLAG_always_opt) return;
   // Bootstrapping without a snapshot causes more allocations.
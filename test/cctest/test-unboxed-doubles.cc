@@ -14,7 +14,7 @@
 #include "src/execution.h"
 #include "src/factory.h"
 #include "src/global-handles.h"
-#include "src/heap/slots-buffer.h"
+#include "src/heap/remembered-set.h"
 #include "src/ic/ic.h"
 #include "src/macro-assembler.h"
 #include "test/cctest/cctest.h"
@@ -1393,10 +1393,6 @@ TEST(StoreBufferScanOnScavenge) {
   Handle<HeapNumber> boom_number = factory->NewHeapNumber(boom_value, MUTABLE);
   obj->FastPropertyAtPut(field_index, *boom_number);
 
-  // Enforce scan on scavenge for the obj's page.
-  MemoryChunk* chunk = MemoryChunk::FromAddress(obj->address());
-  chunk->set_scan_on_scavenge(true);
-
   // Trigger GCs and force evacuation. Should not crash there.
   CcTest::heap()->CollectAllGarbage();
 
@@ -1482,7 +1478,7 @@ static void TestIncrementalWriteBarrier(Handle<Map> map, Handle<Map> new_map,
   // when |obj_value| is written to property |tagged_descriptor| of |obj|.
   // Then migrate object to |new_map| and set proper value for property
   // |double_descriptor|. Call GC and ensure that it did not crash during
-  // slots buffer entries updating.
+  // remembered set entries updating.
 
   Handle<JSObject> obj;
   Handle<HeapObject> obj_value;
@@ -1514,18 +1510,17 @@ static void TestIncrementalWriteBarrier(Handle<Map> map, Handle<Map> new_map,
   CHECK(Marking::IsBlack(Marking::MarkBitFrom(*obj_value)));
   CHECK(MarkCompactCollector::IsOnEvacuationCandidate(*obj_value));
 
-  // Trigger incremental write barrier, which should add a slot to |ec_page|'s
-  // slots buffer.
+  // Trigger incremental write barrier, which should add a slot to the
+  // OLD_TO_OLD remembered set of |obj|'s page.
   {
-    int slots_buffer_len = SlotsBuffer::SizeOfChain(ec_page->slots_buffer());
     FieldIndex index = FieldIndex::ForDescriptor(*map, tagged_descriptor);
-    const int n = SlotsBuffer::kNumberOfElements + 10;
-    for (int i = 0; i < n; i++) {
-      obj->FastPropertyAtPut(index, *obj_value);
-    }
-    // Ensure that the slot was actually added to the |ec_page|'s slots buffer.
-    CHECK_EQ(slots_buffer_len + n,
-             SlotsBuffer::SizeOfChain(ec_page->slots_buffer()));
+    CHECK(index.is_inobject());
+    Address slot = obj->address() + index.offset();
+    MemoryChunk* chunk = MemoryChunk::FromAddress(obj->address());
+    CHECK(!RememberedSet<OLD_TO_OLD>::Contains(chunk, slot));
+    obj->FastPropertyAtPut(index, *obj_value);
+    // Ensure that the slot was actually recorded.
+    CHECK(RememberedSet<OLD_TO_OLD>::Contains(chunk, slot));
   }
 
   // Migrate |obj| to |new_map| which should shift fields and put the
@@ -267,3 +267,59 @@ TEST(Regress399527) {
   // marking bits which makes the weak map garbage.
   heap->CollectAllGarbage();
 }
+
+
+static void CheckEphemeronChain(bool parallel_weak_processing) {
+  FLAG_incremental_marking = false;
+  FLAG_ephemeron_fixpoint_iterations = 0;
+  FLAG_parallel_weak_processing = parallel_weak_processing;
+  LocalContext context;
+  Isolate* isolate = GetIsolateFrom(&context);
+  Factory* factory = isolate->factory();
+  Heap* heap = isolate->heap();
+  HandleScope scope(isolate);
+  Handle<JSWeakMap> weakmap = AllocateJSWeakMap(isolate);
+
+  // Chain the entries such that each value is the key of the next entry and
+  // insert them back to front, the worst order for the fixpoint iteration.
+  const int kChainLength = 100;
+  {
+    HandleScope head_scope(isolate);
+    Handle<JSObject> head;
+    {
+      HandleScope inner_scope(isolate);
+      Handle<Map> map =
+          factory->NewMap(JS_OBJECT_TYPE, JSObject::kHeaderSize);
+      Handle<JSObject> keys[kChainLength];
+      for (int i = 0; i < kChainLength; i++) {
+        keys[i] = factory->NewJSObjectFromMap(map);
+      }
+      Handle<Smi> smi(Smi::FromInt(23), isolate);
+      int32_t hash =
+          Object::GetOrCreateHash(isolate, keys[kChainLength - 1])->value();
+      JSWeakCollection::Set(weakmap, keys[kChainLength - 1], smi, hash);
+      for (int i = kChainLength - 2; i >= 0; i--) {
+        hash = Object::GetOrCreateHash(isolate, keys[i])->value();
+        JSWeakCollection::Set(weakmap, keys[i], keys[i + 1], hash);
+      }
+      head = inner_scope.CloseAndEscape(keys[0]);
+    }
+    CHECK_EQ(kChainLength,
+             ObjectHashTable::cast(weakmap->table())->NumberOfElements());
+
+    // The whole chain is reachable from its head.
+    heap->CollectAllGarbage();
+    CHECK_EQ(kChainLength,
+             ObjectHashTable::cast(weakmap->table())->NumberOfElements());
+  }
+
+  // Without the head, every entry dies.
+  heap->CollectAllGarbage();
+  CHECK_EQ(0, ObjectHashTable::cast(weakmap->table())->NumberOfElements());
+}
+
+
+TEST(LinearEphemeronMarking) { CheckEphemeronChain(false); }
+
+
+TEST(ParallelWeakProcessing) { CheckEphemeronChain(true); }
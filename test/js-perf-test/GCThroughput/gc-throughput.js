@@ -0,0 +1,53 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Keeps a large, pointer-rich tree alive in old space and keeps replacing
+// parts of it, so that most of the time is spent marking, sweeping and
+// scavenging. Run with and without --heap-huge-pages to compare the GC
+// throughput with transparent huge pages.
+
+new BenchmarkSuite('OldSpaceTree', [1000], [
+  new Benchmark('ReplaceSubtrees', false, false, 0, ReplaceSubtrees,
+                SetUpTree, TearDownTree),
+]);
+
+
+var kTreeDepth = 18;
+var kSubtreeDepth = 10;
+var tree;
+var replacements = 0;
+
+
+function Node(left, right) {
+  this.left = left;
+  this.right = right;
+  this.payload = [left, right];
+}
+
+
+function MakeTree(depth) {
+  if (depth == 0) return new Node(null, null);
+  return new Node(MakeTree(depth - 1), MakeTree(depth - 1));
+}
+
+
+function SetUpTree() {
+  tree = MakeTree(kTreeDepth);
+}
+
+
+function TearDownTree() {
+  tree = null;
+}
+
+
+function ReplaceSubtrees() {
+  var node = tree;
+  for (var i = 0; i < kTreeDepth - kSubtreeDepth - 1; i++) {
+    node = ((replacements >> i) & 1) ? node.left : node.right;
+  }
+  replacements++;
+  node.left = MakeTree(kSubtreeDepth);
+  node.right = MakeTree(kSubtreeDepth);
+}
@@ -0,0 +1,34 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Allocates short-lived arrays of 1 to 4 MB, each of which lands on its own
+// large object page. Run with --no-large-page-pool to compare against
+// mapping and unmapping a fresh page for every allocation.
+
+new BenchmarkSuite('LargeArrays', [1000], [
+  new Benchmark('DoubleArrays', false, false, 0, DoubleArrays),
+  new Benchmark('ObjectArrays', false, false, 0, ObjectArrays),
+]);
+
+
+var kSizes = [128 * 1024, 256 * 1024, 384 * 1024, 512 * 1024];
+var sink;
+
+
+function DoubleArrays() {
+  for (var i = 0; i < kSizes.length; i++) {
+    var array = new Array(kSizes[i]);
+    array[0] = 0.5;
+    sink = array;
+  }
+}
+
+
+function ObjectArrays() {
+  for (var i = 0; i < kSizes.length; i++) {
+    var array = new Array(kSizes[i]);
+    array[0] = kSizes;
+    sink = array;
+  }
+}
@@ -0,0 +1,58 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Numeric loops over typed arrays with loop invariant loads and branches.
+// Run with --turbo, with and without --turbo-licm and
+// --turbo-loop-unswitching, to compare the loop optimizations.
+
+new BenchmarkSuite('TypedArrayKernels', [1000], [
+  new Benchmark('Saxpy', false, false, 0, Saxpy, SetUp),
+  new Benchmark('ClampOrScale', false, false, 0, ClampOrScale, SetUp),
+  new Benchmark('Stencil', false, false, 0, Stencil, SetUp),
+]);
+
+
+var kSize = 4096;
+var x;
+var y;
+var scale = 1.5;
+var clamp = false;
+
+
+function SetUp() {
+  x = new Float64Array(kSize);
+  y = new Float64Array(kSize);
+  for (var i = 0; i < kSize; i++) {
+    x[i] = i;
+    y[i] = kSize - i;
+  }
+}
+
+
+// The context slot loads of {scale}, {x} and {y} are loop invariant.
+function Saxpy() {
+  for (var i = 0; i < kSize; i++) {
+    y[i] = scale * x[i] + y[i];
+  }
+}
+
+
+// The branch on {clamp} is loop invariant.
+function ClampOrScale() {
+  for (var i = 0; i < kSize; i++) {
+    if (clamp) {
+      y[i] = x[i] < 0 ? 0 : x[i];
+    } else {
+      y[i] = x[i] * scale;
+    }
+  }
+  clamp = !clamp;
+}
+
+
+function Stencil() {
+  for (var i = 1; i < kSize - 1; i++) {
+    y[i] = (x[i - 1] + x[i] + x[i + 1]) / 3;
+  }
+}
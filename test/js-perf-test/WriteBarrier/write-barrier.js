@@ -0,0 +1,56 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Stores freshly allocated objects into old objects spread over many pages,
+// so that every store goes through the write barrier and records an
+// old-to-new slot, and scavenges have to process many remembered slots.
+
+new BenchmarkSuite('OldToNewStores', [1000], [
+  new Benchmark('ObjectFields', false, false, 0, ObjectFields,
+                SetUpHolders, TearDownHolders),
+  new Benchmark('ArrayElements', false, false, 0, ArrayElements,
+                SetUpHolders, TearDownHolders),
+]);
+
+
+var kHolders = 20000;
+var kArrayLength = 64;
+var objects;
+var arrays;
+var round = 0;
+
+
+function SetUpHolders() {
+  objects = new Array(kHolders);
+  arrays = new Array(kHolders / 100);
+  for (var i = 0; i < kHolders; i++) objects[i] = { a: null, b: null };
+  for (var i = 0; i < arrays.length; i++) arrays[i] = new Array(kArrayLength);
+  // Promote the holders to old space.
+  for (var i = 0; i < 20; i++) new Array(64 * 1024);
+}
+
+
+function TearDownHolders() {
+  objects = null;
+  arrays = null;
+}
+
+
+function ObjectFields() {
+  round++;
+  for (var i = 0; i < kHolders; i++) {
+    var holder = objects[i];
+    holder.a = { value: i + round };
+    holder.b = holder.a;
+  }
+}
+
+
+function ArrayElements() {
+  round++;
+  for (var i = 0; i < arrays.length; i++) {
+    var holder = arrays[i];
+    for (var j = 0; j < kArrayLength; j++) holder[j] = [i, j, round];
+  }
+}
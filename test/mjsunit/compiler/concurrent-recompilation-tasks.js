@@ -0,0 +1,40 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Flags: --allow-natives-syntax
+// Flags: --concurrent-recompilation --block-concurrent-recompilation
+// Flags: --concurrent-recompilation-tasks=2
+
+if (!%IsConcurrentRecompilationSupported()) {
+  print("Concurrent recompilation is disabled. Skipping this test.");
+  quit();
+}
+
+function f(x) { return x + 1; }
+function g(x) { return x * 2; }
+function h(x) { return x - 3; }
+function k(x) { return x / 4; }
+
+var functions = [f, g, h, k];
+
+// Queue more jobs than there are tasks to compile them.
+for (var i = 0; i < functions.length; i++) {
+  functions[i](1);
+  functions[i](2);
+  %OptimizeFunctionOnNextCall(functions[i], "concurrent");
+  functions[i](3);  // Kick off recompilation.
+  assertUnoptimized(functions[i], "no sync");
+}
+
+// Let concurrent recompilation proceed. The two tasks have to drain the
+// whole queue between them.
+%UnblockConcurrentRecompilation();
+
+for (var i = 0; i < functions.length; i++) {
+  assertOptimized(functions[i], "sync");
+}
+assertEquals(5, f(4));
+assertEquals(8, g(4));
+assertEquals(1, h(4));
+assertEquals(1, k(4));
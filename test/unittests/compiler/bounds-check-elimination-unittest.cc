@@ -0,0 +1,146 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/access-builder.h"
+#include "src/compiler/bounds-check-elimination.h"
+#include "src/compiler/js-graph.h"
+#include "src/compiler/js-operator.h"
+#include "src/compiler/machine-operator.h"
+#include "src/compiler/node-properties.h"
+#include "src/compiler/simplified-operator.h"
+#include "src/types-inl.h"
+#include "test/unittests/compiler/graph-unittest.h"
+#include "test/unittests/compiler/node-test-utils.h"
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+class BoundsCheckEliminationTest : public TypedGraphTest {
+ public:
+  BoundsCheckEliminationTest()
+      : TypedGraphTest(3),
+        javascript_(zone()),
+        machine_(zone()),
+        simplified_(zone()),
+        jsgraph_(isolate(), graph(), common(), &javascript_, &simplified_,
+                 &machine_),
+        buffer_(Parameter(0)) {}
+  ~BoundsCheckEliminationTest() override {}
+
+ protected:
+  // Builds the loop
+  //
+  //   for (var i = 0; i < bound; i++) buffer[i];
+  //
+  // over a Float64 buffer of {byte_length} bytes, with {less_than} as the
+  // exit test, and returns the phi for {i} and the buffer load in the body.
+  void BuildLoop(const Operator* less_than, double bound, double byte_length,
+                 Node** phi_out, Node** load_out) {
+    Node* start = graph()->start();
+    Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+    Node* effect_phi =
+        graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+    Node* init = Typed(NumberConstant(0));
+    Node* phi = graph()->NewNode(common()->Phi(kMachAnyTagged, 2), init, init,
+                                 loop);
+    Node* check =
+        graph()->NewNode(less_than, phi, Typed(NumberConstant(bound)));
+    Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+    Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+    Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+    Node* offset = graph()->NewNode(machine()->Word32Shl(), phi,
+                                    Int32Constant(3));
+    Node* load = graph()->NewNode(
+        simplified()->LoadBuffer(BufferAccess(kExternalFloat64Array)),
+        buffer(), offset, NumberConstant(byte_length), effect_phi,
+        if_true);
+    Node* increment =
+        graph()->NewNode(simplified()->NumberAdd(), phi, NumberConstant(1));
+    loop->ReplaceInput(1, if_true);
+    effect_phi->ReplaceInput(1, load);
+    phi->ReplaceInput(1, increment);
+    // The typer weakens the type of {i} to an unbounded range.
+    NodeProperties::SetType(phi, Type::Range(0, V8_INFINITY, zone()));
+    Node* ret = graph()->NewNode(common()->Return(), phi, effect_phi, exit);
+    graph()->end()->ReplaceInput(0, ret);
+    *phi_out = phi;
+    *load_out = load;
+  }
+
+  Node* Typed(Node* constant) {
+    double const value = OpParameter<double>(constant);
+    NodeProperties::SetType(constant, Type::Range(value, value, zone()));
+    return constant;
+  }
+
+  Node* buffer() { return buffer_; }
+  JSGraph* jsgraph() { return &jsgraph_; }
+  MachineOperatorBuilder* machine() { return &machine_; }
+  SimplifiedOperatorBuilder* simplified() { return &simplified_; }
+
+ private:
+  JSOperatorBuilder javascript_;
+  MachineOperatorBuilder machine_;
+  SimplifiedOperatorBuilder simplified_;
+  JSGraph jsgraph_;
+  Node* buffer_;
+};
+
+
+TEST_F(BoundsCheckEliminationTest, NarrowInductionVariable) {
+  Node* phi;
+  Node* load;
+  BuildLoop(simplified()->NumberLessThan(), 16, 16 * kDoubleSize, &phi,
+            &load);
+  BoundsCheckElimination bounds_check_elimination(jsgraph(), zone());
+  bounds_check_elimination.NarrowInductionVariables();
+  EXPECT_TRUE(NodeProperties::GetType(phi)->Is(Type::Range(0, 16, zone())));
+}
+
+
+TEST_F(BoundsCheckEliminationTest, EliminateBoundsCheckInBounds) {
+  Node* phi;
+  Node* load;
+  BuildLoop(simplified()->NumberLessThan(), 16, 16 * kDoubleSize, &phi,
+            &load);
+  Node* effect = NodeProperties::GetEffectInput(load);
+  Node* control = NodeProperties::GetControlInput(load);
+  BoundsCheckElimination bounds_check_elimination(jsgraph(), zone());
+  bounds_check_elimination.EliminateBoundsChecks();
+  EXPECT_THAT(load, IsLoadElement(AccessBuilder::ForTypedArrayElement(
+                                      kExternalFloat64Array, true),
+                                  buffer(), phi, effect, control));
+}
+
+
+TEST_F(BoundsCheckEliminationTest, KeepBoundsCheckOutOfBounds) {
+  Node* phi;
+  Node* load;
+  BuildLoop(simplified()->NumberLessThan(), 17, 16 * kDoubleSize, &phi,
+            &load);
+  BoundsCheckElimination bounds_check_elimination(jsgraph(), zone());
+  bounds_check_elimination.EliminateBoundsChecks();
+  EXPECT_EQ(IrOpcode::kLoadBuffer, load->opcode());
+}
+
+
+TEST_F(BoundsCheckEliminationTest, EliminateBoundsCheckAfterTypedLowering) {
+  // Typed lowering turns the exit test into a machine comparison once the
+  // induction variable has been narrowed.
+  Node* phi;
+  Node* load;
+  BuildLoop(machine()->Uint32LessThan(), 16, 16 * kDoubleSize, &phi, &load);
+  Node* effect = NodeProperties::GetEffectInput(load);
+  Node* control = NodeProperties::GetControlInput(load);
+  BoundsCheckElimination bounds_check_elimination(jsgraph(), zone());
+  bounds_check_elimination.EliminateBoundsChecks();
+  EXPECT_THAT(load, IsLoadElement(AccessBuilder::ForTypedArrayElement(
+                                      kExternalFloat64Array, true),
+                                  buffer(), phi, effect, control));
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
@@ -4,6 +4,7 @@
 
 #include "src/compiler/access-builder.h"
 #include "src/compiler/load-elimination.h"
+#include "src/compiler/node-properties.h"
 #include "src/compiler/simplified-operator.h"
 #include "test/unittests/compiler/graph-unittest.h"
 #include "test/unittests/compiler/node-test-utils.h"
@@ -69,6 +70,99 @@ TEST_F(LoadEliminationTest, LoadFieldWithStoreField) {
   EXPECT_EQ(value, r4.replacement());
 }
 
+
+TEST_F(LoadEliminationTest, LoadFieldWithStoreFieldToOtherAllocation) {
+  Node* value1 = Parameter(0);
+  Node* value2 = Parameter(1);
+  Node* effect = graph()->start();
+  Node* control = graph()->start();
+  Node* object1 = effect = graph()->NewNode(
+      simplified()->Allocate(), Int32Constant(16), effect, control);
+  Node* object2 = effect = graph()->NewNode(
+      simplified()->Allocate(), Int32Constant(16), effect, control);
+
+  FieldAccess access = AccessBuilder::ForJSObjectProperties();
+  Node* store1 = graph()->NewNode(simplified()->StoreField(access), object1,
+                                  value1, effect, control);
+  Node* store2 = graph()->NewNode(simplified()->StoreField(access), object2,
+                                  value2, store1, control);
+  Reduction r1 = Reduce(graph()->NewNode(simplified()->LoadField(access),
+                                         object1, store2, control));
+  ASSERT_TRUE(r1.Changed());
+  EXPECT_EQ(value1, r1.replacement());
+
+  // A store to the same field of an object that is not known to be
+  // different blocks the forwarding.
+  Node* store3 = graph()->NewNode(simplified()->StoreField(access),
+                                  Parameter(2), value2, store1, control);
+  Reduction r2 = Reduce(graph()->NewNode(simplified()->LoadField(access),
+                                         object1, store3, control));
+  ASSERT_FALSE(r2.Changed());
+}
+
+
+TEST_F(LoadEliminationTest, LoadFieldWithStoreFieldToFinishedRegion) {
+  Node* value1 = Parameter(0);
+  Node* value2 = Parameter(1);
+  Node* effect = graph()->start();
+  Node* control = graph()->start();
+  effect = graph()->NewNode(common()->BeginRegion(), effect);
+  Node* allocate = effect = graph()->NewNode(
+      simplified()->Allocate(), Int32Constant(16), effect, control);
+
+  FieldAccess access = AccessBuilder::ForJSObjectProperties();
+  effect = graph()->NewNode(simplified()->StoreField(access), allocate,
+                            value1, effect, control);
+  Node* object = effect =
+      graph()->NewNode(common()->FinishRegion(), allocate, effect);
+  Node* store = graph()->NewNode(simplified()->StoreField(access), object,
+                                 value2, effect, control);
+  // The store through the FinishRegion writes to the same object.
+  Reduction r = Reduce(graph()->NewNode(simplified()->LoadField(access),
+                                        allocate, store, control));
+  ASSERT_FALSE(r.Changed());
+}
+
+
+TEST_F(LoadEliminationTest, StoreFieldWithStoreField) {
+  Node* object1 = Parameter(0);
+  Node* object2 = Parameter(1);
+  Node* value = Parameter(2);
+  Node* effect = graph()->start();
+  Node* control = graph()->start();
+
+  FieldAccess access1 = AccessBuilder::ForJSObjectProperties();
+  FieldAccess access2 = AccessBuilder::ForJSObjectElements();
+  Node* store1 = graph()->NewNode(simplified()->StoreField(access1), object1,
+                                  object2, effect, control);
+  Node* store2 = graph()->NewNode(simplified()->StoreField(access2), object1,
+                                  object2, store1, control);
+  Node* store3 = graph()->NewNode(simplified()->StoreField(access1), object1,
+                                  value, store2, control);
+  Reduction r = Reduce(store3);
+  ASSERT_TRUE(r.Changed());
+  EXPECT_EQ(store3, r.replacement());
+  EXPECT_EQ(effect, NodeProperties::GetEffectInput(store2));
+  EXPECT_TRUE(store1->IsDead());
+}
+
+
+TEST_F(LoadEliminationTest, StoreFieldWithLoadField) {
+  Node* object = Parameter(0);
+  Node* value = Parameter(1);
+  Node* effect = graph()->start();
+  Node* control = graph()->start();
+
+  FieldAccess access = AccessBuilder::ForJSObjectProperties();
+  Node* store1 = graph()->NewNode(simplified()->StoreField(access), object,
+                                  value, effect, control);
+  Node* load = graph()->NewNode(simplified()->LoadField(access), Parameter(2),
+                                store1, control);
+  Reduction r = Reduce(graph()->NewNode(simplified()->StoreField(access),
+                                        object, value, load, control));
+  ASSERT_FALSE(r.Changed());
+}
+
 }  // namespace compiler
 }  // namespace internal
 }  // namespace v8
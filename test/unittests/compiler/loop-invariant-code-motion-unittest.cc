@@ -0,0 +1,295 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/access-builder.h"
+#include "src/compiler/loop-invariant-code-motion.h"
+#include "src/compiler/machine-operator.h"
+#include "src/compiler/node-properties.h"
+#include "src/compiler/simplified-operator.h"
+#include "src/factory.h"
+#include "src/types-inl.h"
+#include "test/unittests/compiler/graph-unittest.h"
+#include "test/unittests/compiler/node-test-utils.h"
+
+using testing::_;
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+class LoopInvariantCodeMotionTest : public GraphTest {
+ public:
+  LoopInvariantCodeMotionTest()
+      : GraphTest(3), machine_(zone()), simplified_(zone()) {}
+  ~LoopInvariantCodeMotionTest() override {}
+
+ protected:
+  // Builds the loop
+  //
+  //   for (var i = 0; i < object.access; i++) object.store_access = p2;
+  //
+  // where the store is left out if {store_access} is nullptr. Returns the
+  // load in the loop header.
+  Node* BuildLoop(Node* object, FieldAccess const& access,
+                  FieldAccess const* store_access) {
+    Node* start = graph()->start();
+    Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+    Node* effect_phi =
+        graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+    Node* index = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                                   Int32Constant(0), Int32Constant(0), loop);
+    Node* load = graph()->NewNode(simplified()->LoadField(access), object,
+                                  effect_phi, loop);
+    Node* check = graph()->NewNode(machine()->Int32LessThan(), index, load);
+    Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+    Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+    Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+    Node* effect = load;
+    if (store_access != nullptr) {
+      effect = graph()->NewNode(simplified()->StoreField(*store_access),
+                                object, Parameter(2), effect, if_true);
+    }
+    Node* increment =
+        graph()->NewNode(machine()->Int32Add(), index, Int32Constant(1));
+    loop->ReplaceInput(1, if_true);
+    effect_phi->ReplaceInput(1, effect);
+    index->ReplaceInput(1, increment);
+    Node* ret = graph()->NewNode(common()->Return(), index, load, exit);
+    graph()->end()->ReplaceInput(0, ret);
+    return load;
+  }
+
+  void Hoist() { LoopInvariantCodeMotion::Run(graph(), common(), zone()); }
+
+  MachineOperatorBuilder* machine() { return &machine_; }
+  SimplifiedOperatorBuilder* simplified() { return &simplified_; }
+
+ private:
+  MachineOperatorBuilder machine_;
+  SimplifiedOperatorBuilder simplified_;
+};
+
+
+TEST_F(LoopInvariantCodeMotionTest, HoistLoadWithoutStores) {
+  Node* load = BuildLoop(Parameter(0), AccessBuilder::ForMap(), nullptr);
+  Node* effect_phi = NodeProperties::GetEffectInput(load);
+  Hoist();
+  EXPECT_EQ(graph()->start(), NodeProperties::GetEffectInput(load));
+  EXPECT_EQ(graph()->start(), NodeProperties::GetControlInput(load));
+  EXPECT_THAT(effect_phi,
+              IsEffectPhi(graph()->start(), effect_phi, IsLoop(_, _)));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, HoistLoadBehindExitTestIntoPeeledLoop) {
+  // for (var i = 0; i < p1; i++) sum += p0.map;
+  // The loop may not be entered at all, so the load only moves out once the
+  // first iteration is peeled off.
+  Node* start = graph()->start();
+  Node* object = Parameter(0);
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* effect_phi =
+      graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+  Node* index = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                                 Int32Constant(0), Int32Constant(0), loop);
+  Node* sum = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                               Int32Constant(0), Int32Constant(0), loop);
+  Node* check =
+      graph()->NewNode(machine()->Int32LessThan(), index, Parameter(1));
+  Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+  Node* load =
+      graph()->NewNode(simplified()->LoadField(AccessBuilder::ForMap()),
+                       object, effect_phi, if_true);
+  Node* increment =
+      graph()->NewNode(machine()->Int32Add(), index, Int32Constant(1));
+  Node* add = graph()->NewNode(machine()->Int32Add(), sum, load);
+  loop->ReplaceInput(1, if_true);
+  effect_phi->ReplaceInput(1, load);
+  index->ReplaceInput(1, increment);
+  sum->ReplaceInput(1, add);
+  Node* ret = graph()->NewNode(common()->Return(), sum, effect_phi, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  Hoist();
+  Node* entry = loop->InputAt(0);
+  EXPECT_THAT(entry, IsIfTrue(IsBranch(_, start)));
+  EXPECT_EQ(entry, NodeProperties::GetControlInput(load));
+  EXPECT_THAT(NodeProperties::GetEffectInput(load),
+              IsLoadField(AccessBuilder::ForMap(), object, start, entry));
+  EXPECT_THAT(effect_phi, IsEffectPhi(NodeProperties::GetEffectInput(load),
+                                      effect_phi, loop));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, KeepLoadBehindExitTestWithTwoExits) {
+  // for (var i = 0; i < p1; i++) { if (p2) break; sum += p0.map; }
+  // Loops with more than one exit are not peeled.
+  Node* start = graph()->start();
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* effect_phi =
+      graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+  Node* index = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                                 Int32Constant(0), Int32Constant(0), loop);
+  Node* sum = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                               Int32Constant(0), Int32Constant(0), loop);
+  Node* check =
+      graph()->NewNode(machine()->Int32LessThan(), index, Parameter(1));
+  Node* branch1 = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true1 = graph()->NewNode(common()->IfTrue(), branch1);
+  Node* exit1 = graph()->NewNode(common()->IfFalse(), branch1);
+  Node* branch2 = graph()->NewNode(common()->Branch(), Parameter(2), if_true1);
+  Node* exit2 = graph()->NewNode(common()->IfTrue(), branch2);
+  Node* if_false2 = graph()->NewNode(common()->IfFalse(), branch2);
+  Node* load =
+      graph()->NewNode(simplified()->LoadField(AccessBuilder::ForMap()),
+                       Parameter(0), effect_phi, if_false2);
+  Node* increment =
+      graph()->NewNode(machine()->Int32Add(), index, Int32Constant(1));
+  Node* add = graph()->NewNode(machine()->Int32Add(), sum, load);
+  loop->ReplaceInput(1, if_false2);
+  effect_phi->ReplaceInput(1, load);
+  index->ReplaceInput(1, increment);
+  sum->ReplaceInput(1, add);
+  Node* merge = graph()->NewNode(common()->Merge(2), exit1, exit2);
+  Node* ret = graph()->NewNode(common()->Return(), sum, effect_phi, merge);
+  graph()->end()->ReplaceInput(0, ret);
+
+  Hoist();
+  EXPECT_EQ(start, loop->InputAt(0));
+  EXPECT_EQ(effect_phi, NodeProperties::GetEffectInput(load));
+  EXPECT_EQ(if_false2, NodeProperties::GetControlInput(load));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, HoistLoadPastStoreToOtherField) {
+  FieldAccess const store_access = AccessBuilder::ForJSObjectProperties();
+  Node* load = BuildLoop(Parameter(0), AccessBuilder::ForMap(), &store_access);
+  Node* effect_phi = NodeProperties::GetEffectInput(load);
+  Hoist();
+  EXPECT_EQ(graph()->start(), NodeProperties::GetEffectInput(load));
+  EXPECT_THAT(effect_phi,
+              IsEffectPhi(graph()->start(),
+                          IsStoreField(_, _, _, effect_phi, _), IsLoop(_, _)));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, KeepLoadBeforeStoreToSameField) {
+  FieldAccess const access = AccessBuilder::ForMap();
+  Node* load = BuildLoop(Parameter(0), access, &access);
+  Node* effect_phi = NodeProperties::GetEffectInput(load);
+  Hoist();
+  EXPECT_EQ(effect_phi, NodeProperties::GetEffectInput(load));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, KeepConditionalLoad) {
+  // for (var i = 0; i < p1; i++) if (p2) sum += p0.map;
+  // The load does not run in every iteration, so peeling does not help.
+  Node* start = graph()->start();
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* effect_phi =
+      graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+  Node* index = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                                 Int32Constant(0), Int32Constant(0), loop);
+  Node* sum = graph()->NewNode(common()->Phi(kMachInt32, 2),
+                               Int32Constant(0), Int32Constant(0), loop);
+  Node* check =
+      graph()->NewNode(machine()->Int32LessThan(), index, Parameter(1));
+  Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+  Node* branch2 = graph()->NewNode(common()->Branch(), Parameter(2), if_true);
+  Node* if_true2 = graph()->NewNode(common()->IfTrue(), branch2);
+  Node* if_false2 = graph()->NewNode(common()->IfFalse(), branch2);
+  Node* load =
+      graph()->NewNode(simplified()->LoadField(AccessBuilder::ForMap()),
+                       Parameter(0), effect_phi, if_true2);
+  Node* add = graph()->NewNode(machine()->Int32Add(), sum, load);
+  Node* merge = graph()->NewNode(common()->Merge(2), if_true2, if_false2);
+  Node* phi = graph()->NewNode(common()->Phi(kMachInt32, 2), add, sum, merge);
+  Node* effect = graph()->NewNode(common()->EffectPhi(2), load, effect_phi,
+                                  merge);
+  Node* increment =
+      graph()->NewNode(machine()->Int32Add(), index, Int32Constant(1));
+  loop->ReplaceInput(1, merge);
+  effect_phi->ReplaceInput(1, effect);
+  index->ReplaceInput(1, increment);
+  sum->ReplaceInput(1, phi);
+  Node* ret = graph()->NewNode(common()->Return(), sum, effect_phi, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  Hoist();
+  EXPECT_EQ(start, loop->InputAt(0));
+  EXPECT_EQ(effect_phi, NodeProperties::GetEffectInput(load));
+  EXPECT_EQ(if_true2, NodeProperties::GetControlInput(load));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, HoistLoadBehindMapCheckIntoPeeledLoop) {
+  // The load of the properties of p0 relies on the map check in the loop,
+  // even though neither depends on the loop. It moves out together with the
+  // map load once the peeled iteration has made the check.
+  Node* start = graph()->start();
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* effect_phi =
+      graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+  Node* map =
+      graph()->NewNode(simplified()->LoadField(AccessBuilder::ForMap()),
+                       Parameter(0), effect_phi, loop);
+  Node* check = graph()->NewNode(
+      simplified()->ReferenceEqual(Type::Any()), map,
+      HeapConstant(factory()->fixed_array_map()));
+  Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+  Node* load = graph()->NewNode(
+      simplified()->LoadField(AccessBuilder::ForJSObjectProperties()),
+      Parameter(0), map, if_true);
+  Node* sum = graph()->NewNode(common()->Phi(kMachAnyTagged, 2),
+                               Parameter(1), Parameter(1), loop);
+  loop->ReplaceInput(1, if_true);
+  effect_phi->ReplaceInput(1, load);
+  sum->ReplaceInput(1, load);
+  Node* ret = graph()->NewNode(common()->Return(), sum, map, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  Hoist();
+  Node* entry = loop->InputAt(0);
+  EXPECT_THAT(entry, IsIfTrue(IsBranch(_, start)));
+  EXPECT_EQ(entry, NodeProperties::GetControlInput(map));
+  EXPECT_EQ(entry, NodeProperties::GetControlInput(load));
+  EXPECT_EQ(NodeProperties::GetEffectInput(map),
+            NodeProperties::GetEffectInput(load));
+}
+
+
+TEST_F(LoopInvariantCodeMotionTest, KeepLoadFromVaryingObject) {
+  Node* start = graph()->start();
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* effect_phi =
+      graph()->NewNode(common()->EffectPhi(2), start, start, loop);
+  Node* object = graph()->NewNode(common()->Phi(kMachAnyTagged, 2),
+                                  Parameter(0), Parameter(0), loop);
+  Node* load =
+      graph()->NewNode(simplified()->LoadField(AccessBuilder::ForMap()), object,
+                       effect_phi, loop);
+  Node* branch = graph()->NewNode(common()->Branch(), load, loop);
+  Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+  loop->ReplaceInput(1, if_true);
+  effect_phi->ReplaceInput(1, load);
+  object->ReplaceInput(1, load);
+  Node* ret = graph()->NewNode(common()->Return(), object, effect_phi, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  Hoist();
+  EXPECT_EQ(effect_phi, NodeProperties::GetEffectInput(load));
+  EXPECT_EQ(loop, NodeProperties::GetControlInput(load));
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
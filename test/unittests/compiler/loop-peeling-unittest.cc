@@ -180,6 +180,7 @@ TEST_F(LoopPeelingTest, SimpleLoopWithCounter) {
   EXPECT_THAT(w.loop, IsLoop(if_true1, w.if_true));
 
   EXPECT_THAT(peeled->map(c.add), IsInt32Add(c.base, c.inc));
+  EXPECT_THAT(c.phi, IsPhi(kMachAnyTagged, peeled->map(c.add), c.add, w.loop));
 
   Capture<Node*> merge;
   EXPECT_THAT(
@@ -0,0 +1,118 @@
+// Copyright 2015 the V8 project authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "src/compiler/js-graph.h"
+#include "src/compiler/js-operator.h"
+#include "src/compiler/loop-unswitching.h"
+#include "src/compiler/machine-operator.h"
+#include "src/compiler/node-properties.h"
+#include "src/compiler/simplified-operator.h"
+#include "test/unittests/compiler/graph-unittest.h"
+#include "test/unittests/compiler/node-test-utils.h"
+
+using testing::_;
+
+namespace v8 {
+namespace internal {
+namespace compiler {
+
+class LoopUnswitchingTest : public GraphTest {
+ public:
+  LoopUnswitchingTest()
+      : GraphTest(3),
+        javascript_(zone()),
+        machine_(zone()),
+        simplified_(zone()),
+        jsgraph_(isolate(), graph(), common(), &javascript_, &simplified_,
+                 &machine_) {}
+  ~LoopUnswitchingTest() override {}
+
+ protected:
+  LoopTree* GetLoopTree() {
+    return LoopFinder::BuildLoopTree(graph(), zone());
+  }
+
+  JSGraph* jsgraph() { return &jsgraph_; }
+  MachineOperatorBuilder* machine() { return &machine_; }
+
+ private:
+  JSOperatorBuilder javascript_;
+  MachineOperatorBuilder machine_;
+  SimplifiedOperatorBuilder simplified_;
+  JSGraph jsgraph_;
+};
+
+
+TEST_F(LoopUnswitchingTest, UnswitchInvariantBranch) {
+  // while (sum < p0) { sum = sum + (p1 ? 1 : 2); }
+  Node* start = graph()->start();
+  Node* p0 = Parameter(0);
+  Node* p1 = Parameter(1);
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* sum = graph()->NewNode(common()->Phi(kMachAnyTagged, 2),
+                               Int32Constant(0), Int32Constant(0), loop);
+  Node* check = graph()->NewNode(machine()->Int32LessThan(), sum, p0);
+  Node* branch0 = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true0 = graph()->NewNode(common()->IfTrue(), branch0);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch0);
+
+  Node* branch1 = graph()->NewNode(common()->Branch(), p1, if_true0);
+  Node* if_true1 = graph()->NewNode(common()->IfTrue(), branch1);
+  Node* if_false1 = graph()->NewNode(common()->IfFalse(), branch1);
+  Node* merge1 = graph()->NewNode(common()->Merge(2), if_true1, if_false1);
+  Node* inc = graph()->NewNode(common()->Phi(kMachAnyTagged, 2),
+                               Int32Constant(1), Int32Constant(2), merge1);
+  Node* add = graph()->NewNode(machine()->Int32Add(), sum, inc);
+  loop->ReplaceInput(1, merge1);
+  sum->ReplaceInput(1, add);
+  Node* ret = graph()->NewNode(common()->Return(), sum, start, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  LoopTree* loop_tree = GetLoopTree();
+  LoopTree::Loop* outer = loop_tree->outer_loops()[0];
+  EXPECT_EQ(branch1, LoopUnswitcher::FindInvariantBranch(loop_tree, outer));
+  EXPECT_TRUE(LoopUnswitcher::Unswitch(jsgraph(), loop_tree, outer, branch1,
+                                       zone()));
+
+  // The original loop runs if {p1} is true, and keeps only that side.
+  EXPECT_THAT(loop, IsLoop(IsIfTrue(IsBranch(p1, start)), merge1));
+  Node* unswitch = NodeProperties::GetControlInput(loop->InputAt(0));
+  EXPECT_EQ(jsgraph()->TrueConstant(),
+            NodeProperties::GetValueInput(branch1, 0));
+
+  // The copy runs otherwise, and both exits are merged.
+  Node* merge = NodeProperties::GetControlInput(ret);
+  EXPECT_THAT(merge, IsMerge(exit, IsIfFalse(_)));
+  Node* branch0_copy = NodeProperties::GetControlInput(merge->InputAt(1));
+  EXPECT_NE(branch0, branch0_copy);
+  Node* loop_copy = NodeProperties::GetControlInput(branch0_copy);
+  EXPECT_THAT(loop_copy, IsLoop(IsIfFalse(unswitch), _));
+  EXPECT_THAT(ret,
+              IsReturn(IsPhi(kMachAnyTagged, sum, _, merge), start, merge));
+}
+
+
+TEST_F(LoopUnswitchingTest, NoInvariantBranch) {
+  Node* start = graph()->start();
+  Node* loop = graph()->NewNode(common()->Loop(2), start, start);
+  Node* sum = graph()->NewNode(common()->Phi(kMachAnyTagged, 2),
+                               Int32Constant(0), Int32Constant(0), loop);
+  Node* check = graph()->NewNode(machine()->Int32LessThan(), sum, Parameter(0));
+  Node* branch = graph()->NewNode(common()->Branch(), check, loop);
+  Node* if_true = graph()->NewNode(common()->IfTrue(), branch);
+  Node* exit = graph()->NewNode(common()->IfFalse(), branch);
+  Node* add = graph()->NewNode(machine()->Int32Add(), sum, Int32Constant(1));
+  loop->ReplaceInput(1, if_true);
+  sum->ReplaceInput(1, add);
+  Node* ret = graph()->NewNode(common()->Return(), sum, start, exit);
+  graph()->end()->ReplaceInput(0, ret);
+
+  LoopTree* loop_tree = GetLoopTree();
+  EXPECT_EQ(nullptr, LoopUnswitcher::FindInvariantBranch(
+                         loop_tree, loop_tree->outer_loops()[0]));
+}
+
+}  // namespace compiler
+}  // namespace internal
+}  // namespace v8
@@ -43,6 +43,7 @@
         'base/sys-info-unittest.cc',
         'base/utils/random-number-generator-unittest.cc',
         'char-predicates-unittest.cc',
+        'compiler/bounds-check-elimination-unittest.cc',
         'compiler/branch-elimination-unittest.cc',
         'compiler/bytecode-graph-builder-unittest.cc',
         'compiler/change-lowering-unittest.cc',
@@ -75,7 +76,9 @@
         'compiler/liveness-analyzer-unittest.cc',
         'compiler/live-range-unittest.cc',
         'compiler/load-elimination-unittest.cc',
+        'compiler/loop-invariant-code-motion-unittest.cc',
         'compiler/loop-peeling-unittest.cc',
+        'compiler/loop-unswitching-unittest.cc',
         'compiler/machine-operator-reducer-unittest.cc',
         'compiler/machine-operator-unittest.cc',
         'compiler/move-optimizer-unittest.cc',
@@ -109,6 +112,7 @@
         'heap/memory-reducer-unittest.cc',
         'heap/heap-unittest.cc',
         'heap/scavenge-job-unittest.cc',
+        'heap/slot-set-unittest.cc',
         'run-all-unittests.cc',
         'runtime/runtime-interpreter-unittest.cc',
         'test-utils.h',
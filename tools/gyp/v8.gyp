@@ -457,6 +457,8 @@
         '../../src/compiler/ast-loop-assignment-analyzer.h',
         '../../src/compiler/basic-block-instrumentor.cc',
         '../../src/compiler/basic-block-instrumentor.h',
+        '../../src/compiler/bounds-check-elimination.cc',
+        '../../src/compiler/bounds-check-elimination.h',
         '../../src/compiler/branch-elimination.cc',
         '../../src/compiler/branch-elimination.h',
         '../../src/compiler/bytecode-graph-builder.cc',
@@ -552,8 +554,12 @@
         '../../src/compiler/load-elimination.h',
         '../../src/compiler/loop-analysis.cc',
         '../../src/compiler/loop-analysis.h',
+        '../../src/compiler/loop-invariant-code-motion.cc',
+        '../../src/compiler/loop-invariant-code-motion.h',
         '../../src/compiler/loop-peeling.cc',
         '../../src/compiler/loop-peeling.h',
+        '../../src/compiler/loop-unswitching.cc',
+        '../../src/compiler/loop-unswitching.h',
         '../../src/compiler/machine-operator-reducer.cc',
         '../../src/compiler/machine-operator-reducer.h',
         '../../src/compiler/machine-operator.cc',
@@ -767,6 +773,8 @@
         '../../src/hashmap.h',
         '../../src/heap/array-buffer-tracker.cc',
         '../../src/heap/array-buffer-tracker.h',
+        '../../src/heap/concurrent-marking.cc',
+        '../../src/heap/concurrent-marking.h',
         '../../src/heap/memory-reducer.cc',
         '../../src/heap/memory-reducer.h',
         '../../src/heap/gc-idle-time-handler.cc',
@@ -789,11 +797,16 @@
         '../../src/heap/objects-visiting-inl.h',
         '../../src/heap/objects-visiting.cc',
         '../../src/heap/objects-visiting.h',
+        '../../src/heap/parallel-marking.cc',
+        '../../src/heap/parallel-marking.h',
+        '../../src/heap/remembered-set.cc',
+        '../../src/heap/remembered-set.h',
         '../../src/heap/scavenge-job.h',
         '../../src/heap/scavenge-job.cc',
         '../../src/heap/scavenger-inl.h',
         '../../src/heap/scavenger.cc',
         '../../src/heap/scavenger.h',
+        '../../src/heap/slot-set.h',
         '../../src/heap/slots-buffer.cc',
         '../../src/heap/slots-buffer.h',
         '../../src/heap/spaces-inl.h',